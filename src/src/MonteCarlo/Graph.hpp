@@ -13,10 +13,159 @@
 #include <climits>
 #include <optional>
 #include <ranges>
+#include <bit>
 
 struct DirectedTag {};
 struct UndirectedTag {};
 
+// Edge storage policies. SetEdges keeps the neighbors of each vertex in a std::set (a std::map from
+// neighbor to weight for weighted graphs). BitsetEdges keeps each vertex's row of the adjacency matrix
+// as a bitset, so that edge queries and toggles are single bit operations and whole neighborhoods 
+// combine by word-wise XOR; intended for unweighted graphs which are dense or rewired often.
+struct SetEdges {};
+struct BitsetEdges {};
+
+// A row of the adjacency matrix, providing the part of the std::set<uint32_t> interface used by Graph.
+// The row grows as needed; neighbors are visited in ascending order.
+class AdjacencyBitset {
+  public:
+    std::vector<uint64_t> words;
+    uint32_t num_neighbors;
+
+    AdjacencyBitset() : num_neighbors(0) {}
+
+    class iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        iterator() : row(nullptr), w(0), bits(0) {}
+
+        iterator(const AdjacencyBitset* row, size_t w) : row(row), w(w), bits(0) {
+          if (w < row->words.size()) {
+            bits = row->words[w];
+            advance();
+          }
+        }
+
+        uint32_t operator*() const {
+          return 64*w + std::countr_zero(bits);
+        }
+
+        iterator& operator++() {
+          bits &= bits - 1;
+          advance();
+          return *this;
+        }
+
+        iterator operator++(int) {
+          iterator it = *this;
+          ++(*this);
+          return it;
+        }
+
+        bool operator==(const iterator& other) const {
+          return w == other.w && bits == other.bits;
+        }
+
+      private:
+        const AdjacencyBitset* row;
+        size_t w;
+        uint64_t bits;
+
+        void advance() {
+          while (!bits && ++w < row->words.size()) {
+            bits = row->words[w];
+          }
+        }
+    };
+
+    iterator begin() const {
+      return iterator(this, 0);
+    }
+
+    iterator end() const {
+      return iterator(this, words.size());
+    }
+
+    size_t size() const {
+      return num_neighbors;
+    }
+
+    bool empty() const {
+      return num_neighbors == 0;
+    }
+
+    bool contains(uint32_t j) const {
+      return j/64 < words.size() && ((words[j/64] >> (j % 64)) & 1u);
+    }
+
+    void insert(uint32_t j) {
+      if (!contains(j)) {
+        toggle(j);
+      }
+    }
+
+    size_t erase(uint32_t j) {
+      if (contains(j)) {
+        toggle(j);
+        return 1;
+      }
+      return 0;
+    }
+
+    void toggle(uint32_t j) {
+      if (j/64 >= words.size()) {
+        words.resize(j/64 + 1, 0u);
+      }
+
+      uint64_t bit = static_cast<uint64_t>(1) << (j % 64);
+      words[j/64] ^= bit;
+      if (words[j/64] & bit) {
+        num_neighbors++;
+      } else {
+        num_neighbors--;
+      }
+    }
+
+    // Symmetric difference with another row
+    void xor_with(const AdjacencyBitset& other) {
+      if (other.words.size() > words.size()) {
+        words.resize(other.words.size(), 0u);
+      }
+
+      uint32_t n = 0;
+      for (size_t w = 0; w < other.words.size(); w++) {
+        words[w] ^= other.words[w];
+        n += std::popcount(words[w]);
+      }
+      for (size_t w = other.words.size(); w < words.size(); w++) {
+        n += std::popcount(words[w]);
+      }
+      num_neighbors = n;
+    }
+
+    // Removes index j, moving every larger index down by one
+    void remove_index(uint32_t j) {
+      erase(j);
+      size_t k = j/64;
+      if (k >= words.size()) {
+        return;
+      }
+
+      uint64_t low = words[k] & ((static_cast<uint64_t>(1) << (j % 64)) - 1);
+      uint64_t high = (j % 64 == 63) ? 0u : (words[k] >> (j % 64 + 1)) << (j % 64);
+      words[k] = low | high;
+      for (size_t w = k + 1; w < words.size(); w++) {
+        words[w - 1] |= words[w] << 63;
+        words[w] >>= 1;
+      }
+    }
+};
+
 template <typename T, bool IsVoidWeight>
 struct NeighborView {};
 
@@ -34,12 +183,21 @@ struct NeighborView<T, false> {
   auto end()   const { return std::views::keys(m).end(); }
 };
 
-template <typename V = int, typename T = void, typename DirTag = UndirectedTag>
+struct BitsetNeighborView {
+  const AdjacencyBitset& s;
+  auto begin() const { return s.begin(); }
+  auto end()   const { return s.end(); }
+};
+
+template <typename V = int, typename T = void, typename DirTag = UndirectedTag, typename Storage = SetEdges>
 class Graph {
+  static constexpr bool bitset_edges = std::is_same_v<Storage, BitsetEdges>;
+  static_assert(!bitset_edges || std::is_void_v<T>, "BitsetEdges only stores unweighted graphs.");
+
   using EdgeContainer = std::conditional_t<
-    std::is_void_v<T>,
-    std::set<uint32_t>,
-    std::map<uint32_t, T>
+    bitset_edges,
+    AdjacencyBitset,
+    std::conditional_t<std::is_void_v<T>, std::set<uint32_t>, std::map<uint32_t, T>>
   >;
 
   public:
@@ -56,26 +214,16 @@ class Graph {
       }
     }
 
-    Graph(const Graph &g) : num_vertices(0) {
-      for (uint32_t i = 0; i < g.num_vertices; i++) {
-        add_vertex(static_cast<V>(g.vals[i]));
-      }
+    Graph(const Graph &g) : Graph(g, 0) {}
 
-      for (uint32_t i = 0; i < g.num_vertices; i++) {
-        if constexpr (std::is_void_v<T>) {
-          for (auto const &j : g.edges[i]) {
-            add_edge(i, j);
-          }
-        } else {
-          for (auto const &[j, w] : g.edges[i]) {
-            add_edge(i, j, w);
-          }
-        }
-      }
-    }
+    // Copies a graph which uses another edge storage policy
+    template <typename OtherStorage> requires (!std::is_same_v<OtherStorage, Storage>)
+    explicit Graph(const Graph<V, T, DirTag, OtherStorage> &g) : Graph(g, 0) {}
 
-    static Graph<V, T, UndirectedTag> erdos_renyi_graph(uint32_t num_vertices, double p) {
-      Graph<V, T, UndirectedTag> g(num_vertices);
+    Graph& operator=(const Graph&)=default;
+
+    static Graph<V, T, UndirectedTag, Storage> erdos_renyi_graph(uint32_t num_vertices, double p) {
+      Graph<V, T, UndirectedTag, Storage> g(num_vertices);
 
       for (uint32_t i = 0; i < num_vertices; i++) {
         for (uint32_t j = i+1; j < num_vertices; j++) {
@@ -88,7 +236,7 @@ class Graph {
       return g;
     }
 
-    static Graph<V, T, UndirectedTag> random_regular_graph(uint32_t num_vertices, size_t k, uint32_t max_depth=0) {
+    static Graph<V, T, UndirectedTag, Storage> random_regular_graph(uint32_t num_vertices, size_t k, uint32_t max_depth=0) {
       if (num_vertices*k % 2 == 1) {
         throw std::invalid_argument("To generate random regular graph, num_vertices*k must be even.");
       }
@@ -97,16 +245,16 @@ class Graph {
         throw std::invalid_argument("k must be less than num_vertices.");
       }
 
-      Graph<V, T, UndirectedTag> buckets(num_vertices*k);
-      Graph<V, T, UndirectedTag> g(num_vertices);
+      Graph<V, T, UndirectedTag, Storage> buckets(num_vertices*k);
+      Graph<V, T, UndirectedTag, Storage> g(num_vertices);
       std::vector<size_t> sites(num_vertices*k);
 
       recursive_random_regular_graph(buckets, g, sites, max_depth, 0);
       return g;
     }
 
-    static Graph<V, T, UndirectedTag> scale_free_graph(uint32_t num_vertices, double alpha) {
-      Graph<V, T, UndirectedTag> g(num_vertices);
+    static Graph<V, T, UndirectedTag, Storage> scale_free_graph(uint32_t num_vertices, double alpha) {
+      Graph<V, T, UndirectedTag, Storage> g(num_vertices);
 
       std::minstd_rand rng(randi());
       std::uniform_real_distribution<> dis(0.0, 1.0);
@@ -174,11 +322,7 @@ class Graph {
 
     void add_vertex(std::optional<V> val_opt=std::nullopt) {
       num_vertices++;
-      if constexpr (std::is_void_v<T>) {
-        edges.push_back(std::set<uint32_t>());
-      } else {
-        edges.push_back(std::map<uint32_t, T>());
-      }
+      edges.emplace_back();
       vals.push_back(val_opt.value_or(V()));
     }
 
@@ -194,7 +338,9 @@ class Graph {
       }
 
       for (uint32_t i = 0; i < num_vertices; i++) {
-        if constexpr (std::is_void_v<T>) {
+        if constexpr (bitset_edges) {
+          edges[i].remove_index(u);
+        } else if constexpr (std::is_void_v<T>) {
           std::set<uint32_t> new_edges;
 
           for (auto const &j : edges[i]) {
@@ -239,7 +385,9 @@ class Graph {
         throw std::runtime_error(std::format("Invalid vertex {} for graph with {} vertices.", u, num_vertices));
       }
 
-      if constexpr (std::is_void_v<T>) {
+      if constexpr (bitset_edges) {
+        return BitsetNeighborView{edges[u]};
+      } else if constexpr (std::is_void_v<T>) {
         return NeighborView<T, true>{edges[u]};
       } else {
         return NeighborView<T, false>{edges[u]};
@@ -248,7 +396,9 @@ class Graph {
 
     std::vector<uint32_t> neighbors(uint32_t u) const {
       std::vector<uint32_t> neighbors(edges_of(u).begin(), edges_of(u).end());
-      std::sort(neighbors.begin(), neighbors.end());
+      if constexpr (!bitset_edges) {
+        std::sort(neighbors.begin(), neighbors.end());
+      }
       return neighbors;
     }
 
@@ -256,7 +406,8 @@ class Graph {
       if (u1 >= num_vertices || u2 >= num_vertices) {
         throw std::runtime_error(std::format("Invalid vertices {} and {} for graph with {} vertices.", u1, u2, num_vertices));
       }
-      if constexpr (std::is_same_v<DirTag, DirectedTag>) {
+      // Bitset rows of undirected graphs are kept symmetric, so a single bit decides
+      if constexpr (std::is_same_v<DirTag, DirectedTag> || bitset_edges) {
         return edges[u1].contains(u2);
       } else {
         return edges[u1].contains(u2) && edges[u2].contains(u1);
@@ -319,7 +470,12 @@ class Graph {
         throw std::runtime_error(std::format("Invalid vertices {} and {} for graph with {} vertices.", u1, u2, num_vertices));
       }
 
-      if (contains_edge(u1, u2)) {
+      if constexpr (bitset_edges) {
+        edges[u1].toggle(u2);
+        if (std::is_same_v<DirTag, UndirectedTag> && u1 != u2) {
+          edges[u2].toggle(u1);
+        }
+      } else if (contains_edge(u1, u2)) {
         remove_edge(u1, u2);
       } else {
         add_edge(u1, u2);
@@ -351,6 +507,18 @@ class Graph {
     }
 
     void local_complement(uint32_t u) {
+      if constexpr (bitset_edges && std::is_same_v<DirTag, UndirectedTag>) {
+        // Toggling every edge within the neighborhood N of u XORs N into the row of each neighbor v;
+        // this also sets v's own bit, which is cleared again
+        thread_local AdjacencyBitset neighborhood;
+        neighborhood = edges[u];
+        for (uint32_t v : neighborhood) {
+          edges[v].xor_with(neighborhood);
+          edges[v].toggle(v);
+        }
+        return;
+      }
+
       for (auto const& v1 : edges_of(u)) {
         for (auto const& v2 : edges_of(u)) {
           if (v1 < v2) {
@@ -368,8 +536,8 @@ class Graph {
       return n;
     }
 
-    Graph<V, T, DirTag> subgraph(const std::vector<uint32_t>& sites) const {
-      Graph<V, T, DirTag> g(sites.size());
+    Graph<V, T, DirTag, Storage> subgraph(const std::vector<uint32_t>& sites) const {
+      Graph<V, T, DirTag, Storage> g(sites.size());
       for (size_t i = 0; i < sites.size(); i++) {
         size_t a = sites[i];
         if constexpr (std::is_void_v<T>) {
@@ -396,10 +564,10 @@ class Graph {
       return g;
     }
 
-    Graph<bool, T, DirectedTag> partition(const std::vector<uint32_t> &nodes) const {
+    Graph<bool, T, DirectedTag, Storage> partition(const std::vector<uint32_t> &nodes) const {
       std::set<uint32_t> nodess;
       std::copy(nodes.begin(), nodes.end(), std::inserter(nodess, nodess.end()));
-      Graph<bool, T, DirectedTag> new_graph;
+      Graph<bool, T, DirectedTag, Storage> new_graph;
       std::map<uint32_t, uint32_t> new_vertices;
 
       for (const uint32_t a : nodess) {
@@ -734,9 +902,28 @@ class Graph {
     }
 
     private:
+      template <typename OtherStorage>
+      Graph(const Graph<V, T, DirTag, OtherStorage> &g, int) : num_vertices(0) {
+        for (uint32_t i = 0; i < g.num_vertices; i++) {
+          add_vertex(static_cast<V>(g.vals[i]));
+        }
+
+        for (uint32_t i = 0; i < g.num_vertices; i++) {
+          if constexpr (std::is_void_v<T>) {
+            for (auto const &j : g.edges[i]) {
+              add_edge(i, j);
+            }
+          } else {
+            for (auto const &[j, w] : g.edges[i]) {
+              add_edge(i, j, w);
+            }
+          }
+        }
+      }
+
       static void recursive_random_regular_graph(
-        Graph<V, T, DirTag>& buckets, 
-        Graph<V, T, DirTag>& g, 
+        Graph<V, T, DirTag, Storage>& buckets, 
+        Graph<V, T, DirTag, Storage>& g, 
         std::vector<size_t>& sites, 
         uint32_t max_depth, 
         uint32_t depth
@@ -748,8 +935,8 @@ class Graph {
         }
 
         // Create pairs
-        buckets = Graph<V, T, DirTag>(buckets.num_vertices);
-        g = Graph<V, T, DirTag>(g.num_vertices);
+        buckets = Graph<V, T, DirTag, Storage>(buckets.num_vertices);
+        g = Graph<V, T, DirTag, Storage>(g.num_vertices);
         std::iota(sites.begin(), sites.end(), 0);
         std::minstd_rand rng(randi());
         std::shuffle(sites.begin(), sites.end(), rng);
@@ -783,9 +970,9 @@ class Graph {
       }
 };
 
-template <typename V, typename T=void>
-using DirectedGraph = Graph<V, T, DirectedTag>;
+template <typename V, typename T=void, typename Storage=SetEdges>
+using DirectedGraph = Graph<V, T, DirectedTag, Storage>;
 
-template <typename V, typename T=void>
-using UndirectedGraph = Graph<V, T, UndirectedTag>;
+template <typename V, typename T=void, typename Storage=SetEdges>
+using UndirectedGraph = Graph<V, T, UndirectedTag, Storage>;
 
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "PauliString.hpp"
+
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator()=default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+  T* allocate(size_t n) {
+    size_t bytes = (n*sizeof(T) + Alignment - 1) / Alignment * Alignment;
+    void* ptr = std::aligned_alloc(Alignment, bytes);
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t) {
+    std::free(ptr);
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+};
+
+// A dense GF(2) matrix with rows packed into 64-byte aligned words. Rows are padded to
+// a whole number of 256-bit lanes, so that row operations are straight AVX2 XORs. Intended
+// as a scratch buffer: resize() keeps the allocation around between calls.
+class BinaryMatrix {
+  public:
+    static constexpr size_t LANE_WORDS = 256/binary_word_size();
+
+    size_t num_rows;
+    size_t num_cols;
+    size_t width;
+    std::vector<binary_word, AlignedAllocator<binary_word, 64>> data;
+
+    BinaryMatrix() : num_rows(0), num_cols(0), width(0) {}
+
+    BinaryMatrix(size_t num_rows, size_t num_cols) : BinaryMatrix() {
+      resize(num_rows, num_cols);
+    }
+
+    // Resizes and zeros the matrix
+    void resize(size_t num_rows, size_t num_cols) {
+      this->num_rows = num_rows;
+      this->num_cols = num_cols;
+      size_t words = num_cols / binary_word_size() + static_cast<bool>(num_cols % binary_word_size());
+      width = (words + LANE_WORDS - 1) / LANE_WORDS * LANE_WORDS;
+      data.assign(num_rows*width, 0u);
+    }
+
+    inline binary_word* row(size_t i) {
+      return data.data() + i*width;
+    }
+
+    inline const binary_word* row(size_t i) const {
+      return data.data() + i*width;
+    }
+
+    inline bool get(size_t i, size_t j) const {
+      return (row(i)[j / binary_word_size()] >> (j % binary_word_size())) & 1u;
+    }
+
+    inline void set(size_t i, size_t j, binary_word v) {
+      binary_word& word = row(i)[j / binary_word_size()];
+      size_t bit_ind = j % binary_word_size();
+      word = (word & ~(static_cast<binary_word>(1) << bit_ind)) | (v << bit_ind);
+    }
+
+    inline void swap_rows(size_t i, size_t j) {
+      std::swap_ranges(row(i), row(i) + width, row(j));
+    }
+
+    // row(i) ^= row(j), skipping the leading words before start
+    inline void xor_rows(size_t i, size_t j, size_t start=0) {
+      binary_word* a = row(i);
+      const binary_word* b = row(j);
+      size_t k = start - start % LANE_WORDS;
+#ifdef __AVX2__
+      for (; k < width; k += LANE_WORDS) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + k));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + k));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(a + k), _mm256_xor_si256(va, vb));
+      }
+#else
+      for (; k < width; k++) {
+        a[k] ^= b[k];
+      }
+#endif
+    }
+
+    // Forward elimination to row echelon form; returns the rank. Destroys the contents of the matrix.
+    uint32_t rank() {
+      return eliminate();
+    }
+
+    // Forward elimination to row echelon form; returns the pivot column of each nonzero row, in order.
+    std::vector<uint32_t> pivots() {
+      std::vector<uint32_t> columns;
+      eliminate(&columns);
+      return columns;
+    }
+
+  private:
+    uint32_t eliminate(std::vector<uint32_t>* columns=nullptr) {
+      uint32_t r = 0;
+      for (size_t c = 0; c < num_cols && r < num_rows; c++) {
+        size_t w = c / binary_word_size();
+        binary_word mask = static_cast<binary_word>(1) << (c % binary_word_size());
+
+        size_t pivot = r;
+        while (pivot < num_rows && !(row(pivot)[w] & mask)) {
+          pivot++;
+        }
+
+        if (pivot == num_rows) {
+          continue;
+        }
+
+        if (pivot != r) {
+          swap_rows(pivot, r);
+        }
+
+        // Every row below r vanishes on the columns before c, so the leading words can be skipped
+        for (size_t i = pivot + 1; i < num_rows; i++) {
+          if (row(i)[w] & mask) {
+            xor_rows(i, r, w);
+          }
+        }
+
+        if (columns) {
+          columns->push_back(c);
+        }
+        r++;
+      }
+
+      return r;
+    }
+};
+
+inline bool qubits_ascending_contiguous(const Qubits& sites) {
+  for (size_t j = 1; j < sites.size(); j++) {
+    if (sites[j] != sites[0] + j) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies len bits of src (of src_width words) starting at bit start into dst, a word at a time
+inline void copy_bits(const binary_word* src, size_t src_width, size_t start, size_t len, binary_word* dst) {
+  constexpr size_t word_size = binary_word_size();
+  size_t num_words = len / word_size + static_cast<bool>(len % word_size);
+  for (size_t w = 0; w < num_words; w++) {
+    size_t bit = start + w*word_size;
+    size_t src_word = bit / word_size;
+    size_t offset = bit % word_size;
+    binary_word v = src[src_word] >> offset;
+    if (offset && src_word + 1 < src_width) {
+      v |= src[src_word + 1] << (word_size - offset);
+    }
+    dst[w] = v;
+  }
+
+  if (len % word_size) {
+    dst[num_words - 1] &= (static_cast<binary_word>(1) << (len % word_size)) - 1;
+  }
+}
+
+// Packs the restriction of a row of interleaved Pauli bits (x0 z0 x1 z1 ...) of src_width words onto sites 
+// into dst, either as (x, z) pairs or as x bits only. When the sites are ascending and contiguous, the 
+// (x, z) pairs form a single bit range and are copied a word at a time.
+inline void pack_paulis(const binary_word* src, size_t src_width, const Qubits& sites, bool contiguous, bool x_only, binary_word* dst) {
+  constexpr size_t word_size = binary_word_size();
+  size_t k = sites.size();
+  if (k == 0) {
+    return;
+  }
+
+  if (contiguous && !x_only) {
+    copy_bits(src, src_width, 2*sites[0], 2*k, dst);
+    return;
+  }
+
+  constexpr size_t num_paulis = word_size/2;
+  for (size_t j = 0; j < k; j++) {
+    uint32_t q = sites[j];
+    binary_word xz = (src[q / num_paulis] >> (2*(q % num_paulis))) & 3u;
+    if (x_only) {
+      dst[j / word_size] |= (xz & 1u) << (j % word_size);
+    } else {
+      dst[(2*j) / word_size] |= xz << ((2*j) % word_size);
+    }
+  }
+}
@@ -58,14 +58,14 @@ std::pair<uint32_t, uint32_t> get_targets(uint32_t d, uint32_t q, uint32_t num_q
 }
 
 Eigen::MatrixXcd haar_unitary(uint32_t num_qubits) {
-  std::minstd_rand rng(randi());
-
   Eigen::MatrixXcd z = Eigen::MatrixXcd::Zero(1u << num_qubits, 1u << num_qubits);
-  std::normal_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> normals(2*z.size());
+  Random::fill_normal(normals);
 
   for (uint32_t r = 0; r < z.rows(); r++) {
     for (uint32_t c = 0; c < z.cols(); c++) {
-      z(r, c) = std::complex<double>(distribution(rng), distribution(rng));
+      size_t k = 2*(r*z.cols() + c);
+      z(r, c) = std::complex<double>(normals[k], normals[k + 1]);
     }
   }
 
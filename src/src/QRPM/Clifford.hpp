@@ -1,6 +1,6 @@
 #pragma once
 
-#include "PauliString.hpp"
+#include "PauliStringN.hpp"
 #include "QuantumCircuit.h"
 
 template <class T>
@@ -95,11 +95,12 @@ void single_qubit_clifford_impl(T& qobj, size_t q, size_t r) {
   }
 }
 
-template<typename... Args>
-void reduce_paulis_inplace(PauliString& p1, PauliString& p2, const Qubits& qubits, Args&... args) {
+// P is PauliString or one of the inline PauliStringN
+template<typename P, typename... Args>
+void reduce_paulis_inplace(P& p1, P& p2, const Qubits& qubits, Args&... args) {
   size_t num_qubits = p1.num_qubits;
   if (p2.num_qubits != num_qubits) {
-    throw std::runtime_error(std::format("Cannot reduce tableau for provided PauliStrings {} and {}; mismatched number of qubits.", p1, p2));
+    throw std::runtime_error(std::format("Cannot reduce tableau for provided PauliStrings {} and {}; mismatched number of qubits.", p1.to_string_ops(), p2.to_string_ops()));
   }
 
   Qubits qubits_(num_qubits);
@@ -107,8 +108,8 @@ void reduce_paulis_inplace(PauliString& p1, PauliString& p2, const Qubits& qubit
 
   p1.reduce_inplace(false, std::make_pair(&args, qubits)..., std::make_pair(&p2, qubits_));
 
-  PauliString z1p = PauliString::basis(num_qubits, "Z", 0, 0);
-  PauliString z1m = PauliString::basis(num_qubits, "Z", 0, 2);
+  P z1p = P::basis(num_qubits, "Z", 0, 0);
+  P z1m = P::basis(num_qubits, "Z", 0, 2);
 
   if (p2 != z1p && p2 != z1m) {
     p2.reduce_inplace(true, std::make_pair(&args, qubits)..., std::make_pair(&p1, qubits_));
@@ -177,24 +178,36 @@ void random_clifford_iteration_impl(const Qubits& qubits, Args&... args) {
     return;
   }
 
-  Qubits qubits_(num_qubits);
-  std::iota(qubits_.begin(), qubits_.end(), 0);
+  // Small pairs are drawn as inline strings, from the same random sequence as PauliString::randh
+  auto reduce_random_pair = [&]<typename P>() {
+    P p1 = P::randh(num_qubits);
+    P p2 = P::randh(num_qubits);
+    while (p1.commutes(p2)) {
+      p2 = P::randh(num_qubits);
+    }
 
-  PauliString p1 = PauliString::randh(num_qubits);
-  PauliString p2 = PauliString::randh(num_qubits);
-  while (p1.commutes(p2)) {
-    p2 = PauliString::randh(num_qubits);
-  }
+    reduce_paulis_inplace(p1, p2, qubits, args...);
+  };
 
-  reduce_paulis_inplace(p1, p2, qubits, args...);
+  if (num_qubits <= PauliStringN<1>::max_qubits) {
+    reduce_random_pair.template operator()<PauliStringN<1>>();
+  } else if (num_qubits <= PauliString64::max_qubits) {
+    reduce_random_pair.template operator()<PauliString64>();
+  } else if (num_qubits <= PauliString128::max_qubits) {
+    reduce_random_pair.template operator()<PauliString128>();
+  } else {
+    reduce_random_pair.template operator()<PauliString>();
+  }
 }
 
+// Each iteration maps its random anticommuting pair onto the first of the remaining qubits, 
+// so that qubit is done and the next iteration acts on the rest.
 template <typename... Args>
 void random_clifford_impl(const Qubits& qubits, Args&... args) {
   Qubits qubits_(qubits.begin(), qubits.end());
 
   for (uint32_t i = 0; i < qubits.size(); i++) {
     random_clifford_iteration_impl(qubits_, args...);
-    qubits_.pop_back();
+    qubits_.erase(qubits_.begin());
   }
 }
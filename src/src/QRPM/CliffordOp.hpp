@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "QuantumCircuit.h"
+
+// A Clifford gate on one or two qubits, stored as its action on a single tableau row. For each
+// restriction (xa, za, xb, zb) of a row to the support (bits 0-3), table holds the image in bits 0-3
+// and whether the sign of the row flips in bit 4. Since gates act on every row independently, an op
+// can be built up by applying elementary gates to it, e.g. through random_clifford_impl, and a
+// layer of ops can be applied to the tableau one row at a time.
+struct CliffordOp {
+  std::array<uint32_t, 2> qubits;
+  uint32_t num_qubits;
+  std::array<uint8_t, 16> table;
+
+  CliffordOp()=default;
+
+  CliffordOp(const Qubits& support) {
+    if (support.size() == 0 || support.size() > 2) {
+      throw std::invalid_argument(std::format("A CliffordOp must act on one or two qubits, not {}.", support.size()));
+    }
+
+    num_qubits = support.size();
+    qubits = {support[0], num_qubits == 2 ? support[1] : support[0]};
+    if (num_qubits == 2 && qubits[0] == qubits[1]) {
+      throw std::invalid_argument(std::format("A CliffordOp cannot act twice on qubit {}.", qubits[0]));
+    }
+
+    for (uint8_t i = 0; i < 16; i++) {
+      table[i] = i;
+    }
+  }
+
+  // Image of the restriction bits of a row, with the sign flip in bit 4
+  inline uint8_t apply(uint8_t bits) const {
+    return table[bits];
+  }
+
+  // Algebraic normal form of each output bit as a function of the four input bits: output k is the XOR
+  // of the monomials S (products of the inputs in S) for which bit k of anf()[S] is set. This is how the
+  // op is evaluated bitsliced on the columns of a qubit-major tableau.
+  std::array<uint8_t, 16> anf() const {
+    // The Moebius transform on the entries packed into two words, entry i in byte i % 8 of half i / 8:
+    // at step j every entry with bit j set takes the XOR of the entry 2^j below it
+    uint64_t half[2] = {0, 0};
+    for (uint8_t i = 0; i < 16; i++) {
+      half[i / 8] |= static_cast<uint64_t>(table[i]) << (8*(i % 8));
+    }
+
+    constexpr uint64_t masks[3] = {0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull};
+    for (uint8_t j = 0; j < 3; j++) {
+      for (uint64_t& h : half) {
+        h ^= (h << (8u << j)) & masks[j];
+      }
+    }
+    half[1] ^= half[0];
+
+    std::array<uint8_t, 16> anf;
+    for (uint8_t i = 0; i < 16; i++) {
+      anf[i] = (half[i / 8] >> (8*(i % 8))) & 0xFFu;
+    }
+
+    return anf;
+  }
+
+  void h(uint32_t q) {
+    uint32_t k = slot(q);
+    compose([k](uint8_t bits) {
+      uint8_t x = (bits >> (2*k)) & 1u;
+      uint8_t z = (bits >> (2*k + 1)) & 1u;
+      bits &= ~(3u << (2*k));
+      return static_cast<uint8_t>(bits | (z << (2*k)) | (x << (2*k + 1)) | ((x & z) << 4));
+    });
+  }
+
+  void s(uint32_t q) {
+    uint32_t k = slot(q);
+    compose([k](uint8_t bits) {
+      uint8_t x = (bits >> (2*k)) & 1u;
+      uint8_t z = (bits >> (2*k + 1)) & 1u;
+      return static_cast<uint8_t>((bits ^ (x << (2*k + 1))) | ((x & z) << 4));
+    });
+  }
+
+  void sd(uint32_t q) {
+    s(q);
+    s(q);
+    s(q);
+  }
+
+  // The Pauli gates only flip the signs of rows which anticommute with them
+  void x(uint32_t q) {
+    uint32_t k = slot(q);
+    compose([k](uint8_t bits) {
+      return static_cast<uint8_t>(bits | (((bits >> (2*k + 1)) & 1u) << 4));
+    });
+  }
+
+  void y(uint32_t q) {
+    uint32_t k = slot(q);
+    compose([k](uint8_t bits) {
+      return static_cast<uint8_t>(bits | ((((bits >> (2*k)) ^ (bits >> (2*k + 1))) & 1u) << 4));
+    });
+  }
+
+  void z(uint32_t q) {
+    uint32_t k = slot(q);
+    compose([k](uint8_t bits) {
+      return static_cast<uint8_t>(bits | (((bits >> (2*k)) & 1u) << 4));
+    });
+  }
+
+  void cx(uint32_t a, uint32_t b) {
+    uint32_t ka = slot(a);
+    uint32_t kb = slot(b);
+    if (ka == kb) {
+      throw std::invalid_argument(std::format("Cannot apply cx to qubit {} and itself.", a));
+    }
+
+    compose([ka, kb](uint8_t bits) {
+      uint8_t xa = (bits >> (2*ka)) & 1u;
+      uint8_t za = (bits >> (2*ka + 1)) & 1u;
+      uint8_t xb = (bits >> (2*kb)) & 1u;
+      uint8_t zb = (bits >> (2*kb + 1)) & 1u;
+
+      uint8_t flip = xa & zb & ~(xb ^ za) & 1u;
+      return static_cast<uint8_t>(bits ^ (xa << (2*kb)) ^ (zb << (2*ka + 1)) ^ (flip << 4));
+    });
+  }
+
+  void cz(uint32_t a, uint32_t b) {
+    h(b);
+    cx(a, b);
+    h(b);
+  }
+
+  // The r-th element of the Clifford group on the support (24 elements for one qubit, 11520 for two),
+  // modulo global phase. The order is fixed but otherwise arbitrary.
+  static CliffordOp clifford(const Qubits& support, uint32_t r) {
+    CliffordOp op(support);
+    const auto& tables = group_tables(op.num_qubits);
+    if (r >= tables.size()) {
+      throw std::invalid_argument(std::format("Index {} is out of range for the {}-qubit Clifford group of order {}.", r, op.num_qubits, tables.size()));
+    }
+
+    op.table = tables[r];
+    return op;
+  }
+
+  // A uniformly random Clifford on the support, drawn from the precomputed group
+  static CliffordOp random_clifford(const Qubits& support) {
+    CliffordOp op(support);
+    const auto& tables = group_tables(op.num_qubits);
+    op.table = tables[randi() % tables.size()];
+    return op;
+  }
+
+  static size_t group_order(uint32_t num_qubits) {
+    return group_tables(num_qubits).size();
+  }
+
+  private:
+    inline uint32_t slot(uint32_t q) const {
+      if (q == qubits[0]) {
+        return 0;
+      } else if (num_qubits == 2 && q == qubits[1]) {
+        return 1;
+      }
+
+      throw std::invalid_argument(std::format("Qubit {} is outside of the support of the CliffordOp.", q));
+    }
+
+    // Tables of every element of the one- and two-qubit Clifford groups, found once by breadth-first search 
+    // from the identity over h, s and cx. Elements differing only by a global phase share a table.
+    static const std::vector<std::array<uint8_t, 16>>& group_tables(uint32_t num_qubits) {
+      static const std::array<std::vector<std::array<uint8_t, 16>>, 2> tables = {enumerate_group(1), enumerate_group(2)};
+      return tables[num_qubits - 1];
+    }
+
+    static std::vector<std::array<uint8_t, 16>> enumerate_group(uint32_t num_qubits) {
+      Qubits support(num_qubits);
+      std::iota(support.begin(), support.end(), 0);
+
+      std::vector<std::array<uint8_t, 16>> elements;
+      std::set<std::array<uint8_t, 16>> visited;
+      std::deque<CliffordOp> queue = {CliffordOp(support)};
+      visited.insert(queue.front().table);
+
+      while (!queue.empty()) {
+        CliffordOp op = queue.front();
+        queue.pop_front();
+        elements.push_back(op.table);
+
+        uint32_t num_generators = (num_qubits == 2) ? 5 : 2;
+        for (uint32_t g = 0; g < num_generators; g++) {
+          CliffordOp next = op;
+          if (g < num_qubits) {
+            next.h(g);
+          } else if (g < 2*num_qubits) {
+            next.s(g - num_qubits);
+          } else {
+            next.cx(0, 1);
+          }
+
+          if (visited.insert(next.table).second) {
+            queue.push_back(next);
+          }
+        }
+      }
+
+      return elements;
+    }
+
+    // Follows the op with a gate, given by its action on the restriction bits of a row
+    template <typename F>
+    void compose(F gate) {
+      for (uint8_t i = 0; i < 16; i++) {
+        uint8_t v = gate(table[i] & 15u);
+        table[i] = (v & 15u) | ((table[i] ^ v) & 16u);
+      }
+    }
+};
@@ -1,51 +1,25 @@
 #include "CliffordState.h"
 #include <algorithm>
 
+// Clifford circuits are compiled rather than checked with is_clifford; compile throws on anything else
 EvolveResult CliffordState::evolve(const QuantumCircuit& circuit, const Qubits& qubits, EvolveOpts opts) {
-  if (!circuit.is_clifford()) {
-    throw std::runtime_error("Provided circuit is not Clifford.");
-  }
-
-  return QuantumState::_evolve(circuit, qubits, opts);
+  return evolve(circuit.compile(qubits, num_qubits), opts);
 }
 
 EvolveResult CliffordState::evolve(const QuantumCircuit& circuit, EvolveOpts opts) {
-  if (!circuit.is_clifford()) {
-    throw std::runtime_error("Provided circuit is not Clifford.");
+  if (circuit.get_num_qubits() > num_qubits) {
+    throw std::runtime_error(std::format("Cannot evolve a {}-qubit circuit on a {}-qubit state.", circuit.get_num_qubits(), num_qubits));
   }
 
-  return QuantumState::_evolve(circuit, opts);
+  Qubits qubits(circuit.get_num_qubits());
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return evolve(circuit.compile(qubits, num_qubits), opts);
 }
 
 std::optional<MeasurementData> CliffordState::evolve(const QuantumInstruction& inst) {
   return std::visit(quantumcircuit_utils::overloaded{
       [this](std::shared_ptr<Gate> gate) -> std::optional<MeasurementData> { 
-        std::string name = gate->label();
-
-        if (name == "H") {
-          h(gate->qubits[0]);
-        } else if (name == "S") {
-          s(gate->qubits[0]);
-        } else if (name == "Sd") {
-          sd(gate->qubits[0]);
-        } else if (name == "CX") {
-          cx(gate->qubits[0], gate->qubits[1]);
-        } else if (name == "X") {
-          x(gate->qubits[0]);
-        } else if (name == "Y") {
-          y(gate->qubits[0]);
-        } else if (name == "Z") {
-          z(gate->qubits[0]);
-        } else if (name == "CY") {
-          cy(gate->qubits[0], gate->qubits[1]);
-        } else if (name == "CZ") {
-          cz(gate->qubits[0], gate->qubits[1]);
-        } else if (name == "SWAP") {
-          swap(gate->qubits[0], gate->qubits[1]);
-        } else {
-          throw std::runtime_error(std::format("Invalid instruction \"{}\" provided to CliffordState.evolve.", name));
-        }
-
+        apply_compiled_gate(*this, compile_gate(*gate));
         return std::nullopt;
       },
       [](const FreeFermionGate& gate) -> std::optional<MeasurementData> {
@@ -60,6 +34,81 @@ std::optional<MeasurementData> CliffordState::evolve(const QuantumInstruction& i
   }, inst);
 }
 
+void CliffordState::evolve(const CompiledCircuit& program, CircuitRegisters& registers) {
+  if (program.num_qubits != num_qubits) {
+    throw std::runtime_error(std::format("Cannot run a program compiled for {} qubits on a {}-qubit state.", program.num_qubits, num_qubits));
+  }
+
+  registers.prepare(program);
+  BitString& bits = registers.bits;
+
+  const CompiledOp* ops = program.ops.data();
+  size_t num_ops = program.ops.size();
+  size_t i = 0;
+  while (i < num_ops) {
+    const CompiledOp& op = ops[i];
+    if (op.run > 0) {
+      apply_gates(std::span(ops + i, op.run));
+      i += op.run;
+      continue;
+    }
+
+    i++;
+    if (op.control != CompiledOp::NONE && !bits.get(op.control)) {
+      continue;
+    }
+
+    std::optional<MeasurementData> result;
+    switch (op.code) {
+      case OpCode::Mzr:
+        result = mzr(op.args[0], op.forced_outcome());
+        break;
+      case OpCode::Measure:
+        result = measure(program.measurements[op.args[0]]);
+        break;
+      case OpCode::NOT:
+        bits.set(op.args[1], !bits.get(op.args[0]));
+        break;
+      case OpCode::AND:
+        bits.set(op.args[2], bits.get(op.args[0]) && bits.get(op.args[1]));
+        break;
+      case OpCode::OR:
+        bits.set(op.args[2], bits.get(op.args[0]) || bits.get(op.args[1]));
+        break;
+      case OpCode::XOR:
+        bits.set(op.args[2], bits.get(op.args[0]) ^ bits.get(op.args[1]));
+        break;
+      case OpCode::NAND:
+        bits.set(op.args[2], !(bits.get(op.args[0]) && bits.get(op.args[1])));
+        break;
+      case OpCode::CLEAR:
+        bits.set(op.args[0], 0);
+        break;
+      default:
+        apply_compiled_gate(*this, op);
+    }
+
+    if (result) {
+      registers.measurements[op.slot] = result.value();
+      if (op.target != CompiledOp::NONE) {
+        bits.set(op.target, result->first);
+      }
+    }
+  }
+}
+
+EvolveResult CliffordState::evolve(const CompiledCircuit& program, EvolveOpts opts) {
+  CircuitRegisters registers;
+  evolve(program, registers);
+  return process_measurement_results(registers.measurements, opts);
+}
+
+void CliffordState::apply_gates(std::span<const CompiledOp> ops) {
+  for (const CompiledOp& op : ops) {
+    apply_compiled_gate(*this, op);
+  }
+}
+
 void CliffordState::evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) {
   throw std::runtime_error("Cannot evolve arbitrary gate on Clifford state.");
 }
@@ -142,6 +191,12 @@ void CliffordState::swap(uint32_t a, uint32_t b) {
   cx(a, b);
 }
 
+void CliffordState::random_clifford_layer(const std::vector<Qubits>& supports) {
+  for (const Qubits& qubits : supports) {
+    random_clifford(qubits);
+  }
+}
+
 double CliffordState::mzr_expectation() {
   double e = 0.0;
 
@@ -206,7 +261,7 @@ MeasurementData CliffordState::myr(uint32_t a, std::optional<bool> outcome) {
 
 MeasurementData CliffordState::measure(const Measurement& m) {
   if (m.is_basis()) {
-    return mzr(m.qubits[0]);
+    return mzr(m.qubits[0], m.outcome);
   } else {
     QuantumCircuit qc(m.qubits.size());
 
@@ -227,6 +282,8 @@ MeasurementData CliffordState::weak_measure(const WeakMeasurement& m) {
   throw std::runtime_error("Cannot call a weak measurement on a Clifford state.");
 }
 
+// Reduces the Pauli to Z on its first qubit and reads the Z expectation there, on a fork of the state so
+// that this is const-correct. Backends with direct access to their stabilizers override this.
 std::complex<double> CliffordState::expectation(const PauliString& pauli) const {
   QuantumCircuit qc(num_qubits);
   Qubits qubits(num_qubits);
@@ -235,14 +292,35 @@ std::complex<double> CliffordState::expectation(const PauliString& pauli) const
 
   pauli.reduce(true, std::make_pair(&qc, qubits));
 
-  auto self = const_cast<CliffordState*>(this);
-  self->evolve(qc);
-  double exp = self->mzr_expectation(q);
-  self->evolve(qc.adjoint());
+  auto state = fork();
+  state->evolve(qc);
+  double exp = state->mzr_expectation(q);
 
   return std::complex<double>(exp, 0.0);
 }
 
+std::vector<double> CliffordState::endpoint_entanglement(const std::vector<uint32_t>& counts, const std::vector<uint32_t>& cuts, bool direction) const {
+  // num_right[i] = #{stabilizers with left endpoint >= i}
+  std::vector<int> num_right(num_qubits + 1, 0);
+  for (uint32_t i = num_qubits; i > 0; i--) {
+    num_right[i - 1] = num_right[i] + counts[i - 1];
+  }
+
+  std::vector<double> entanglement(cuts.size());
+  for (size_t k = 0; k < cuts.size(); k++) {
+    uint32_t i = cuts[k];
+    if (i >= num_qubits) {
+      throw std::invalid_argument(std::format("Cut {} is out of range for a state of {} qubits.", i, num_qubits));
+    }
+
+    // Left cuts are [0, i+1), right cuts are [i, n); S([0, i)) = S([i, n)) = (n - i) - num_right[i]
+    uint32_t j = direction ? i + 1 : i;
+    entanglement[k] = static_cast<double>(static_cast<int>(num_qubits - j) - num_right[j]);
+  }
+
+  return entanglement;
+}
+
 double CliffordState::purity() const {
   return 1.0;
 }
@@ -250,3 +328,8 @@ double CliffordState::purity() const {
 std::shared_ptr<QuantumState> CliffordState::partial_trace(const Qubits& qubits) const {
   throw not_implemented();
 }
+
+void CliffordState::restore_rng(const std::vector<char>& bytes) {
+  SnapshotReader reader(bytes);
+  Random::set_state(reader.read_header().rng_state);
+}
@@ -3,8 +3,10 @@
 #include "QuantumStates.h"
 #include "QuantumCircuit.h"
 #include "Random.hpp"
+#include "Snapshot.hpp"
 
 #include <algorithm>
+#include <span>
 
 enum CliffordType { CHP, GraphSim };
 
@@ -19,6 +21,11 @@ class CliffordState : public QuantumState {
     virtual EvolveResult evolve(const QuantumCircuit& qc, const Qubits& qubits, EvolveOpts opts=EvolveOpts()) override;
     virtual EvolveResult evolve(const QuantumCircuit& qc, EvolveOpts opts=EvolveOpts()) override;
 		virtual std::optional<MeasurementData> evolve(const QuantumInstruction& inst) override;
+
+    // Runs a circuit compiled by QuantumCircuit::compile. The registers are reset and receive the classical bits 
+    // and measurement outcomes; reusing them across runs of the same program avoids any allocation.
+    void evolve(const CompiledCircuit& program, CircuitRegisters& registers);
+    EvolveResult evolve(const CompiledCircuit& program, EvolveOpts opts=EvolveOpts());
     virtual void evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) override;
 
     virtual void h(uint32_t a)=0;
@@ -38,6 +45,10 @@ class CliffordState : public QuantumState {
     virtual void cy(uint32_t a, uint32_t b);
     virtual void swap(uint32_t a, uint32_t b);
 
+    // Applies an independent random Clifford on each of the supports, as if by calling random_clifford 
+    // on each in turn. Backends may override this to apply the whole layer at once.
+    virtual void random_clifford_layer(const std::vector<Qubits>& supports);
+
     virtual double mzr_expectation(uint32_t a) const=0;
     virtual double mzr_expectation();
 
@@ -62,4 +73,24 @@ class CliffordState : public QuantumState {
     virtual double purity() const override;
 
     virtual std::shared_ptr<QuantumState> partial_trace(const Qubits& qubits) const override;
+
+    // Compact binary snapshot of the state (see Snapshot.hpp), which also records the random number generator
+    // of the calling thread. deserialize restores the state but leaves the generator alone, so that trajectories
+    // branching from one snapshot draw independent outcomes; restore_rng resumes a checkpointed trajectory exactly.
+    virtual std::vector<char> serialize() const=0;
+    virtual void deserialize(const std::vector<char>& bytes)=0;
+    static void restore_rng(const std::vector<char>& bytes);
+
+    // A copy of the state which evolves independently. Backends may share storage with the original until
+    // either of them is modified.
+    virtual std::shared_ptr<CliffordState> fork() const=0;
+
+  protected:
+    // Applies a run of unconditioned gate ops from a CompiledCircuit. Backends may override this to hand
+    // the whole run to their storage at once.
+    virtual void apply_gates(std::span<const CompiledOp> ops);
+
+    // Entanglement across each cut from the endpoint distribution of the stabilizers, where counts[j] is the 
+    // number of stabilizers starting on site j in row echelon form (see TableauBase::endpoint_counts)
+    std::vector<double> endpoint_entanglement(const std::vector<uint32_t>& counts, const std::vector<uint32_t>& cuts, bool direction) const;
 };
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Instructions.hpp"
+
+// --- Flat bytecode for Clifford circuits --- //
+
+enum class OpCode : uint8_t {
+  H, S, Sd, X, Y, Z, SqrtX, SqrtY, SqrtXd, SqrtYd, CX, CY, CZ, SWAP,
+  Mzr, Measure,
+  NOT, AND, OR, XOR, NAND, CLEAR
+};
+
+// A single instruction of a CompiledCircuit. Gates and computational basis measurements carry their qubits in
+// args; classical operations carry their bits; Measure carries the index of its (Pauli) measurement in
+// CompiledCircuit::measurements.
+struct CompiledOp {
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  OpCode code;
+
+  // Forced outcome of an Mzr: 0 or 1, or 2 if the outcome is drawn at random
+  uint8_t outcome;
+
+  // Number of consecutive unconditioned gates starting at this op, zero for every other op.
+  // Runs are handed to the backend in one call.
+  uint32_t run;
+
+  uint32_t args[3];
+
+  // Classical bit which must be set for the op to execute, and the bit receiving a measurement outcome
+  uint32_t control;
+  uint32_t target;
+
+  // Index of the outcome of a measurement in the measurement record
+  uint32_t slot;
+
+  inline bool is_gate() const {
+    return code <= OpCode::SWAP;
+  }
+
+  inline std::optional<bool> forced_outcome() const {
+    if (outcome == 2) {
+      return std::nullopt;
+    }
+
+    return static_cast<bool>(outcome);
+  }
+};
+
+static_assert(std::is_trivially_copyable_v<CompiledOp>);
+
+// A Clifford QuantumCircuit lowered once, by QuantumCircuit::compile, into a flat array of ops.
+// Executing it involves no variant visits, virtual label() calls or string compares.
+struct CompiledCircuit {
+  uint32_t num_qubits;
+  uint32_t num_cbits;
+  uint32_t num_measurements;
+
+  std::vector<CompiledOp> ops;
+
+  // Measurements of Pauli strings other than Z, which are executed through CliffordState::measure
+  std::vector<Measurement> measurements;
+};
+
+// The classical bits and measurement record, as (outcome, probability) pairs, of an execution.
+// Reusing the same registers across runs of a program avoids any allocation after the first.
+struct CircuitRegisters {
+  BitString bits = BitString(0);
+  std::vector<std::pair<bool, double>> measurements;
+
+  void prepare(const CompiledCircuit& program) {
+    if (bits.num_bits != program.num_cbits) {
+      bits = BitString(program.num_cbits);
+    } else {
+      std::fill(bits.bits.begin(), bits.bits.end(), 0);
+    }
+
+    measurements.assign(program.num_measurements, {});
+  }
+};
+
+// The op of a single Clifford gate, on the qubits of the gate
+CompiledOp compile_gate(const Gate& gate);
+
+// Applies a gate op through the elementary gates h, s, sd, x, y, z, cx and cz of the target,
+// which can be a CliffordState or a tableau.
+template <typename T>
+inline void apply_compiled_gate(T& target, const CompiledOp& op) {
+  uint32_t a = op.args[0];
+  uint32_t b = op.args[1];
+  switch (op.code) {
+    case OpCode::H:
+      target.h(a);
+      break;
+    case OpCode::S:
+      target.s(a);
+      break;
+    case OpCode::Sd:
+      target.sd(a);
+      break;
+    case OpCode::X:
+      target.x(a);
+      break;
+    case OpCode::Y:
+      target.y(a);
+      break;
+    case OpCode::Z:
+      target.z(a);
+      break;
+    // sqrtX = HSH and sqrtY = HZ up to global phase
+    case OpCode::SqrtX:
+      target.h(a);
+      target.s(a);
+      target.h(a);
+      break;
+    case OpCode::SqrtXd:
+      target.h(a);
+      target.sd(a);
+      target.h(a);
+      break;
+    case OpCode::SqrtY:
+      target.z(a);
+      target.h(a);
+      break;
+    case OpCode::SqrtYd:
+      target.h(a);
+      target.z(a);
+      break;
+    case OpCode::CX:
+      target.cx(a, b);
+      break;
+    case OpCode::CY:
+      target.sd(b);
+      target.cx(a, b);
+      target.s(b);
+      break;
+    case OpCode::CZ:
+      target.cz(a, b);
+      break;
+    case OpCode::SWAP:
+      target.cx(a, b);
+      target.cx(b, a);
+      target.cx(a, b);
+      break;
+    default:
+      throw std::runtime_error("Op is not a gate.");
+  }
+}
@@ -15,10 +15,10 @@ class EntanglementEntropyState {
 
     EntanglementEntropyState(uint32_t system_size) : system_size(system_size) {}
 
-    virtual double entanglement(const QubitSupport& sites, uint32_t index)=0;
+    virtual double entanglement(const QubitSupport& sites, uint32_t index) const=0;
 
     template <typename T = double>
-    T cum_entanglement(uint32_t i, uint32_t index = 2u, bool direction = true) {
+    T cum_entanglement(uint32_t i, uint32_t index = 2u, bool direction = true) const {
       if (direction) { // Left-oriented cumulative entanglement 
         QubitInterval support = std::make_pair(0, i+1);
         return static_cast<T>(entanglement(support, index));
@@ -28,14 +28,28 @@ class EntanglementEntropyState {
       }
     }
 
-    template <typename T = double>
-    std::vector<T> get_entanglement(uint32_t index=2u) {
-      std::vector<T> entanglement(system_size);
+    // Cumulative entanglement across each of the given cuts. By default every cut is computed separately; 
+    // states which can obtain all cuts from a single computation should override this.
+    virtual std::vector<double> cum_entanglement_profile(const std::vector<uint32_t>& cuts, uint32_t index=2u, bool direction=true) const {
+      std::vector<double> entanglement(cuts.size());
 
-      for (uint32_t i = 0; i < system_size; i++) {
-        entanglement[i] = cum_entanglement<T>(i, index, true);
+      for (size_t k = 0; k < cuts.size(); k++) {
+        entanglement[k] = cum_entanglement<double>(cuts[k], index, direction);
       }
 
       return entanglement;
     }
+
+    template <typename T = double>
+    std::vector<T> get_entanglement(const std::vector<uint32_t>& cuts, uint32_t index=2u, bool direction=true) const {
+      std::vector<double> profile = cum_entanglement_profile(cuts, index, direction);
+      return std::vector<T>(profile.begin(), profile.end());
+    }
+
+    template <typename T = double>
+    std::vector<T> get_entanglement(uint32_t index=2u, bool direction=true) const {
+      std::vector<uint32_t> cuts(system_size);
+      std::iota(cuts.begin(), cuts.end(), 0);
+      return get_entanglement<T>(cuts, index, direction);
+    }
 };
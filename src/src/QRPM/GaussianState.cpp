@@ -0,0 +1,359 @@
+#include "GaussianState.h"
+
+#include <Eigen/Eigenvalues>
+#include <unsupported/Eigen/MatrixFunctions>
+
+using complex = std::complex<double>;
+
+// The Pfaffian of a real antisymmetric matrix, by Gaussian elimination with pivoting (Parlett-Reid)
+static double pfaffian(Eigen::MatrixXd A) {
+  Eigen::Index n = A.rows();
+  if (n % 2) {
+    return 0.0;
+  }
+
+  double pf = 1.0;
+  for (Eigen::Index k = 0; k + 1 < n; k += 2) {
+    Eigen::Index kp;
+    A.row(k).tail(n - k - 1).cwiseAbs().maxCoeff(&kp);
+    kp += k + 1;
+
+    if (kp != k + 1) {
+      A.row(k + 1).swap(A.row(kp));
+      A.col(k + 1).swap(A.col(kp));
+      pf = -pf;
+    }
+
+    if (A(k, k + 1) == 0.0) {
+      return 0.0;
+    }
+
+    pf *= A(k, k + 1);
+
+    Eigen::Index m = n - k - 2;
+    if (m > 0) {
+      Eigen::VectorXd tau = A.row(k).tail(m).transpose() / A(k, k + 1);
+      Eigen::VectorXd c = A.col(k + 1).tail(m);
+      A.bottomRightCorner(m, m) += tau * c.transpose() - c * tau.transpose();
+    }
+  }
+
+  return pf;
+}
+
+// The Majoranas a_1 < ... < a_k and phase w such that pauli = w gamma_{a_1} ... gamma_{a_k}. Qubit j carries
+// x_j = s_{2j} + s_{2j+1} and z_j = s_{2j+1} + sum_{a > 2j+1} s_a (mod 2), which is solved from the last qubit down.
+static std::pair<std::vector<uint32_t>, complex> majorana_decomposition(const PauliString& pauli) {
+  uint32_t num_qubits = pauli.num_qubits;
+
+  std::vector<bool> s(2*num_qubits);
+  bool parity = false;
+  for (uint32_t j = num_qubits; j-- > 0;) {
+    s[2*j + 1] = pauli.get_z(j) != parity;
+    s[2*j] = pauli.get_x(j) != s[2*j + 1];
+    parity = parity != (s[2*j] != s[2*j + 1]);
+  }
+
+  std::vector<uint32_t> majoranas;
+  PauliString product(num_qubits);
+  for (uint32_t a = 0; a < 2*num_qubits; a++) {
+    if (s[a]) {
+      majoranas.push_back(a);
+      product = product * majorana_operator(a, num_qubits);
+    }
+  }
+
+  return {majoranas, sign_from_bits((pauli.get_r() + 4 - product.get_r()) % 4)};
+}
+
+GaussianState::GaussianState(uint32_t num_qubits) : QuantumState(num_qubits) {
+  covariance = Eigen::MatrixXd::Zero(2*num_qubits, 2*num_qubits);
+  for (uint32_t j = 0; j < num_qubits; j++) {
+    covariance(2*j, 2*j + 1) = -1.0;
+    covariance(2*j + 1, 2*j) = 1.0;
+  }
+}
+
+std::vector<double> GaussianState::occupations() const {
+  std::vector<double> n(num_qubits);
+  for (uint32_t j = 0; j < num_qubits; j++) {
+    n[j] = (1.0 + covariance(2*j, 2*j + 1))/2.0;
+  }
+  return n;
+}
+
+std::string GaussianState::to_string() const {
+  std::string s = "";
+  for (double n : occupations()) {
+    s += std::format("{}{:.4f}", s.empty() ? "" : " ", n);
+  }
+  return std::format("GaussianState({}): <n> = [{}]", num_qubits, s);
+}
+
+// The covariance of the modes in the region has eigenvalues +-i nu_k, each contributing a mode with
+// occupation probabilities (1 +- nu_k)/2. The nu_k^2 are found, each twice, as the eigenvalues of the real
+// symmetric -M_A^2.
+double GaussianState::entanglement(const QubitSupport& support, uint32_t index) const {
+  Qubits qubits = to_qubits(support);
+  if (qubits.empty()) {
+    return 0.0;
+  }
+
+  std::vector<uint32_t> majoranas;
+  for (uint32_t q : qubits) {
+    majoranas.push_back(2*q);
+    majoranas.push_back(2*q + 1);
+  }
+
+  Eigen::MatrixXd block = covariance(majoranas, majoranas);
+  Eigen::MatrixXd square = -block*block;
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(square, Eigen::EigenvaluesOnly);
+
+  double s = 0.0;
+  for (Eigen::Index i = 0; i < solver.eigenvalues().size(); i++) {
+    double nu = std::sqrt(std::clamp(solver.eigenvalues()(i), 0.0, 1.0));
+    s += renyi_entropy(index, {(1.0 + nu)/2.0, (1.0 - nu)/2.0}, 2);
+  }
+
+  return s/2.0;
+}
+
+std::complex<double> GaussianState::expectation(const PauliString& pauli) const {
+  if (pauli.num_qubits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a GaussianState of {} qubits.", pauli.num_qubits, num_qubits));
+  }
+
+  auto [majoranas, phase] = majorana_decomposition(pauli);
+  if (majoranas.size() % 2) {
+    return 0.0;
+  }
+
+  // <gamma_a gamma_b> = -i M_ab, so the Pfaffian picks up (-i)^(k/2)
+  uint8_t wick_phase = (3*(majoranas.size()/2)) % 4;
+  return phase*sign_from_bits(wick_phase)*pfaffian(covariance(majoranas, majoranas));
+}
+
+double GaussianState::expectation(const BitString& bits, std::optional<QubitSupport> support) const {
+  Qubits qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  if (support) {
+    qubits = to_qubits(support.value());
+  }
+
+  if (bits.num_bits != qubits.size()) {
+    throw std::invalid_argument(std::format("Cannot evaluate a bitstring of {} bits on {} qubits.", bits.num_bits, qubits.size()));
+  }
+
+  // Z_q = -i gamma_{2q} gamma_{2q+1}, so the outcome z projects onto i gamma_{2q} gamma_{2q+1} = (-1)^(z+1)
+  GaussianState state(*this);
+  double p = 1.0;
+  for (size_t j = 0; j < qubits.size(); j++) {
+    uint32_t q = qubits[j];
+    double lambda = bits.get(j) ? 1.0 : -1.0;
+    p *= (1.0 + lambda*state.covariance(2*q, 2*q + 1))/2.0;
+    if (p < QS_ATOL*QS_ATOL) {
+      return 0.0;
+    }
+
+    state.condition(2*q, 2*q + 1, lambda);
+  }
+
+  return p;
+}
+
+std::shared_ptr<QuantumState> GaussianState::partial_trace(const Qubits& qubits) const {
+  throw not_implemented();
+}
+
+void GaussianState::evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) {
+  throw std::runtime_error("A GaussianState can only be evolved by FreeFermionGates.");
+}
+
+// Each term is rewritten as (i/4) sum_ab h_ab gamma_a gamma_b, with x_j = gamma_{2j} and y_j = gamma_{2j+1}:
+//   a (c_i^dag c_j + h.c.)     = (i/2) a (x_i y_j + x_j y_i)
+//   b (c_i^dag c_j^dag + h.c.) = (i/2) b (x_j y_i - x_i y_j)
+// exp(i t H) then sends gamma to exp(-t h) gamma, and rotates the covariance of the modes the gate touches.
+void GaussianState::evolve(const FreeFermionGate& gate) {
+  if (!gate.t) {
+    throw std::runtime_error("Cannot evolve a GaussianState by a FreeFermionGate with unbound parameter. Call bind_parameters([t]) first.");
+  }
+
+  const auto& terms = gate.get_terms();
+
+  Qubits modes;
+  for (const auto& term : terms) {
+    modes.push_back(term.i);
+    modes.push_back(term.j);
+  }
+  std::sort(modes.begin(), modes.end());
+  modes.erase(std::unique(modes.begin(), modes.end()), modes.end());
+
+  if (modes.empty()) {
+    return;
+  }
+
+  if (modes.back() >= num_qubits) {
+    throw std::invalid_argument(std::format("FreeFermionGate acts on mode {}, which is not valid for a GaussianState with {} modes.", modes.back(), num_qubits));
+  }
+
+  std::vector<uint32_t> majoranas;
+  for (uint32_t q : modes) {
+    majoranas.push_back(2*q);
+    majoranas.push_back(2*q + 1);
+  }
+
+  auto x = [&modes](uint32_t q) {
+    return 2*(std::lower_bound(modes.begin(), modes.end(), q) - modes.begin());
+  };
+
+  size_t k = majoranas.size();
+  Eigen::MatrixXd h = Eigen::MatrixXd::Zero(k, k);
+  for (const auto& term : terms) {
+    size_t xi = x(term.i);
+    size_t xj = x(term.j);
+    if (term.adj) {
+      h(xi, xj + 1) += term.a;
+      h(xj, xi + 1) += term.a;
+    } else if (term.i != term.j) {
+      size_t lo = std::min(xi, xj);
+      size_t hi = std::max(xi, xj);
+      double b = (term.j < term.i) ? -term.a : term.a;
+      h(hi, lo + 1) += b;
+      h(lo, hi + 1) -= b;
+    }
+  }
+  h = (h - h.transpose()).eval();
+
+  double t = gate.adj ? -gate.t.value() : gate.t.value();
+  Eigen::MatrixXd R = (-t*h).exp();
+
+  Eigen::MatrixXd rows = R*covariance(majoranas, Eigen::all);
+  covariance(majoranas, Eigen::all) = rows;
+  Eigen::MatrixXd cols = covariance(Eigen::all, majoranas)*R.transpose();
+  covariance(Eigen::all, majoranas) = cols;
+}
+
+EvolveResult GaussianState::evolve(const QuantumCircuit& circuit, EvolveOpts opts) {
+  return _evolve(circuit, opts);
+}
+
+EvolveResult GaussianState::evolve(const QuantumCircuit& circuit, const Qubits& qubits, EvolveOpts opts) {
+  return _evolve(circuit, qubits, opts);
+}
+
+// With Q = i gamma_a gamma_b and m = M_ab, the state (1 + lambda Q) rho (1 + lambda Q)/N with
+// N = 1 + lambda^2 + 2 lambda m has, by Wick's theorem, for k, l outside {a, b}
+//   M'_kl = M_kl + 2 lambda (M_kb M_la - M_ka M_lb)/N,   M'_ka = (1 - lambda^2) M_ka/N,
+//   M'_ab = ((1 + lambda^2) m + 2 lambda)/N
+void GaussianState::condition(uint32_t a, uint32_t b, double lambda) {
+  double m = covariance(a, b);
+  double norm = 1.0 + lambda*lambda + 2.0*lambda*m;
+
+  Eigen::VectorXd ca = covariance.col(a);
+  Eigen::VectorXd cb = covariance.col(b);
+
+  // A single rank-2 pass over the matrix
+  double c = 2.0*lambda/norm;
+  Eigen::MatrixXd U(ca.size(), 2);
+  Eigen::MatrixXd V(ca.size(), 2);
+  U << c*cb, -c*ca;
+  V << ca, cb;
+  covariance.noalias() += U*V.transpose();
+
+  double d = (1.0 - lambda*lambda)/norm;
+  covariance.col(a) = d*ca;
+  covariance.col(b) = d*cb;
+  covariance.row(a) = -d*ca.transpose();
+  covariance.row(b) = -d*cb.transpose();
+
+  covariance(a, a) = 0.0;
+  covariance(b, b) = 0.0;
+  covariance(a, b) = ((1.0 + lambda*lambda)*m + 2.0*lambda)/norm;
+  covariance(b, a) = -covariance(a, b);
+}
+
+std::tuple<uint32_t, uint32_t, double> GaussianState::majorana_bilinear(const PauliString& pauli) const {
+  auto [majoranas, phase] = majorana_decomposition(pauli);
+  // pauli = phase gamma_a gamma_b = (-i phase) i gamma_a gamma_b
+  complex c = complex(0.0, -1.0)*phase;
+  if (majoranas.size() != 2 || std::abs(c.imag()) > QS_ATOL) {
+    throw std::runtime_error(std::format("Cannot measure {} on a GaussianState; only Hermitian Majorana bilinears are Gaussian.", pauli.to_string_ops()));
+  }
+
+  return {majoranas[0], majoranas[1], c.real()};
+}
+
+MeasurementData GaussianState::measure(const Measurement& m) {
+  validate_qubits(m.qubits);
+  auto [a, b, c] = majorana_bilinear(m.get_pauli().superstring(m.qubits, num_qubits));
+
+  double prob_zero = std::clamp((1.0 + c*covariance(a, b))/2.0, 0.0, 1.0);
+
+  bool outcome;
+  if (m.is_forced()) {
+    outcome = m.get_outcome();
+    check_forced_measure(outcome, prob_zero);
+  } else {
+    outcome = randf() >= prob_zero;
+  }
+
+  condition(a, b, outcome ? -c : c);
+
+  return {outcome, outcome ? 1.0 - prob_zero : prob_zero};
+}
+
+// The Kraus operators (cosh(beta) +- sinh(beta) P)/sqrt(2 cosh(2 beta)) are proportional to 1 +- tanh(beta) P
+MeasurementData GaussianState::weak_measure(const WeakMeasurement& m) {
+  if (!m.beta) {
+    throw std::invalid_argument("Cannot perform a weak measurement with an unbound parameter.");
+  }
+  validate_qubits(m.qubits);
+  auto [a, b, c] = majorana_bilinear(m.get_pauli().superstring(m.qubits, num_qubits));
+
+  double beta = m.beta.value();
+  double prob_zero = std::clamp((1.0 + std::tanh(2.0*beta)*c*covariance(a, b))/2.0, 0.0, 1.0);
+
+  bool outcome;
+  if (m.is_forced()) {
+    outcome = m.get_outcome();
+    check_forced_measure(outcome, prob_zero);
+  } else {
+    outcome = randf() >= prob_zero;
+  }
+
+  condition(a, b, (outcome ? -c : c)*std::tanh(beta));
+
+  return {outcome, outcome ? 1.0 - prob_zero : prob_zero};
+}
+
+// Branches on the outcome of each qubit in turn, skipping branches of vanishing probability
+std::vector<double> GaussianState::probabilities() const {
+  std::vector<double> probs(basis, 0.0);
+
+  std::function<void(const GaussianState&, uint32_t, uint32_t, double)> branch = [&](const GaussianState& state, uint32_t q, uint32_t z, double p) {
+    if (q == num_qubits) {
+      probs[z] = p;
+      return;
+    }
+
+    for (uint32_t outcome = 0; outcome < 2; outcome++) {
+      double lambda = outcome ? 1.0 : -1.0;
+      double pq = p*(1.0 + lambda*state.covariance(2*q, 2*q + 1))/2.0;
+      if (pq < QS_ATOL*QS_ATOL) {
+        continue;
+      }
+
+      GaussianState next(state);
+      next.condition(2*q, 2*q + 1, lambda);
+      branch(next, q + 1, z | (outcome << q), pq);
+    }
+  };
+
+  branch(*this, 0, 0, 1.0);
+
+  return probs;
+}
+
+double GaussianState::purity() const {
+  return 1.0;
+}
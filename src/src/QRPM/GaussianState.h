@@ -0,0 +1,58 @@
+#pragma once
+
+#include "QuantumStates.h"
+
+// A fermionic Gaussian state of num_qubits modes, under the Jordan-Wigner map of majorana_operator:
+// gamma_{2j} = Z_0...Z_{j-1} X_j and gamma_{2j+1} = Z_0...Z_{j-1} Y_j. The state is stored as its real
+// antisymmetric covariance matrix M_ab = (i/2)<[gamma_a, gamma_b]>, so memory is O(n^2) and FreeFermionGates,
+// measurements of Majorana bilinears and interval entanglement cost at most O(n^3).
+//
+// Only Gaussian operations are supported: FreeFermionGates, and (weak) measurements of Paulis which are a
+// bilinear i gamma_a gamma_b, such as Z_j or X_j Z_{j+1}...Z_{k-1} Y_k. Entanglement is that of the fermionic
+// modes in the region, which agrees with the qubit entanglement when the region is an interval.
+class GaussianState : public QuantumState {
+  public:
+    using QuantumState::evolve;
+    using QuantumState::expectation;
+    using QuantumState::partial_trace;
+
+    Eigen::MatrixXd covariance;
+
+    GaussianState()=default;
+
+    // The vacuum |0...0>
+    GaussianState(uint32_t num_qubits);
+
+    virtual std::string to_string() const override;
+
+    virtual double entanglement(const QubitSupport& support, uint32_t index) const override;
+
+    // By Wick's theorem, from the Pfaffian of the covariance restricted to the Majoranas of the Pauli
+    virtual std::complex<double> expectation(const PauliString& pauli) const override;
+    virtual double expectation(const BitString& bits, std::optional<QubitSupport> support=std::nullopt) const override;
+
+    virtual std::shared_ptr<QuantumState> partial_trace(const Qubits& qubits) const override;
+
+    virtual void evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) override;
+    virtual void evolve(const FreeFermionGate& gate) override;
+
+    // Circuits are run as given: simplification may fuse instructions into dense matrices
+    virtual EvolveResult evolve(const QuantumCircuit& circuit, EvolveOpts opts=EvolveOpts()) override;
+    virtual EvolveResult evolve(const QuantumCircuit& circuit, const Qubits& qubits, EvolveOpts opts=EvolveOpts()) override;
+
+    virtual MeasurementData measure(const Measurement& m) override;
+    virtual MeasurementData weak_measure(const WeakMeasurement& m) override;
+
+    // <n_j> for each mode
+    std::vector<double> occupations() const;
+
+    virtual std::vector<double> probabilities() const override;
+    virtual double purity() const override;
+
+  private:
+    // Conditions the state on the operator (1 + lambda i gamma_a gamma_b), which is a projector for |lambda| = 1
+    void condition(uint32_t a, uint32_t b, double lambda);
+
+    // The Majorana bilinear a < b and sign c such that pauli = c i gamma_a gamma_b
+    std::tuple<uint32_t, uint32_t, double> majorana_bilinear(const PauliString& pauli) const;
+};
@@ -558,7 +558,8 @@ std::shared_ptr<Gate> FreeFermionGate::to_gate() const {
     H += embed_unitary(term_to_matrix(term), to_qubits(get_term_support(term)), N);
   }
 
-  Eigen::MatrixXcd U = (gates::i * t.value() * H).exp();
+  double theta = adj ? -t.value() : t.value();
+  Eigen::MatrixXcd U = (gates::i * theta * H).exp();
   return std::make_shared<MatrixGate>(U, support);
 }
 
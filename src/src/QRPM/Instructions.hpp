@@ -419,6 +419,10 @@ class FreeFermionGate {
 
     std::string to_string() const;
 
+    const std::vector<QuadraticTerm>& get_terms() const {
+      return terms;
+    }
+
     Qubits get_support() const;
     Eigen::MatrixXcd to_matrix() const;
     std::shared_ptr<Gate> to_gate() const;
@@ -0,0 +1,46 @@
+#include "MixedCliffordState.h"
+
+std::string MixedCliffordState::to_string() const {
+  return tableau.to_string();
+}
+
+double MixedCliffordState::entanglement(const QubitSupport& support, uint32_t index) const {
+  return tableau.entropy(to_qubits(support));
+}
+
+std::complex<double> MixedCliffordState::expectation(const PauliString& pauli) const {
+  return tableau.expectation(pauli);
+}
+
+double MixedCliffordState::expectation(const BitString& bits, std::optional<QubitSupport> support) const {
+  if (support) {
+    Qubits qubits_complement = to_qubits(support_complement(support.value(), num_qubits));
+    return tableau.partial_trace(qubits_complement).probability(bits);
+  }
+
+  return tableau.probability(bits);
+}
+
+std::shared_ptr<QuantumState> MixedCliffordState::partial_trace(const Qubits& qubits) const {
+  return std::make_shared<MixedCliffordState>(tableau.partial_trace(qubits));
+}
+
+void MixedCliffordState::evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) {
+  throw std::runtime_error("Cannot evolve a MixedCliffordState.");
+}
+
+MeasurementData MixedCliffordState::measure(const Measurement& m) {
+  throw std::runtime_error("Cannot measure a MixedCliffordState.");
+}
+
+MeasurementData MixedCliffordState::weak_measure(const WeakMeasurement& m) {
+  throw std::runtime_error("Cannot measure a MixedCliffordState.");
+}
+
+std::vector<double> MixedCliffordState::probabilities() const {
+  return tableau.probabilities();
+}
+
+double MixedCliffordState::purity() const {
+  return tableau.purity();
+}
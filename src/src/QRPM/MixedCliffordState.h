@@ -0,0 +1,35 @@
+#pragma once
+
+#include "QuantumStates.h"
+#include "TableauSIMD.h"
+
+// The reduced state of a Clifford state on a region, returned by QuantumCHPState::partial_trace. It holds
+// only a MixedTableau, so entropies, purity and Pauli expectations on the region stay polynomial in its size.
+// The state is read-only: it cannot be evolved or measured.
+class MixedCliffordState : public QuantumState {
+  public:
+    using QuantumState::expectation;
+    using QuantumState::partial_trace;
+
+    MixedTableau tableau;
+
+    MixedCliffordState()=default;
+    MixedCliffordState(const MixedTableau& tableau) : QuantumState(tableau.num_qubits), tableau(tableau) {}
+
+    virtual std::string to_string() const override;
+
+    virtual double entanglement(const QubitSupport& support, uint32_t index) const override;
+
+    virtual std::complex<double> expectation(const PauliString& pauli) const override;
+    virtual double expectation(const BitString& bits, std::optional<QubitSupport> support=std::nullopt) const override;
+
+    virtual std::shared_ptr<QuantumState> partial_trace(const Qubits& qubits) const override;
+
+    virtual void evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) override;
+
+    virtual MeasurementData measure(const Measurement& m) override;
+    virtual MeasurementData weak_measure(const WeakMeasurement& m) override;
+
+    virtual std::vector<double> probabilities() const override;
+    virtual double purity() const override;
+};
@@ -0,0 +1,380 @@
+#include "PauliFrameSampler.h"
+#include "QuantumCHPState.h"
+
+// Shots are simulated in batches of this many words, so that the frames of a batch stay in cache
+constexpr size_t FRAME_BATCH_WORDS = 64;
+
+std::vector<bool> FrameSamples::get_measurements(size_t shot) const {
+  std::vector<bool> outcomes(measurements.num_rows);
+  for (size_t m = 0; m < measurements.num_rows; m++) {
+    outcomes[m] = measurements.get(m, shot);
+  }
+  return outcomes;
+}
+
+BitString FrameSamples::get_cbits(size_t shot) const {
+  BitString bits(cbits.num_rows);
+  for (size_t c = 0; c < cbits.num_rows; c++) {
+    bits.set(c, cbits.get(c, shot));
+  }
+  return bits;
+}
+
+PauliFrameSampler::PauliFrameSampler(const QuantumCircuit& circuit, const PauliNoiseModel& noise)
+  : num_qubits(circuit.get_num_qubits()), num_cbits(circuit.get_num_cbits()), num_measurements(circuit.get_num_measurements()), noise(noise) {
+  if (!circuit.is_clifford()) {
+    throw std::invalid_argument("Provided circuit is not Clifford.");
+  }
+
+  if (circuit.get_num_parameters() > 0) {
+    throw std::invalid_argument("Unbound QuantumCircuit parameters; cannot sample.");
+  }
+
+  for (double p : {noise.px, noise.py, noise.pz, noise.p_readout}) {
+    if (p < 0.0 || p > 1.0) {
+      throw std::invalid_argument(std::format("Invalid noise probability {}.", p));
+    }
+  }
+
+  if (noise.px + noise.py + noise.pz > 1.0) {
+    throw std::invalid_argument(std::format("Pauli error probabilities {}, {}, {} sum to more than one.", noise.px, noise.py, noise.pz));
+  }
+
+  // Run the reference shot, recording its measurement outcomes and control bits into the ops
+  QuantumCHPState reference(num_qubits);
+  BitString bits(num_cbits);
+  std::map<size_t, size_t> reversed_map = reverse_map(circuit.get_measurement_map());
+
+  auto evolve_reference = [&](const QuantumInstruction& qinst, size_t i, TargetOpt target, bool noisy) {
+    if (std::holds_alternative<Measurement>(qinst) && std::get<Measurement>(qinst).is_forced()) {
+      throw std::invalid_argument("Cannot sample forced measurements with Pauli frames.");
+    }
+
+    std::optional<MeasurementData> result = reference.evolve(qinst);
+    if (result && target) {
+      bits.set(target.value(), result->first);
+    }
+
+    std::visit(quantumcircuit_utils::overloaded {
+      [&](std::shared_ptr<Gate> gate) {
+        compile_gate(gate, noisy);
+      },
+      [&](const Measurement& m) {
+        compile_measurement(m, reversed_map.at(i), target, result->first);
+      },
+      [](const auto&) {
+        throw std::runtime_error("Invalid instruction provided to PauliFrameSampler.");
+      }
+    }, qinst);
+  };
+
+  for (size_t i = 0; i < circuit.length(); i++) {
+    std::visit(quantumcircuit_utils::overloaded {
+      [&](const QuantumInstruction& qinst) {
+        evolve_reference(qinst, i, std::nullopt, true);
+      },
+      [&](const ClassicalInstruction& clinst) {
+        clinst.apply(bits);
+        ops.push_back(clinst);
+      },
+      [&](const ConditionedInstruction& cinst) {
+        bool execute = cinst.should_execute(bits);
+        if (cinst.control) {
+          uint32_t control = cinst.control.value();
+          if (std::holds_alternative<std::shared_ptr<Gate>>(cinst.inst)) {
+            std::shared_ptr<Gate> gate = std::get<std::shared_ptr<Gate>>(cinst.inst);
+            std::string name = gate->label();
+            if (name == "X" || name == "Y" || name == "Z") {
+              Pauli pauli = (name == "X") ? Pauli::X : (name == "Y") ? Pauli::Y : Pauli::Z;
+              ops.push_back(FramePauli{pauli, gate->qubits[0], control, execute});
+              if (execute) {
+                reference.evolve(cinst.inst);
+              }
+              return;
+            }
+          }
+
+          ops.push_back(FrameGuard{control, execute});
+        }
+
+        if (execute) {
+          evolve_reference(cinst.inst, i, cinst.target, !cinst.control);
+        }
+      }
+    }, circuit.instructions[i]);
+  }
+}
+
+void PauliFrameSampler::compile_gate(const std::shared_ptr<Gate>& gate, bool noisy) {
+  // Classify the gate through the same opcode table as QuantumCircuit::compile. Frames do not track signs, so
+  // Paulis are dropped, S and Sd both act as S, sqrtX = HSH and sqrtY = H up to signs.
+  CompiledOp op = ::compile_gate(*gate);
+  uint32_t a = op.args[0];
+  uint32_t b = op.args[1];
+
+  switch (op.code) {
+    case OpCode::H:
+    case OpCode::SqrtY:
+    case OpCode::SqrtYd:
+      ops.push_back(FrameGate{GateType::H, a, a});
+      break;
+    case OpCode::S:
+    case OpCode::Sd:
+      ops.push_back(FrameGate{GateType::S, a, a});
+      break;
+    case OpCode::SqrtX:
+    case OpCode::SqrtXd:
+      ops.push_back(FrameGate{GateType::H, a, a});
+      ops.push_back(FrameGate{GateType::S, a, a});
+      ops.push_back(FrameGate{GateType::H, a, a});
+      break;
+    case OpCode::CX:
+      ops.push_back(FrameGate{GateType::CX, a, b});
+      break;
+    case OpCode::CY:
+      ops.push_back(FrameGate{GateType::CY, a, b});
+      break;
+    case OpCode::CZ:
+      ops.push_back(FrameGate{GateType::CZ, a, b});
+      break;
+    case OpCode::SWAP:
+      ops.push_back(FrameGate{GateType::SWAP, a, b});
+      break;
+    case OpCode::X:
+    case OpCode::Y:
+    case OpCode::Z:
+      break;
+    default:
+      throw std::runtime_error(std::format("Invalid instruction \"{}\" provided to PauliFrameSampler.", gate->label()));
+  }
+
+  if (noisy && noise.has_gate_noise()) {
+    ops.push_back(FrameNoise{qubits[0], qubits.size() > 1 ? qubits[1] : qubits[0]});
+  }
+}
+
+// Mirrors CliffordState::measure: a Pauli measurement is rotated onto a single qubit, measured, and rotated back
+void PauliFrameSampler::compile_measurement(const Measurement& m, size_t index, TargetOpt target, bool reference) {
+  if (m.is_basis()) {
+    ops.push_back(FrameMeasurement{m.qubits[0], index, target, reference});
+    return;
+  }
+
+  QuantumCircuit qc(m.qubits.size());
+  auto args = argsort(m.qubits);
+  m.pauli.value().reduce(true, std::make_pair(&qc, args));
+
+  auto compile_mapped = [&](const QuantumCircuit& circuit) {
+    QuantumCircuit mapped(circuit);
+    mapped.resize_qubits(num_qubits);
+    mapped.apply_qubit_map(m.qubits);
+    for (const Instruction& inst : mapped.instructions) {
+      compile_gate(std::get<std::shared_ptr<Gate>>(std::get<QuantumInstruction>(inst)), false);
+    }
+  };
+
+  compile_mapped(qc);
+  ops.push_back(FrameMeasurement{std::ranges::min(m.qubits), index, target, reference});
+  compile_mapped(qc.adjoint());
+}
+
+FrameSamples PauliFrameSampler::sample(size_t num_shots) const {
+  constexpr size_t word_size = binary_word_size();
+  size_t total_words = num_shots / word_size + static_cast<bool>(num_shots % word_size);
+
+  FrameSamples samples{num_shots, BinaryMatrix(num_measurements, num_shots), BinaryMatrix(num_cbits, num_shots)};
+
+  RandomBits rng;
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  std::vector<binary_word> frame_x(num_qubits*FRAME_BATCH_WORDS);
+  std::vector<binary_word> frame_z(num_qubits*FRAME_BATCH_WORDS);
+  std::vector<binary_word> batch_cbits(num_cbits*FRAME_BATCH_WORDS);
+
+  for (size_t offset = 0; offset < total_words; offset += FRAME_BATCH_WORDS) {
+    size_t width = std::min(FRAME_BATCH_WORDS, total_words - offset);
+    auto x = [&](uint32_t q) { return frame_x.data() + q*width; };
+    auto z = [&](uint32_t q) { return frame_z.data() + q*width; };
+    auto cbit = [&](uint32_t c) { return batch_cbits.data() + c*width; };
+
+    // Shots past num_shots in the last word are simulated but never compared or reported
+    auto valid = [&](size_t w) {
+      size_t num_bits = num_shots - (offset + w)*word_size;
+      return (num_bits >= word_size) ? ~static_cast<binary_word>(0) : (static_cast<binary_word>(1) << num_bits) - 1;
+    };
+
+    // Calls f on each bit of the batch independently with probability p
+    auto for_each_event = [&](double p, auto f) {
+      if (p <= 0.0) {
+        return;
+      }
+
+      // geometric_distribution requires p < 1
+      if (p >= 1.0) {
+        for (size_t w = 0; w < width; w++) {
+          f(w, ~static_cast<binary_word>(0));
+        }
+        return;
+      }
+
+      std::geometric_distribution<size_t> gap(p);
+      for (size_t k = gap(rng); k < width*word_size; k += gap(rng) + 1) {
+        f(k / word_size, static_cast<binary_word>(1) << (k % word_size));
+      }
+    };
+
+    auto apply_gate_noise = [&](uint32_t q) {
+      double p = noise.px + noise.py + noise.pz;
+      for_each_event(p, [&](size_t w, binary_word bit) {
+        double u = p*uniform(rng);
+        if (u < noise.px + noise.py) {
+          x(q)[w] ^= bit;
+        }
+        if (u >= noise.px) {
+          z(q)[w] ^= bit;
+        }
+      });
+    };
+
+    // The initial state |0...0> is stabilized by every Z string
+    std::fill(frame_x.begin(), frame_x.begin() + num_qubits*width, 0u);
+    Random::fill_bits(std::span<binary_word>(frame_z.data(), num_qubits*width));
+    std::fill(batch_cbits.begin(), batch_cbits.begin() + num_cbits*width, 0u);
+
+    for (const FrameOp& op : ops) {
+      std::visit(quantumcircuit_utils::overloaded {
+        [&](const FrameGate& gate) {
+          binary_word* xa = x(gate.a);
+          binary_word* za = z(gate.a);
+          binary_word* xb = x(gate.b);
+          binary_word* zb = z(gate.b);
+          switch (gate.type) {
+            case GateType::H: {
+              std::swap_ranges(xa, xa + width, za);
+              break;
+            } case GateType::S: {
+              for (size_t w = 0; w < width; w++) {
+                za[w] ^= xa[w];
+              }
+              break;
+            } case GateType::CX: {
+              for (size_t w = 0; w < width; w++) {
+                xb[w] ^= xa[w];
+                za[w] ^= zb[w];
+              }
+              break;
+            } case GateType::CY: {
+              // CY = S_b CX S_b^dagger
+              for (size_t w = 0; w < width; w++) {
+                zb[w] ^= xb[w];
+                xb[w] ^= xa[w];
+                za[w] ^= zb[w];
+                zb[w] ^= xb[w];
+              }
+              break;
+            } case GateType::CZ: {
+              for (size_t w = 0; w < width; w++) {
+                za[w] ^= xb[w];
+                zb[w] ^= xa[w];
+              }
+              break;
+            } case GateType::SWAP: {
+              std::swap_ranges(xa, xa + width, xb);
+              std::swap_ranges(za, za + width, zb);
+              break;
+            }
+          }
+        },
+        [&](const FrameNoise& n) {
+          apply_gate_noise(n.a);
+          if (n.b != n.a) {
+            apply_gate_noise(n.b);
+          }
+        },
+        [&](const FramePauli& p) {
+          binary_word reference = p.reference ? ~static_cast<binary_word>(0) : 0u;
+          const binary_word* control = cbit(p.control);
+          for (size_t w = 0; w < width; w++) {
+            binary_word mask = control[w] ^ reference;
+            if (p.pauli == Pauli::X || p.pauli == Pauli::Y) {
+              x(p.qubit)[w] ^= mask;
+            }
+            if (p.pauli == Pauli::Z || p.pauli == Pauli::Y) {
+              z(p.qubit)[w] ^= mask;
+            }
+          }
+        },
+        [&](const FrameMeasurement& m) {
+          binary_word reference = m.reference ? ~static_cast<binary_word>(0) : 0u;
+          binary_word* record = samples.measurements.row(m.index) + offset;
+          for (size_t w = 0; w < width; w++) {
+            record[w] = x(m.qubit)[w] ^ reference;
+          }
+
+          for_each_event(noise.p_readout, [&](size_t w, binary_word bit) {
+            record[w] ^= bit;
+          });
+
+          if (m.target) {
+            std::copy(record, record + width, cbit(m.target.value()));
+          }
+
+          // The post-measurement state is stabilized by Z on the measured qubit
+          Random::fill_bits(std::span<binary_word>(z(m.qubit), width));
+        },
+        [&](const FrameGuard& g) {
+          binary_word reference = g.reference ? ~static_cast<binary_word>(0) : 0u;
+          const binary_word* control = cbit(g.control);
+          for (size_t w = 0; w < width; w++) {
+            if ((control[w] ^ reference) & valid(w)) {
+              throw std::runtime_error(std::format("Classical bit {} differs between shots; only Pauli gates can be conditioned on it when sampling Pauli frames.", g.control));
+            }
+          }
+        },
+        [&](const ClassicalInstruction& clinst) {
+          const auto& b = clinst.bits;
+          for (size_t w = 0; w < width; w++) {
+            switch (clinst.op) {
+              case ClassicalInstruction::OpType::NOT: {
+                cbit(b[1])[w] = ~cbit(b[0])[w];
+                break;
+              } case ClassicalInstruction::OpType::AND: {
+                cbit(b[2])[w] = cbit(b[0])[w] & cbit(b[1])[w];
+                break;
+              } case ClassicalInstruction::OpType::OR: {
+                cbit(b[2])[w] = cbit(b[0])[w] | cbit(b[1])[w];
+                break;
+              } case ClassicalInstruction::OpType::XOR: {
+                cbit(b[2])[w] = cbit(b[0])[w] ^ cbit(b[1])[w];
+                break;
+              } case ClassicalInstruction::OpType::NAND: {
+                cbit(b[2])[w] = ~(cbit(b[0])[w] & cbit(b[1])[w]);
+                break;
+              } case ClassicalInstruction::OpType::CLEAR: {
+                cbit(b[0])[w] = 0u;
+                break;
+              }
+            }
+          }
+        }
+      }, op);
+    }
+
+    for (uint32_t c = 0; c < num_cbits; c++) {
+      std::copy(cbit(c), cbit(c) + width, samples.cbits.row(c) + offset);
+    }
+  }
+
+  // Clear the shots past num_shots
+  if (num_shots % word_size) {
+    binary_word mask = (static_cast<binary_word>(1) << (num_shots % word_size)) - 1;
+    for (size_t m = 0; m < num_measurements; m++) {
+      samples.measurements.row(m)[total_words - 1] &= mask;
+    }
+    for (uint32_t c = 0; c < num_cbits; c++) {
+      samples.cbits.row(c)[total_words - 1] &= mask;
+    }
+  }
+
+  return samples;
+}
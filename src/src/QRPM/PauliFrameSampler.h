@@ -0,0 +1,100 @@
+#pragma once
+
+#include <random>
+#include <variant>
+#include <vector>
+
+#include "QuantumCircuit.h"
+#include "BinaryMatrix.hpp"
+
+// Pauli noise injected by the sampler: after every gate which is not classically controlled, each of its
+// qubits independently suffers X, Y or Z with probabilities px, py and pz, and every measurement outcome 
+// is flipped with probability p_readout.
+struct PauliNoiseModel {
+  double px = 0.0;
+  double py = 0.0;
+  double pz = 0.0;
+  double p_readout = 0.0;
+
+  bool has_gate_noise() const {
+    return px + py + pz > 0.0;
+  }
+};
+
+// Measurement records of many shots. Row m of measurements holds the outcome of the m-th measurement of
+// the circuit in every shot (bit s is shot s); likewise for the final values of the classical bits.
+struct FrameSamples {
+  size_t num_shots;
+  BinaryMatrix measurements;
+  BinaryMatrix cbits;
+
+  std::vector<bool> get_measurements(size_t shot) const;
+  BitString get_cbits(size_t shot) const;
+};
+
+// Samples a Clifford QuantumCircuit by Pauli-frame simulation. A single reference shot is run on a
+// tableau; every other shot differs from it by a Pauli frame, which is pushed through the circuit
+// 64 shots per word, without tracking signs. A measurement then reads the reference outcome, flipped
+// where the frame anticommutes with Z. Random outcomes come from multiplying each frame by random
+// elements of the stabilizer group (random Z's on |0> and after each measurement), which leaves the
+// state unchanged.
+//
+// Classically controlled Pauli gates are supported; any other conditioned instruction must be executed
+// in every shot exactly when it is in the reference shot. Forced measurements cannot be sampled.
+class PauliFrameSampler {
+  private:
+    enum class GateType { H, S, CX, CY, CZ, SWAP };
+
+    struct FrameGate {
+      GateType type;
+      uint32_t a;
+      uint32_t b;
+    };
+
+    // A Pauli which is applied in the shots whose control bit is set; the frame picks it up wherever
+    // the control differs from the reference shot
+    struct FramePauli {
+      Pauli pauli;
+      uint32_t qubit;
+      uint32_t control;
+      bool reference;
+    };
+
+    struct FrameMeasurement {
+      uint32_t qubit;
+      size_t index;
+      TargetOpt target;
+      bool reference;
+    };
+
+    struct FrameNoise {
+      uint32_t a;
+      uint32_t b;
+    };
+
+    // Checks that every shot agrees with the reference shot on a control bit
+    struct FrameGuard {
+      uint32_t control;
+      bool reference;
+    };
+
+    using FrameOp = std::variant<FrameGate, FramePauli, FrameMeasurement, FrameNoise, FrameGuard, ClassicalInstruction>;
+
+    uint32_t num_qubits;
+    uint32_t num_cbits;
+    size_t num_measurements;
+    std::vector<FrameOp> ops;
+    PauliNoiseModel noise;
+
+    void compile_gate(const std::shared_ptr<Gate>& gate, bool noisy);
+    void compile_measurement(const Measurement& m, size_t index, TargetOpt target, bool reference);
+
+  public:
+    PauliFrameSampler(const QuantumCircuit& circuit, const PauliNoiseModel& noise=PauliNoiseModel());
+
+    size_t get_num_measurements() const {
+      return num_measurements;
+    }
+
+    FrameSamples sample(size_t num_shots) const;
+};
@@ -4,7 +4,7 @@
 
 BitString::BitString(uint32_t num_bits) : num_bits(num_bits) {
   size_t width = num_bits / binary_word_size() + static_cast<bool>(num_bits % binary_word_size());
-  bits = std::vector<binary_word>(width, 0);
+  bits = WordBuffer(width);
 }
 
 binary_word BitString::to_integer() const {
@@ -22,7 +22,7 @@ BitString BitString::from_bits(size_t num_bits, binary_word bits) {
 
   BitString bit_string(num_bits);
 
-  bit_string.bits = std::vector<binary_word>(1);
+  bit_string.bits = WordBuffer(1);
   bit_string[0] = bits;
 
   return bit_string;
@@ -31,9 +31,10 @@ BitString BitString::from_bits(size_t num_bits, binary_word bits) {
 BitString BitString::random(size_t num_bits, double p) {
   BitString bits(num_bits);
 
+  std::vector<double> u(num_bits);
+  Random::fill_uniform(u);
   for (size_t i = 0; i < num_bits; i++) {
-    bool v = randf() < p;
-    bits.set(i, v);
+    bits.set(i, u[i] < p);
   }
 
   return bits;
@@ -41,8 +42,8 @@ BitString BitString::random(size_t num_bits, double p) {
 
 uint32_t BitString::hamming_weight() const {
   uint32_t r = 0;
-  for (size_t i = 0; i < num_bits; i++) {
-    r += get(i);
+  for (const binary_word w : bits) {
+    r += std::popcount(w);
   }
   return r;
 }
@@ -195,8 +196,10 @@ PauliString::PauliString(const std::vector<Pauli>& paulis, uint8_t phase) : Paul
 PauliString PauliString::rand(uint32_t num_qubits) {
   PauliString p(num_qubits);
 
-  for (size_t i = 0; i < p.bit_string.size(); i++) {
-    p.bit_string[i] = randi();
+  Random::fill_bits(p.bit_string.bits);
+  size_t num_bits = 2*num_qubits;
+  if (num_bits % binary_word_size()) {
+    p.bit_string.bits.back() &= (static_cast<binary_word>(1) << (num_bits % binary_word_size())) - 1;
   }
 
   p.set_r(randi() % 4);
@@ -292,11 +295,11 @@ PauliString PauliString::superstring(const Qubits& qubits, size_t new_num_qubits
 uint8_t PauliString::get_multiplication_phase(const PauliString& p1, const PauliString& p2) {
   uint8_t s = p1.get_r() + p2.get_r();
 
-  for (uint32_t j = 0; j < p1.num_qubits; j++) {
-    s += multiplication_phase(p1.get_xz(j), p2.get_xz(j));
+  for (size_t k = 0; k < p1.bit_string.size(); k++) {
+    s += word_multiplication_phase(p1.bit_string[k], p2.bit_string[k]);
   }
 
-  return s;
+  return s & 0b11;
 }
 
 bool PauliString::hermitian() const {
@@ -318,11 +321,9 @@ PauliString PauliString::operator*(const PauliString& other) const {
     throw std::runtime_error(std::format("Multiplying PauliStrings with {} qubits and {} qubits do not match.", num_qubits, other.num_qubits));
   }
 
-  PauliString p(num_qubits);
-
+  PauliString p(*this);
   p.set_r(PauliString::get_multiplication_phase(*this, other));
-
-  p.bit_string = bit_string ^ other.bit_string;
+  p.bit_string ^= other.bit_string;
 
   return p;
 }
@@ -341,17 +342,7 @@ bool PauliString::operator==(const PauliString &rhs) const {
     return false;
   }
 
-  for (uint32_t i = 0; i < num_qubits; i++) {
-    if (get_x(i) != rhs.get_x(i)) {
-      return false;
-    }
-
-    if (get_z(i) != rhs.get_z(i)) {
-      return false;
-    }
-  }
-
-  return true;
+  return bit_string.bits == rhs.bit_string.bits;
 }
 
 bool PauliString::operator!=(const PauliString &rhs) const { 
@@ -721,12 +712,10 @@ bool PauliString::commutes(const PauliString& p) const {
     throw std::invalid_argument(std::format("p = {} has {} qubits and q = {} has {} qubits; cannot check commutation.", p.to_string_ops(), p.num_qubits, to_string_ops(), num_qubits));
   }
 
-  uint32_t anticommuting_indices = 0u;
-  for (uint32_t i = 0; i < num_qubits; i++) {
-    if (!commutes_at(p, i)) {
-      anticommuting_indices++;
-    }
+  bool anticommutes = false;
+  for (size_t k = 0; k < bit_string.size(); k++) {
+    anticommutes ^= word_anticommutes(bit_string[k], p.bit_string[k]);
   }
 
-  return anticommuting_indices % 2 == 0;
+  return !anticommutes;
 }
@@ -4,23 +4,15 @@
 #include <iostream>
 
 #include <ranges>
+#include <array>
+#include <bit>
+#include <memory>
 
 #include "CircuitUtils.h"
 #include "Random.hpp"
 
 class QuantumCircuit;
 
-template <typename T>
-static void remove_even_indices(std::vector<T> &v) {
-  uint32_t vlen = v.size();
-  for (uint32_t i = 0; i < vlen; i++) {
-    uint32_t j = vlen - i - 1;
-    if ((j % 2)) {
-      v.erase(v.begin() + j);
-    }
-  }
-}
-
 enum Pauli {
   I, X, Z, Y
 };
@@ -111,9 +103,112 @@ static inline constexpr size_t binary_word_size() {
   return 8u*sizeof(binary_word);
 }
 
+// Rows are read as (x, z) pairs; the x bits sit in the even positions of each word
+constexpr binary_word EVEN_BITS = static_cast<binary_word>(0x5555555555555555ull);
+
+// Marks the sites at which the phase g(src, dst) is +1 and -1, given the x and z bits of both rows
+inline void phase_counts(binary_word x1, binary_word z1, binary_word x2, binary_word z2, binary_word& plus, binary_word& minus) {
+  plus  = (x1 & z1 & z2 & ~x2) | (x1 & ~z1 & x2 & z2) | (~x1 & z1 & x2 & ~z2);
+  minus = (x1 & z1 & x2 & ~z2) | (x1 & ~z1 & ~x2 & z2) | (~x1 & z1 & x2 & z2);
+}
+
+// The phase i^g picked up at the sites of one word when multiplying the word w2 by w1, as g mod 4
+inline uint8_t word_multiplication_phase(binary_word w1, binary_word w2) {
+  binary_word plus, minus;
+  phase_counts(w1 & EVEN_BITS, (w1 >> 1) & EVEN_BITS, w2 & EVEN_BITS, (w2 >> 1) & EVEN_BITS, plus, minus);
+  return static_cast<uint8_t>(std::popcount(plus) - std::popcount(minus)) & 0b11;
+}
+
+// Whether the Paulis of one word anticommute at an odd number of sites
+inline bool word_anticommutes(binary_word w1, binary_word w2) {
+  binary_word x1 = w1 & EVEN_BITS;
+  binary_word z1 = (w1 >> 1) & EVEN_BITS;
+  binary_word x2 = w2 & EVEN_BITS;
+  binary_word z2 = (w2 >> 1) & EVEN_BITS;
+  return std::popcount((x1 & z2) ^ (z1 & x2)) & 1;
+}
+
+// The words of a BitString. Up to INLINE_WORDS words (a PauliString of 64 qubits) are stored inline, so
+// that small strings are created and copied without touching the heap.
+class WordBuffer {
+  public:
+    static constexpr size_t INLINE_WORDS = 2;
+
+    using value_type = binary_word;
+    using iterator = binary_word*;
+    using const_iterator = const binary_word*;
+
+    WordBuffer() : count(0) {}
+
+    WordBuffer(size_t count, binary_word value=0) : count(count) {
+      if (count > INLINE_WORDS) {
+        heap = std::make_unique<binary_word[]>(count);
+      }
+      std::fill(begin(), end(), value);
+    }
+
+    WordBuffer(const WordBuffer& other) : WordBuffer(other.count) {
+      std::copy(other.begin(), other.end(), begin());
+    }
+
+    WordBuffer(WordBuffer&& other) noexcept : count(other.count), local(other.local), heap(std::move(other.heap)) {
+      other.count = 0;
+    }
+
+    WordBuffer& operator=(const WordBuffer& other) {
+      if (this != &other) {
+        if (count != other.count) {
+          *this = WordBuffer(other.count);
+        }
+        std::copy(other.begin(), other.end(), begin());
+      }
+      return *this;
+    }
+
+    WordBuffer& operator=(WordBuffer&& other) noexcept {
+      count = other.count;
+      local = other.local;
+      heap = std::move(other.heap);
+      other.count = 0;
+      return *this;
+    }
+
+    void resize(size_t new_count, binary_word value=0) {
+      WordBuffer resized(new_count, value);
+      std::copy(begin(), begin() + std::min(count, new_count), resized.begin());
+      *this = std::move(resized);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    binary_word* data() { return heap ? heap.get() : local.data(); }
+    const binary_word* data() const { return heap ? heap.get() : local.data(); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + count; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + count; }
+
+    binary_word& operator[](size_t i) { return data()[i]; }
+    const binary_word& operator[](size_t i) const { return data()[i]; }
+
+    binary_word& back() { return data()[count - 1]; }
+    const binary_word& back() const { return data()[count - 1]; }
+
+    bool operator==(const WordBuffer& other) const {
+      return count == other.count && std::equal(begin(), end(), other.begin());
+    }
+
+  private:
+    size_t count;
+    std::array<binary_word, INLINE_WORDS> local;
+    std::unique_ptr<binary_word[]> heap;
+};
+
 struct BitString {
   uint32_t num_bits;
-  std::vector<binary_word> bits;
+  WordBuffer bits;
 
   BitString()=default;
 
@@ -158,6 +253,86 @@ struct BitString {
   BitString superstring(const std::vector<uint32_t>& sites, size_t new_num_bits) const;
 };
 
+// Maps a Pauli onto +-X_0 (or +-Z_0 if to_z) by single-qubit gates and a tree of CXs, applying each gate to
+// every (object, qubits) pair in args as well. The tree is built by rescanning the x bits: after step one
+// every z bit is clear, so each cx(q1, q2) of a round clears x on q2 and the survivors pair up in the next
+// round, without keeping a list of indices.
+template <typename P, typename... Args>
+void reduce_pauli_inplace(P& pauli, bool to_z, Args... args) {
+  uint32_t num_qubits = pauli.num_qubits;
+
+  if (to_z) {
+    pauli.h(0);
+    (args.first->h(args.second[0]), ...);
+  }
+
+  // Step one
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    if (pauli.get_z(i)) {
+      if (pauli.get_x(i)) {
+        pauli.s(i);
+        (args.first->s(args.second[i]), ...);
+      } else {
+        pauli.h(i);
+        (args.first->h(args.second[i]), ...);
+      }
+    }
+  }
+
+  // Step two
+  uint32_t ql = num_qubits;
+  bool paired = true;
+  while (paired) {
+    paired = false;
+    ql = num_qubits;
+    uint32_t pending = num_qubits;
+    for (uint32_t i = 0; i < num_qubits; i++) {
+      if (!pauli.get_x(i)) {
+        continue;
+      }
+
+      if (ql == num_qubits) {
+        ql = i;
+      }
+
+      if (pending == num_qubits) {
+        pending = i;
+      } else {
+        pauli.cx(pending, i);
+        (args.first->cx(args.second[pending], args.second[i]), ...);
+        pending = num_qubits;
+        paired = true;
+      }
+    }
+  }
+
+  // Step three
+  if (ql != 0 && ql != num_qubits) {
+    pauli.cx(0, ql);
+    pauli.cx(ql, 0);
+    pauli.cx(0, ql);
+
+    (args.first->cx(args.second[0], args.second[ql]), ...);
+    (args.first->cx(args.second[ql], args.second[0]), ...);
+    (args.first->cx(args.second[0], args.second[ql]), ...);
+  }
+
+  if (to_z) {
+    pauli.h(0);
+    (args.first->h(args.second[0]), ...);
+
+    if (pauli.get_r() == 2) {
+      pauli.x(0);
+      (args.first->x(args.second[0]), ...);
+    }
+  } else {
+    if (pauli.get_r() == 2) {
+      pauli.z(0);
+      (args.first->z(args.second[0]), ...);
+    }
+  }
+}
+
 class PauliString {
   public:
     uint32_t num_qubits;
@@ -294,75 +469,7 @@ class PauliString {
 
     template <typename... Args>
     void reduce_inplace(bool to_z, Args... args) {
-      if (to_z) {
-        h(0);
-        (args.first->h(args.second[0]), ...);
-      }
-
-      // Step one
-      for (uint32_t i = 0; i < num_qubits; i++) {
-        if (get_z(i)) {
-          if (get_x(i)) {
-            s(i);
-            (args.first->s(args.second[i]), ...);
-          } else {
-            h(i);
-            (args.first->h(args.second[i]), ...);
-          }
-        }
-      }
-
-      // Step two
-      std::vector<uint32_t> nonzero_idx;
-      for (uint32_t i = 0; i < num_qubits; i++) {
-        if (get_x(i)) {
-          nonzero_idx.push_back(i);
-        }
-      }
-
-      while (nonzero_idx.size() > 1) {
-        for (uint32_t j = 0; j < nonzero_idx.size()/2; j++) {
-          uint32_t q1 = nonzero_idx[2*j];
-          uint32_t q2 = nonzero_idx[2*j+1];
-          cx(q1, q2);
-          (args.first->cx(args.second[q1], args.second[q2]), ...);
-        }
-
-        remove_even_indices(nonzero_idx);
-      }
-
-      // Step three
-      uint32_t ql = nonzero_idx[0];
-      if (ql != 0) {
-        for (uint32_t i = 0; i < num_qubits; i++) {
-          if (get_x(i)) {
-            cx(0, ql);
-            cx(ql, 0);
-            cx(0, ql);
-
-            (args.first->cx(args.second[0], args.second[ql]), ...);
-            (args.first->cx(args.second[ql], args.second[0]), ...);
-            (args.first->cx(args.second[0], args.second[ql]), ...);
-
-            break;
-          }
-        }
-      }
-
-      if (to_z) {
-        h(0);
-        (args.first->h(args.second[0]), ...);
-
-        if (phase == 2) {
-          x(0);
-          (args.first->x(args.second[0]), ...);
-        }
-      } else {
-        if (phase == 2) {
-          z(0);
-          (args.first->z(args.second[0]), ...);
-        }
-      }
+      reduce_pauli_inplace(*this, to_z, args...);
     }
 
     // Returns the circuit which maps this PauliString onto p
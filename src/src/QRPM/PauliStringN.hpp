@@ -0,0 +1,253 @@
+#pragma once
+
+#include "PauliString.hpp"
+
+// A PauliString of at most max_qubits = 32*Words qubits, with its words stored inline. Bits are laid out
+// exactly as in PauliString, so the two convert by copying words, and rand/randh draw the same strings from
+// the same sequence. Gates, products and commutation never allocate; this is meant for the inner loops of
+// random_clifford_impl and similar code which build and discard many small strings.
+template <size_t Words>
+class PauliStringN {
+  public:
+    static constexpr uint32_t max_qubits = Words * binary_word_size() / 2;
+
+    uint32_t num_qubits;
+    uint8_t phase;
+    std::array<binary_word, Words> words{};
+
+    PauliStringN() : num_qubits(0), phase(0) {}
+
+    PauliStringN(uint32_t num_qubits) : num_qubits(num_qubits), phase(0) {
+      if (num_qubits == 0) {
+        throw std::runtime_error("Cannot create a 0-qubit PauliString.");
+      }
+
+      if (num_qubits > max_qubits) {
+        throw std::runtime_error(std::format("Cannot create a {}-qubit PauliString with room for {} qubits.", num_qubits, max_qubits));
+      }
+    }
+
+    explicit PauliStringN(const PauliString& p) : PauliStringN(p.num_qubits) {
+      std::copy(p.bit_string.bits.begin(), p.bit_string.bits.end(), words.begin());
+      phase = p.get_r();
+    }
+
+    PauliString to_pauli_string() const {
+      PauliString p(num_qubits);
+      std::copy(words.begin(), words.begin() + p.bit_string.size(), p.bit_string.bits.begin());
+      p.set_r(phase);
+      return p;
+    }
+
+    static PauliStringN rand(uint32_t num_qubits) {
+      PauliStringN p(num_qubits);
+
+      size_t num_bits = 2*num_qubits;
+      size_t width = num_bits / binary_word_size() + static_cast<bool>(num_bits % binary_word_size());
+      Random::fill_bits(std::span<binary_word>(p.words.data(), width));
+      if (num_bits % binary_word_size()) {
+        p.words[width - 1] &= (static_cast<binary_word>(1) << (num_bits % binary_word_size())) - 1;
+      }
+
+      p.set_r(randi() % 4);
+
+      // Need to check that at least one bit is nonzero so that p is not the identity
+      if (std::any_of(p.words.begin(), p.words.end(), [](binary_word w) { return w != 0; })) {
+        return p;
+      }
+
+      return PauliStringN::rand(num_qubits);
+    }
+
+    static PauliStringN randh(uint32_t num_qubits) {
+      PauliStringN p = PauliStringN::rand(num_qubits);
+      p.set_r(randi(0, 2) * 2);
+
+      return p;
+    }
+
+    static PauliStringN basis(uint32_t num_qubits, const std::string& P, uint32_t q, uint8_t r) {
+      PauliStringN p(num_qubits);
+      if (P == "X") {
+        p.set_x(q, true);
+      } else if (P == "Y") {
+        p.set_x(q, true);
+        p.set_z(q, true);
+      } else if (P == "Z") {
+        p.set_z(q, true);
+      } else {
+        std::string error_message = P + " is not a valid basis. Must provide one of X,Y,Z.\n";
+        throw std::invalid_argument(error_message);
+      }
+
+      p.set_r(r);
+
+      return p;
+    }
+
+    std::string to_string_ops() const {
+      return to_pauli_string().to_string_ops();
+    }
+
+    inline uint8_t get_xz(uint32_t i) const {
+      constexpr uint32_t num_paulis = binary_word_size()/2;
+      return (words[i / num_paulis] >> (2u*(i % num_paulis))) & 3u;
+    }
+
+    inline void set_xz(uint32_t i, uint8_t xz) {
+      constexpr uint32_t num_paulis = binary_word_size()/2;
+      uint32_t bit_ind = 2u*(i % num_paulis);
+      binary_word& w = words[i / num_paulis];
+      w = (w & ~(static_cast<binary_word>(3) << bit_ind)) | (static_cast<binary_word>(xz) << bit_ind);
+    }
+
+    inline bool get_x(uint32_t i) const {
+      return get_xz(i) & 1u;
+    }
+
+    inline bool get_z(uint32_t i) const {
+      return (get_xz(i) >> 1u) & 1u;
+    }
+
+    inline void set_x(uint32_t i, bool v) {
+      set_xz(i, (get_xz(i) & 2u) | static_cast<uint8_t>(v));
+    }
+
+    inline void set_z(uint32_t i, bool v) {
+      set_xz(i, (get_xz(i) & 1u) | (static_cast<uint8_t>(v) << 1u));
+    }
+
+    inline uint8_t get_r() const {
+      return phase;
+    }
+
+    inline void set_r(uint8_t v) {
+      phase = v & 0b11;
+    }
+
+    bool hermitian() const {
+      return !(phase & 0b1);
+    }
+
+    static uint8_t get_multiplication_phase(const PauliStringN& p1, const PauliStringN& p2) {
+      uint8_t s = p1.get_r() + p2.get_r();
+      for (size_t k = 0; k < Words; k++) {
+        s += word_multiplication_phase(p1.words[k], p2.words[k]);
+      }
+
+      return s & 0b11;
+    }
+
+    PauliStringN operator*(const PauliStringN& other) const {
+      if (num_qubits != other.num_qubits) {
+        throw std::runtime_error(std::format("Multiplying PauliStrings with {} qubits and {} qubits do not match.", num_qubits, other.num_qubits));
+      }
+
+      PauliStringN p(*this);
+      p.set_r(get_multiplication_phase(*this, other));
+      for (size_t k = 0; k < Words; k++) {
+        p.words[k] ^= other.words[k];
+      }
+
+      return p;
+    }
+
+    bool operator==(const PauliStringN& rhs) const {
+      return num_qubits == rhs.num_qubits && phase == rhs.phase && words == rhs.words;
+    }
+
+    bool operator!=(const PauliStringN& rhs) const {
+      return !(*this == rhs);
+    }
+
+    bool commutes(const PauliStringN& p) const {
+      if (num_qubits != p.num_qubits) {
+        throw std::invalid_argument(std::format("p = {} has {} qubits and q = {} has {} qubits; cannot check commutation.", p.to_string_ops(), p.num_qubits, to_string_ops(), num_qubits));
+      }
+
+      bool anticommutes = false;
+      for (size_t k = 0; k < Words; k++) {
+        anticommutes ^= word_anticommutes(words[k], p.words[k]);
+      }
+
+      return !anticommutes;
+    }
+
+    // Gates act by conjugation, with the same phase tables as PauliString
+    void s(uint32_t a) {
+      uint8_t xza = get_xz(a);
+      constexpr uint8_t s_phase_lookup[] = {0, 0, 0, 2};
+      set_r(phase + s_phase_lookup[xza]);
+      set_xz(a, xza ^ ((xza & 1u) << 1u));
+    }
+
+    void sd(uint32_t a) {
+      s(a);
+      s(a);
+      s(a);
+    }
+
+    void h(uint32_t a) {
+      uint8_t xza = get_xz(a);
+      constexpr uint8_t h_phase_lookup[] = {0, 0, 0, 2};
+      set_r(phase + h_phase_lookup[xza]);
+      set_xz(a, ((xza & 1u) << 1u) | (xza >> 1u));
+    }
+
+    // Conjugation by a Pauli flips the sign wherever it anticommutes
+    void x(uint32_t a) {
+      set_r(phase + 2*get_z(a));
+    }
+
+    void y(uint32_t a) {
+      set_r(phase + 2*(get_x(a) != get_z(a)));
+    }
+
+    void z(uint32_t a) {
+      set_r(phase + 2*get_x(a));
+    }
+
+    void cx(uint32_t a, uint32_t b) {
+      uint8_t xza = get_xz(a);
+      uint8_t xzb = get_xz(b);
+
+      constexpr uint8_t cx_phase_lookup[] = {0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 2};
+      set_r(phase + cx_phase_lookup[xzb + (xza << 2)]);
+      set_xz(b, xzb ^ (xza & 1u));
+      set_xz(a, xza ^ (xzb & 2u));
+    }
+
+    void cz(uint32_t a, uint32_t b) {
+      h(b);
+      cx(a, b);
+      h(b);
+    }
+
+    void swap(uint32_t a, uint32_t b) {
+      uint8_t xza = get_xz(a);
+      set_xz(a, get_xz(b));
+      set_xz(b, xza);
+    }
+
+    template <typename... Args>
+    void reduce_inplace(bool to_z, Args... args) {
+      reduce_pauli_inplace(*this, to_z, args...);
+    }
+};
+
+// Inline strings for the common cases of up to 64 and 128 qubits
+using PauliString64 = PauliStringN<2>;
+using PauliString128 = PauliStringN<4>;
+
+template <size_t Words>
+struct std::formatter<PauliStringN<Words>> {
+  template <typename ParseContext>
+  constexpr auto parse(ParseContext& ctx) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const PauliStringN<Words>& ps, FormatContext& ctx) const {
+    return std::format_to(ctx.out(), "{}", ps.to_string_ops());
+  }
+};
@@ -1,10 +1,51 @@
 #include "QuantumCHPState.h"
 
-QuantumCHPState::QuantumCHPState(uint32_t num_qubits, bool use_simd) : CliffordState(num_qubits) {
-  if (use_simd) {
-    tableau = std::make_unique<TableauSIMD>(num_qubits);
+static TableauType default_tableau_type(uint32_t num_qubits, bool use_simd) {
+  if (!use_simd) {
+    return TableauType::Strings;
+  }
+
+  return num_qubits <= STATIC_TABLEAU_MAX_QUBITS ? TableauType::Static : TableauType::Dense;
+}
+
+QuantumCHPState::QuantumCHPState(uint32_t num_qubits, bool use_simd) : QuantumCHPState(num_qubits, default_tableau_type(num_qubits, use_simd)) {}
+
+QuantumCHPState::QuantumCHPState(uint32_t num_qubits, TableauType type) : CliffordState(num_qubits), tableau_type(type) {
+  if (type == TableauType::Strings) {
+    tableau = std::make_shared<Tableau>(num_qubits);
+  } else if (type == TableauType::Dense) {
+    tableau = std::make_shared<TableauSIMD>(num_qubits);
+  } else if (type == TableauType::Static) {
+    tableau = make_static_tableau(num_qubits);
   } else {
-    tableau = std::make_unique<Tableau>(num_qubits);
+    tableau = std::make_shared<TableauSparse>(num_qubits);
+  }
+}
+
+// Single-qubit gates leave the support of every row unchanged, so the storage is only reconsidered before 
+// entangling gates and measurements. The sparse fill is kept up to date by the tableau; the dense fill
+// takes a pass over the rows and is only checked every 2n operations.
+void QuantumCHPState::update_storage() {
+  if (tableau_type != TableauType::Adaptive) {
+    return;
+  }
+
+  if (auto sparse = dynamic_cast<TableauSparse*>(tableau.get())) {
+    if (sparse->fill() > SPARSE_MAX_FILL) {
+      tableau = std::make_shared<TableauSIMD>(sparse->to_dense());
+    }
+  } else if (++storage_checks >= 2*num_qubits) {
+    storage_checks = 0;
+    auto dense = static_cast<TableauSIMD*>(tableau.get());
+    if (TableauSparse::fill(*dense) < DENSE_MIN_FILL) {
+      tableau = std::make_shared<TableauSparse>(*dense);
+    }
+  }
+}
+
+void QuantumCHPState::detach() const {
+  if (tableau.use_count() > 1) {
+    tableau = tableau->clone();
   }
 }
 
@@ -21,10 +62,14 @@ std::string QuantumCHPState::to_string() const {
 }
 
 void QuantumCHPState::rref() {
+  detach();
+  gauge_valid = false;
   tableau->rref();
 }
 
 void QuantumCHPState::xrref() {
+  detach();
+  gauge_valid = false;
   tableau->xrref();
 }
 
@@ -42,36 +87,215 @@ void QuantumCHPState::set_print_mode(const std::string& mode) {
   }
 }
 
+void QuantumCHPState::set_track_entanglement(bool track) {
+  track_entanglement = track;
+  gauge_valid = false;
+  if (track_entanglement) {
+    detach();
+    fix_gauge();
+  }
+}
+
+uint32_t QuantumCHPState::left_endpoint(uint32_t r, uint32_t start) const {
+  for (uint32_t j = start; j < num_qubits; j++) {
+    if (tableau->get_pauli(r, j) != Pauli::I) {
+      return j;
+    }
+  }
+
+  throw std::runtime_error(std::format("Stabilizer {} is trivial on [{}, {}).", r, start, num_qubits));
+}
+
+// S([0, i+1)) = S([i+1, n)) = (n - i - 1) - #{stabilizers with left endpoint >= i+1}, so moving 
+// the left endpoint of a stabilizer from x to y only changes the cuts between x and y.
+void QuantumCHPState::move_endpoint(uint32_t r, uint32_t l) {
+  uint32_t l0 = left_endpoints[r];
+  for (uint32_t i = l0; i < l; i++) {
+    entanglement_profile[i]--;
+  }
+  for (uint32_t i = l; i < l0; i++) {
+    entanglement_profile[i]++;
+  }
+  left_endpoints[r] = l;
+}
+
+void QuantumCHPState::detach_endpoint(uint32_t r) {
+  auto& rows = endpoint_rows[left_endpoints[r]];
+  rows.erase(std::find(rows.begin(), rows.end(), r));
+}
+
+// Inserts a detached stabilizer r, which is trivial on [0, l), back into the gauge. While the Pauli 
+// of r at its left endpoint is dependent on those of the stabilizers already ending there, r is 
+// multiplied by them, pushing its left endpoint to the right.
+void QuantumCHPState::settle_stabilizer(uint32_t r, uint32_t l) {
+  while (true) {
+    const auto& rows = endpoint_rows[l];
+    uint8_t p = tableau->get_pauli(r, l);
+
+    std::vector<uint32_t> factors;
+    if (rows.size() == 1) {
+      if (tableau->get_pauli(rows[0], l) == p) {
+        factors = {rows[0]};
+      }
+    } else if (rows.size() == 2) {
+      uint8_t p1 = tableau->get_pauli(rows[0], l);
+      uint8_t p2 = tableau->get_pauli(rows[1], l);
+      if (p == p1) {
+        factors = {rows[0]};
+      } else if (p == p2) {
+        factors = {rows[1]};
+      } else {
+        factors = {rows[0], rows[1]};
+      }
+    }
+
+    if (factors.empty()) {
+      move_endpoint(r, l);
+      endpoint_rows[l].push_back(r);
+      return;
+    }
+
+    for (auto f : factors) {
+      tableau->stabilizer_rowsum(r, f);
+    }
+
+    l = left_endpoint(r, l + 1);
+  }
+}
+
+void QuantumCHPState::fix_gauge() {
+  left_endpoints = std::vector<uint32_t>(num_qubits);
+  endpoint_rows = std::vector<std::vector<uint32_t>>(num_qubits);
+  std::vector<bool> pivoted(num_qubits, false);
+
+  for (uint32_t x = 0; x < num_qubits; x++) {
+    // Pivot first on the x-bit and then on the z-bit of site x; afterwards all unpivoted stabilizers 
+    // are trivial on x, and those pivoted on x have independent Paulis there.
+    for (uint8_t bit : {0b01, 0b10}) {
+      std::optional<uint32_t> pivot;
+      for (uint32_t r = 0; r < num_qubits; r++) {
+        if (pivoted[r] || !(tableau->get_pauli(r, x) & bit)) {
+          continue;
+        }
+
+        if (pivot) {
+          tableau->stabilizer_rowsum(r, pivot.value());
+        } else {
+          pivot = r;
+        }
+      }
+
+      if (pivot) {
+        pivoted[pivot.value()] = true;
+        left_endpoints[pivot.value()] = x;
+        endpoint_rows[x].push_back(pivot.value());
+      }
+    }
+  }
+
+  entanglement_profile = std::vector<int>(num_qubits);
+  int num_right = 0;
+  for (uint32_t i = num_qubits; i > 0; i--) {
+    entanglement_profile[i - 1] = static_cast<int>(num_qubits - i) - num_right;
+    num_right += endpoint_rows[i - 1].size();
+  }
+
+  gauge_valid = true;
+}
+
+// Restores the gauge after a gate on qubits. Only stabilizers which ended on one of the qubits, or which 
+// gained support left of their previous endpoint, can have changed; all others are left untouched.
+void QuantumCHPState::update_gauge(const Qubits& qubits) {
+  if (!track_entanglement) {
+    return;
+  }
+
+  if (!gauge_valid) {
+    fix_gauge();
+    return;
+  }
+
+  uint32_t qmin = std::ranges::min(qubits);
+
+  std::vector<uint32_t> affected;
+  for (uint32_t r = 0; r < num_qubits; r++) {
+    uint32_t l = left_endpoints[r];
+    if (l < qmin) {
+      continue;
+    }
+
+    for (auto q : qubits) {
+      if (q == l || (q < l && tableau->get_pauli(r, q) != Pauli::I)) {
+        affected.push_back(r);
+        break;
+      }
+    }
+  }
+
+  for (auto r : affected) {
+    detach_endpoint(r);
+  }
+
+  for (auto r : affected) {
+    settle_stabilizer(r, left_endpoint(r, qmin));
+  }
+}
+
 void QuantumCHPState::h(uint32_t a) {
+  detach();
   tableau->h(a);
 }
 
 void QuantumCHPState::s(uint32_t a) {
+  detach();
   tableau->s(a);
 }
 
 void QuantumCHPState::sd(uint32_t a) {
+  detach();
   tableau->s(a);
   tableau->s(a);
   tableau->s(a);
 }
 
 void QuantumCHPState::cx(uint32_t a, uint32_t b) {
+  detach();
+  update_storage();
   tableau->cx(a, b);
+  update_gauge({a, b});
 }
 
 void QuantumCHPState::cy(uint32_t a, uint32_t b) {
+  detach();
+  update_storage();
   tableau->s(b);
   tableau->h(b);
   tableau->cz(a, b);
   tableau->h(b);
   tableau->sd(b);
+  update_gauge({a, b});
 }
 
 void QuantumCHPState::cz(uint32_t a, uint32_t b) {
+  detach();
+  update_storage();
   tableau->h(b);
   tableau->cx(a, b);
   tableau->h(b);
+  update_gauge({a, b});
+}
+
+// Without entanglement tracking, which re-gauges after every entangling gate, a run of compiled gates 
+// is handed to the tableau in a single call. The storage is reconsidered once per run.
+void QuantumCHPState::apply_gates(std::span<const CompiledOp> ops) {
+  if (track_entanglement) {
+    CliffordState::apply_gates(ops);
+    return;
+  }
+
+  detach();
+  update_storage();
+  tableau->execute(ops);
 }
 
 PauliString QuantumCHPState::get_stabilizer(size_t i) const {
@@ -87,16 +311,28 @@ PauliString QuantumCHPState::get_destabilizer(size_t i) const {
   return PauliString(paulis, phase);
 }
 
+std::complex<double> QuantumCHPState::expectation(const PauliString& pauli) const {
+  return tableau->expectation(pauli);
+}
+
+std::complex<double> QuantumCHPState::expectation(const SparsePauliObs& obs) const {
+  return tableau->expectation(obs);
+}
+
 double QuantumCHPState::expectation(const BitString& bits, std::optional<QubitSupport> support) const {
   if (support) {
-    // TODO add support for SIMD
-    //Tableau restricted = tableau->partial_trace(to_qubits(support_complement(support.value(), num_qubits)));
-    return tableau->bitstring_amplitude(bits);
+    Qubits qubits_complement = to_qubits(support_complement(support.value(), num_qubits));
+    return MixedTableau(num_qubits, stabilizers()).partial_trace(qubits_complement).probability(bits);
   } else {
-    return tableau->bitstring_amplitude(bits);
+    return StabilizerSampler(*tableau).probability(bits);
   }
 }
 
+std::shared_ptr<QuantumState> QuantumCHPState::partial_trace(const Qubits& qubits) const {
+  validate_qubits(qubits);
+  return std::make_shared<MixedCliffordState>(MixedTableau(num_qubits, stabilizers()).partial_trace(qubits));
+}
+
 std::vector<double> QuantumCHPState::probabilities() const {
   if (num_qubits > 15) {
     throw std::runtime_error(std::format("Cannot evaluate the probabilities() of a {} > 15 qubit state.", num_qubits));
@@ -105,14 +341,45 @@ std::vector<double> QuantumCHPState::probabilities() const {
   size_t b = 1u << num_qubits;
   std::vector<double> probs(b);
 
+  StabilizerSampler sampler(*tableau);
   for (size_t z = 0; z < b; z++) {
     BitString bits = BitString::from_bits(num_qubits, z);
-    probs[z] = expectation(bits);
+    probs[z] = sampler.probability(bits);
   }
 
   return probs;
 }
 
+std::vector<std::vector<double>> QuantumCHPState::mutual_information(const std::vector<QubitSupport>& regions, uint32_t num_threads) const {
+  std::vector<Qubits> qubits;
+  for (const auto& region : regions) {
+    qubits.push_back(to_qubits(region));
+  }
+
+  return RegionEntropies(*tableau, qubits).mutual_information(num_threads);
+}
+
+double QuantumCHPState::tripartite_information(const QubitSupport& A, const QubitSupport& B, const QubitSupport& C) const {
+  return RegionEntropies(*tableau, {to_qubits(A), to_qubits(B), to_qubits(C)}).tripartite_information(0, 1, 2);
+}
+
+std::vector<BitAmplitudes> QuantumCHPState::sample_bitstrings(const std::vector<QubitSupport>& supports, size_t num_samples) const {
+  StabilizerSampler sampler(*tableau);
+
+  std::vector<double> amplitudes = {sampler.probability()};
+  for (const auto& support : supports) {
+    amplitudes.push_back(std::pow(2.0, -static_cast<double>(tableau->xrank(to_qubits(support)))));
+  }
+
+  std::vector<BitAmplitudes> samples;
+  samples.reserve(num_samples);
+  for (auto& bits : sampler.sample(num_samples)) {
+    samples.push_back({std::move(bits), amplitudes});
+  }
+
+  return samples;
+}
+
 std::vector<PauliString> QuantumCHPState::stabilizers() const {
   std::vector<PauliString> stabilizers(num_qubits);
   for (size_t i = 0; i < num_qubits; i++) {
@@ -121,8 +388,46 @@ std::vector<PauliString> QuantumCHPState::stabilizers() const {
   return stabilizers;
 }
 
+// One- and two-qubit Cliffords are drawn from the precomputed groups and applied in a single pass
 void QuantumCHPState::random_clifford(const Qubits& qubits) {
-  random_clifford_impl(qubits, *this);
+  detach();
+  update_storage();
+  if (qubits.size() == 1 || qubits.size() == 2) {
+    tableau->apply_clifford(CliffordOp::random_clifford(qubits));
+  } else {
+    random_clifford_impl(qubits, *tableau);
+  }
+
+  if (qubits.size() > 1) {
+    update_gauge(qubits);
+  }
+}
+
+// The whole layer of one- and two-qubit Cliffords is applied to the tableau in a single pass
+void QuantumCHPState::random_clifford_layer(const std::vector<Qubits>& supports) {
+  detach();
+  update_storage();
+  std::vector<CliffordOp> ops;
+  ops.reserve(supports.size());
+
+  Qubits layer_qubits;
+  for (const Qubits& qubits : supports) {
+    if (qubits.size() > 2) {
+      CliffordState::random_clifford_layer(supports);
+      return;
+    }
+
+    ops.push_back(CliffordOp::random_clifford(qubits));
+
+    if (qubits.size() > 1) {
+      layer_qubits.insert(layer_qubits.end(), qubits.begin(), qubits.end());
+    }
+  }
+
+  tableau->apply_layer(ops);
+  if (!layer_qubits.empty()) {
+    update_gauge(layer_qubits);
+  }
 }
 
 double QuantumCHPState::mzr_expectation(uint32_t a) const {
@@ -145,14 +450,74 @@ double QuantumCHPState::mzr_expectation(uint32_t a) const {
 }
 
 MeasurementData QuantumCHPState::mzr(uint32_t a, std::optional<bool> outcome) {
-  return tableau->mzr(a, outcome);
+  detach();
+  update_storage();
+  if (!track_entanglement) {
+    return tableau->mzr(a, outcome);
+  }
+
+  if (!gauge_valid) {
+    fix_gauge();
+  }
+
+  // The tableau pivots on the first anticommuting stabilizer. Moving the one with the rightmost 
+  // left endpoint there ensures that every other anticommuting stabilizer keeps its left endpoint.
+  std::optional<uint32_t> first;
+  std::optional<uint32_t> pivot;
+  for (uint32_t r = 0; r < num_qubits; r++) {
+    if (tableau->get_pauli(r, a) & 0b01) {
+      if (!first) {
+        first = r;
+      }
+
+      if (!pivot || left_endpoints[r] > left_endpoints[pivot.value()]) {
+        pivot = r;
+      }
+    }
+  }
+
+  if (!first) {
+    return tableau->mzr(a, outcome);
+  }
+
+  uint32_t p = first.value();
+  if (pivot.value() != p) {
+    uint32_t q = pivot.value();
+    tableau->stabilizer_swap(p, q);
+    detach_endpoint(p);
+    detach_endpoint(q);
+    std::swap(left_endpoints[p], left_endpoints[q]);
+    endpoint_rows[left_endpoints[p]].push_back(p);
+    endpoint_rows[left_endpoints[q]].push_back(q);
+  }
+
+  auto result = tableau->mzr(a, outcome);
+
+  // Stabilizer p is now Z_a
+  detach_endpoint(p);
+  settle_stabilizer(p, a);
+
+  return result;
 }
 
 double QuantumCHPState::sparsity() const {
   return tableau->sparsity();
 }
 
-double QuantumCHPState::entanglement(const QubitSupport& support, uint32_t index) {
+double QuantumCHPState::entanglement(const QubitSupport& support, uint32_t index) const {
+  if (track_entanglement && gauge_valid && std::holds_alternative<QubitInterval>(support)) {
+    const QubitInterval& interval = std::get<QubitInterval>(support);
+    if (!interval) {
+      return 0.0;
+    }
+
+    auto [q1, q2] = interval.value();
+    if (q1 == 0 || q2 == num_qubits) {
+      uint32_t i = (q1 == 0) ? q2 : q1;
+      return (i == 0) ? 0.0 : static_cast<double>(entanglement_profile[i - 1]);
+    }
+  }
+
   auto qubits = to_qubits(support);
   uint32_t system_size = this->num_qubits;
   uint32_t partition_size = qubits.size();
@@ -177,6 +542,19 @@ double QuantumCHPState::entanglement(const QubitSupport& support, uint32_t index
   return static_cast<double>(s);
 }
 
+std::vector<double> QuantumCHPState::cum_entanglement_profile(const std::vector<uint32_t>& cuts, uint32_t index, bool direction) const {
+  std::vector<uint32_t> counts(num_qubits);
+  if (track_entanglement && gauge_valid) {
+    for (uint32_t i = 0; i < num_qubits; i++) {
+      counts[i] = endpoint_rows[i].size();
+    }
+  } else {
+    counts = tableau->endpoint_counts();
+  }
+
+  return endpoint_entanglement(counts, cuts, direction);
+}
+
 int QuantumCHPState::xrank() const {
   Qubits qubits(num_qubits);
   std::iota(qubits.begin(), qubits.end(), 0);
@@ -196,3 +574,85 @@ int QuantumCHPState::rank() const {
 int QuantumCHPState::partial_rank(const Qubits& qubits) const {
   return tableau->rank(qubits);
 }
+
+std::vector<char> QuantumCHPState::serialize() const {
+  SnapshotKind kind;
+  if (tableau_type == TableauType::Static) {
+    kind = SnapshotKind::StaticTableau;
+  } else if (dynamic_cast<const TableauSIMD*>(tableau.get())) {
+    kind = SnapshotKind::TableauSIMD;
+  } else if (dynamic_cast<const TableauSparse*>(tableau.get())) {
+    kind = SnapshotKind::TableauSparse;
+  } else {
+    kind = SnapshotKind::Tableau;
+  }
+
+  SnapshotWriter writer;
+  writer.write_header(kind, num_qubits, Random::get_state());
+  writer.write(tableau_type);
+  writer.write(print_mode);
+  writer.write(track_entanglement);
+  writer.write(gauge_valid);
+  if (track_entanglement && gauge_valid) {
+    writer.write_array(left_endpoints);
+    writer.write_array(entanglement_profile);
+    for (const auto& rows : endpoint_rows) {
+      writer.write_array(rows);
+    }
+  }
+  tableau->write_snapshot(writer);
+  return std::move(writer.bytes);
+}
+
+// The entanglement gauge is stored along with the tableau, so that a restored state continues exactly as the original
+void QuantumCHPState::deserialize(const std::vector<char>& bytes) {
+  SnapshotReader reader(bytes);
+  SnapshotHeader header = reader.read_header();
+
+  TableauType storage;
+  if (header.kind == SnapshotKind::TableauSIMD) {
+    storage = TableauType::Dense;
+  } else if (header.kind == SnapshotKind::TableauSparse) {
+    storage = TableauType::Sparse;
+  } else if (header.kind == SnapshotKind::Tableau) {
+    storage = TableauType::Strings;
+  } else if (header.kind == SnapshotKind::StaticTableau) {
+    storage = TableauType::Static;
+  } else {
+    throw std::runtime_error(std::format("Cannot restore a QuantumCHPState from a snapshot of kind {}.", static_cast<uint32_t>(header.kind)));
+  }
+
+  QuantumCHPState state(header.num_qubits, storage);
+  state.tableau_type = reader.read<TableauType>();
+  state.print_mode = reader.read<int>();
+  state.track_entanglement = reader.read<bool>();
+  state.gauge_valid = reader.read<bool>();
+  if (state.track_entanglement && state.gauge_valid) {
+    reader.read_array(state.left_endpoints);
+    reader.read_array(state.entanglement_profile);
+    if (state.left_endpoints.size() != state.num_qubits || state.entanglement_profile.size() != state.num_qubits) {
+      throw std::runtime_error(std::format("Snapshot entanglement gauge does not match a {} qubit state.", state.num_qubits));
+    }
+    state.endpoint_rows = std::vector<std::vector<uint32_t>>(state.num_qubits);
+    for (auto& rows : state.endpoint_rows) {
+      reader.read_array(rows);
+    }
+
+    // Endpoints are sites and endpoint rows index stabilizers; both are later used without bounds checks
+    auto in_range = [n = state.num_qubits](uint32_t k) { return k < n; };
+    bool valid = std::ranges::all_of(state.left_endpoints, in_range);
+    for (const auto& rows : state.endpoint_rows) {
+      valid = valid && std::ranges::all_of(rows, in_range);
+    }
+    if (!valid) {
+      throw std::runtime_error(std::format("Snapshot entanglement gauge does not match a {} qubit state.", state.num_qubits));
+    }
+  }
+  state.tableau->read_snapshot(reader);
+
+  *this = std::move(state);
+}
+
+std::shared_ptr<CliffordState> QuantumCHPState::fork() const {
+  return std::make_shared<QuantumCHPState>(*this);
+}
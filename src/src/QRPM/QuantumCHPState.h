@@ -4,24 +4,64 @@
 #include "Tableau.h"
 #include "Clifford.hpp"
 #include "TableauSIMD.h"
+#include "TableauSparse.h"
+#include "StaticTableau.h"
+#include "MixedCliffordState.h"
+
+// Strings: Tableau of PauliStrings. Dense: TableauSIMD. Sparse: TableauSparse, for area-law states.
+// Adaptive: starts sparse, moves to dense storage once the rows fill in and back if they thin out again.
+// Static: StaticTableau, with fixed-size inline storage for up to STATIC_TABLEAU_MAX_QUBITS qubits.
+enum class TableauType { Strings, Dense, Sparse, Adaptive, Static };
 
 class QuantumCHPState : public CliffordState {
   private:
-#ifdef __AVX__
-    static constexpr bool avx_enabled = true;
-#else
-    static constexpr bool avx_enabled = false;
-#endif
+    // When tracking is enabled, the stabilizers are kept in left-canonical gauge: every site is the
+    // left endpoint of at most two stabilizers, whose Paulis on that site are independent. The stabilizers
+    // supported on [x, n) are then exactly those with left endpoint >= x, so the cumulative entanglement
+    // across every cut is read off from the endpoint distribution. Gates and measurements only re-gauge 
+    // the few stabilizers they touch. Operations which rref the tableau invalidate the gauge; until it is 
+    // rebuilt from scratch by the next gate or measurement, entanglement falls back to rank computations.
+    bool track_entanglement = false;
+    mutable bool gauge_valid = false;
+    std::vector<uint32_t> left_endpoints;
+    std::vector<std::vector<uint32_t>> endpoint_rows;
+    std::vector<int> entanglement_profile;
+
+    uint32_t left_endpoint(uint32_t r, uint32_t start) const;
+    void move_endpoint(uint32_t r, uint32_t l);
+    void detach_endpoint(uint32_t r);
+    void settle_stabilizer(uint32_t r, uint32_t l);
+    void fix_gauge();
+    void update_gauge(const Qubits& qubits);
+
+    // Word fill above which sparse rows are converted to dense, and below which dense rows are converted back
+    static constexpr double SPARSE_MAX_FILL = 0.25;
+    static constexpr double DENSE_MIN_FILL = 0.0625;
+
+    TableauType tableau_type = TableauType::Dense;
+    uint32_t storage_checks = 0;
+    void update_storage();
+
+    // Forks share the tableau until one of them modifies it; every operation which writes to the tableau
+    // first takes a private copy if it is still shared.
+    void detach() const;
+
+  protected:
+    virtual void apply_gates(std::span<const CompiledOp> ops) override;
 
   public:
     using CliffordState::expectation;
+    using CliffordState::partial_trace;
 
-    mutable std::unique_ptr<TableauBase> tableau;
+    mutable std::shared_ptr<TableauBase> tableau;
     int print_mode;
 
     QuantumCHPState()=default;
 
-    QuantumCHPState(uint32_t num_qubits, bool use_simd=avx_enabled);
+    // TableauSIMD selects its kernels at runtime and falls back to scalar code, so it is always usable. 
+    // Systems of up to STATIC_TABLEAU_MAX_QUBITS qubits use a StaticTableau instead, which is faster at that size.
+    QuantumCHPState(uint32_t num_qubits, bool use_simd=true);
+    QuantumCHPState(uint32_t num_qubits, TableauType type);
 
     bool operator==(const QuantumCHPState& other) const {
       return (*tableau == *other.tableau);
@@ -38,6 +78,10 @@ class QuantumCHPState : public CliffordState {
 
     void set_print_mode(const std::string& mode);
 
+    // Keep the cumulative entanglement profile up to date after every gate and measurement, 
+    // so that entanglement queries on intervals [0, i) and [i, n) are O(1).
+    void set_track_entanglement(bool track);
+
     virtual void h(uint32_t a) override;
     virtual void s(uint32_t a) override;
     virtual void sd(uint32_t a) override;
@@ -51,10 +95,26 @@ class QuantumCHPState : public CliffordState {
 
     std::vector<PauliString> stabilizers() const;
 
+    // Read directly from the tableau in O(n^2/64), without modifying the state; see TableauBase::expectation
+    virtual std::complex<double> expectation(const PauliString& pauli) const override;
+    virtual std::complex<double> expectation(const SparsePauliObs& obs) const override;
     virtual double expectation(const BitString& bits, std::optional<QubitSupport> support=std::nullopt) const override;
 		virtual std::vector<double> probabilities() const override;
 
+    // The reduced state on the complement of qubits, as a MixedCliffordState
+    virtual std::shared_ptr<QuantumState> partial_trace(const Qubits& qubits) const override;
+
+    // I(A_i : A_j) between every pair of regions, and I(A : B : C), through a single RegionEntropies rather 
+    // than a separate elimination for every union of regions
+    std::vector<std::vector<double>> mutual_information(const std::vector<QubitSupport>& regions, uint32_t num_threads=0) const;
+    double tripartite_information(const QubitSupport& A, const QubitSupport& B, const QubitSupport& C) const;
+
+    // Samples are drawn from the support of the state (see StabilizerSampler) rather than from the 2^n 
+    // probabilities. The marginal probability on a region A is the same, 2^-xrank(A), for every sample.
+    virtual std::vector<BitAmplitudes> sample_bitstrings(const std::vector<QubitSupport>& supports, size_t num_samples) const override;
+
     virtual void random_clifford(const Qubits& qubits) override;
+    virtual void random_clifford_layer(const std::vector<Qubits>& supports) override;
 
     virtual double mzr_expectation(uint32_t a) const override;
 
@@ -62,7 +122,11 @@ class QuantumCHPState : public CliffordState {
 
     virtual double sparsity() const override;
 
-    virtual double entanglement(const QubitSupport& support, uint32_t index) override;
+    virtual double entanglement(const QubitSupport& support, uint32_t index) const override;
+
+    // Clifford states have flat entanglement spectra, so every cut follows from the endpoint distribution 
+    // of the stabilizers: the tracked gauge if available, otherwise a single elimination of the tableau.
+    virtual std::vector<double> cum_entanglement_profile(const std::vector<uint32_t>& cuts, uint32_t index=2u, bool direction=true) const override;
 
     int xrank() const;
     int partial_xrank(const Qubits& qubits) const;
@@ -70,6 +134,10 @@ class QuantumCHPState : public CliffordState {
     int rank() const;
     int partial_rank(const Qubits& qubits) const;
 
+    virtual std::vector<char> serialize() const override;
+    virtual void deserialize(const std::vector<char>& bytes) override;
+    virtual std::shared_ptr<CliffordState> fork() const override;
+
     void set_x(size_t i, size_t j, bool v);
     void set_z(size_t i, size_t j, bool v);
 };
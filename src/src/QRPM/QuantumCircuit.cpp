@@ -174,9 +174,14 @@ QuantumCircuit QuantumCircuit::to_circuit(const CircuitDAG& dag, uint32_t num_qu
 
   size_t i = 0;
   int pos = ltr ? 0 : num_qubits;
-  std::set<size_t> visited;
   size_t n = 0;
 
+  // Number of unvisited predecessors of each node; a node becomes a leaf when this reaches zero
+  std::vector<uint32_t> remaining(dag.num_vertices);
+  for (size_t j = 0; j < dag.num_vertices; j++) {
+    remaining[j] = reversed_dag.degree(j);
+  }
+
   while (!leafs.empty()) {
     auto it = leafs.begin();
     if (n == 0) {
@@ -204,7 +209,6 @@ QuantumCircuit QuantumCircuit::to_circuit(const CircuitDAG& dag, uint32_t num_qu
 
     std::tie(i, pos) = *it;
 
-    visited.insert(i);
     circuit.add_instruction(dag.get_val(i));
 
     if (reversed_measurement_map.contains(i)) {
@@ -217,27 +221,20 @@ QuantumCircuit QuantumCircuit::to_circuit(const CircuitDAG& dag, uint32_t num_qu
       new_parameter_map[arg] = n;
     }
 
-    std::set<size_t> new_leafs;
+    leafs.erase(it);
+
     for (size_t j : dag.edges_of(i)) {
-      bool include = true;
-      for (size_t k : reversed_dag.edges_of(j)) {
-        if (!visited.contains(k)) {
-          include = false;
-          break;
-        }
+      if (--remaining[j] > 0) {
+        continue;
       }
 
-      if (include) {
-        new_leafs.insert(j);
-      }
-    }
-
-    leafs.erase(it);
-
-    for (size_t j : new_leafs) {
       const Instruction& inst = dag.get_val(j);
-      uint32_t q = ltr ? std::ranges::min(get_instruction_support(inst)) : std::ranges::max(get_instruction_support(inst));
-      leafs.emplace(j, q);
+      if (!instruction_is_quantum(inst)) {
+        leafs.emplace(j, ltr ? 0 : num_qubits);
+      } else {
+        uint32_t q = ltr ? std::ranges::min(get_instruction_support(inst)) : std::ranges::max(get_instruction_support(inst));
+        leafs.emplace(j, q);
+      }
     }
 
     n++;
@@ -249,108 +246,289 @@ QuantumCircuit QuantumCircuit::to_circuit(const CircuitDAG& dag, uint32_t num_qu
 }
 
 
-std::optional<std::pair<size_t, size_t>> find_mergeable(const CircuitDAG& dag, const auto& reversed_dag) {
-  auto mergeable = [](const Instruction& inst) {
-    return instruction_is_unitary(inst) && !instruction_is_classical(inst);
+// Merges neighbouring unitary instructions with nested supports, where one of the pair has no other edge
+// between them, until no such pair remains. Merged nodes are tombstoned rather than removed from the DAG, 
+// so no indices are shifted, and after each merge only the merged node and its predecessors are revisited.
+// Since every node has at most one edge per qubit of its support, this is linear in the number of instructions.
+QuantumCircuit QuantumCircuit::simplify(bool ltr) const {
+  CircuitDAG dag = to_dag();
+  size_t num_nodes = dag.num_vertices;
+
+  std::vector<std::vector<size_t>> successors(num_nodes);
+  std::vector<std::vector<size_t>> predecessors(num_nodes);
+  std::vector<Qubits> supports(num_nodes);
+  std::vector<bool> mergeable(num_nodes);
+  for (size_t i = 0; i < num_nodes; i++) {
+    for (size_t j : dag.edges_of(i)) {
+      successors[i].push_back(j);
+      predecessors[j].push_back(i);
+    }
+
+    const Instruction& inst = dag.get_val(i);
+    mergeable[i] = instruction_is_unitary(inst) && !instruction_is_classical(inst);
+    if (mergeable[i]) {
+      supports[i] = get_instruction_support(inst);
+      std::sort(supports[i].begin(), supports[i].end());
+    }
+  }
+
+  // merged_into[j] is the node which absorbed j, or j itself while it is alive
+  std::vector<size_t> merged_into(num_nodes);
+  std::iota(merged_into.begin(), merged_into.end(), 0);
+
+  auto replace_edge = [](std::vector<size_t>& edges, size_t from, size_t to) {
+    std::erase(edges, from);
+    if (std::ranges::find(edges, to) == edges.end()) {
+      edges.push_back(to);
+    }
   };
 
-  for (size_t i = 0; i < dag.num_vertices; i++) {
-    const Instruction& inst1 = dag.get_val(i);
-    if (!mergeable(inst1)) {
-      continue;
+  // Scratch map from the qubits of a merged pair to their positions in its (sorted) support
+  Qubits map(num_qubits);
+
+  auto merge = [&](size_t i, size_t j) {
+    QuantumCircuit qc(num_qubits, num_cbits);
+    qc.add_instruction(dag.get_val(i));
+    qc.add_instruction(dag.get_val(j));
+
+    Qubits support = supports[i].size() >= supports[j].size() ? supports[i] : supports[j];
+    for (size_t k = 0; k < support.size(); k++) {
+      map[support[k]] = k;
     }
-    for (size_t j : dag.edges_of(i)) {
-      const Instruction& inst2 = dag.get_val(j);
-      if (!mergeable(inst2)) {
+    qc.apply_qubit_map(map);
+    qc.resize_qubits(support.size());
+
+    dag.set_val(i, std::make_shared<MatrixGate>(qc.to_matrix(), support));
+    supports[i] = support;
+
+    std::erase(successors[i], j);
+    for (size_t k : successors[j]) {
+      replace_edge(predecessors[k], j, i);
+      if (std::ranges::find(successors[i], k) == successors[i].end()) {
+        successors[i].push_back(k);
+      }
+    }
+
+    for (size_t k : predecessors[j]) {
+      if (k == i) {
         continue;
       }
 
-      Qubits s1 = get_instruction_support(inst1);
-      Qubits s2 = get_instruction_support(inst2);
-      std::sort(s1.begin(), s1.end());
-      std::sort(s2.begin(), s2.end());
+      replace_edge(successors[k], j, i);
+      if (std::ranges::find(predecessors[i], k) == predecessors[i].end()) {
+        predecessors[i].push_back(k);
+      }
+    }
+
+    successors[j].clear();
+    predecessors[j].clear();
+    merged_into[j] = i;
+  };
+
+  std::vector<size_t> worklist(num_nodes);
+  std::iota(worklist.rbegin(), worklist.rend(), 0);
+  std::vector<bool> queued(num_nodes, true);
 
+  auto enqueue = [&](size_t i) {
+    if (!queued[i]) {
+      queued[i] = true;
+      worklist.push_back(i);
+    }
+  };
+
+  while (!worklist.empty()) {
+    size_t i = worklist.back();
+    worklist.pop_back();
+    queued[i] = false;
+
+    if (merged_into[i] != i || !mergeable[i]) {
+      continue;
+    }
+
+    for (size_t j : successors[i]) {
+      if (!mergeable[j]) {
+        continue;
+      }
+
+      const Qubits& s1 = supports[i];
+      const Qubits& s2 = supports[j];
       bool is_subset = std::includes(s1.begin(), s1.end(), s2.begin(), s2.end()) || std::includes(s2.begin(), s2.end(), s1.begin(), s1.end());
 
-      if (reversed_dag.degree(j) == 1 && is_subset) {
-        return std::make_pair(i, j);
-      } else if (dag.degree(i) == 1 && is_subset) {
-        return std::make_pair(i, j);
+      if (is_subset && (predecessors[j].size() == 1 || successors[i].size() == 1)) {
+        merge(i, j);
+
+        enqueue(i);
+        for (size_t k : predecessors[i]) {
+          enqueue(k);
+        }
+        break;
       }
     }
   }
 
-  return std::nullopt;
-}
+  auto representative = [&merged_into](size_t i) {
+    while (merged_into[i] != i) {
+      i = merged_into[i];
+    }
+    return i;
+  };
 
-QuantumCircuit QuantumCircuit::simplify(bool ltr) const {
-  CircuitDAG dag = to_dag();
-  auto reversed_dag = make_reversed_dag(dag);
+  std::vector<size_t> new_index(num_nodes);
+  size_t num_remaining = 0;
+  for (size_t i = 0; i < num_nodes; i++) {
+    if (merged_into[i] == i) {
+      new_index[i] = num_remaining++;
+    }
+  }
 
-  bool merged_any = true;
+  CircuitDAG simplified(num_remaining);
+  for (size_t i = 0; i < num_nodes; i++) {
+    if (merged_into[i] != i) {
+      continue;
+    }
+
+    simplified.set_val(new_index[i], std::move(dag.vals[i]));
+    for (size_t j : successors[i]) {
+      simplified.add_edge(new_index[i], new_index[j]);
+    }
+  }
 
   std::vector<size_t> measurement_map = this->measurement_map;
+  for (size_t& m : measurement_map) {
+    m = new_index[representative(m)];
+  }
+
   std::vector<size_t> parameter_map = this->parameter_map;
+  for (size_t& p : parameter_map) {
+    p = new_index[representative(p)];
+  }
 
-  while (merged_any) {
-    merged_any = false;
+  return to_circuit(simplified, num_qubits, num_cbits, measurement_map, parameter_map, ltr);
+}
 
-    auto merged_pair = find_mergeable(dag, reversed_dag);
-    if (!merged_pair) {
-      break;
-    }
+CompiledOp compile_gate(const Gate& gate) {
+  static const std::vector<std::pair<const char*, OpCode>> opcodes = {
+    {"H", OpCode::H}, {"S", OpCode::S}, {"Sd", OpCode::Sd}, {"X", OpCode::X}, {"Y", OpCode::Y}, {"Z", OpCode::Z},
+    {"sqrtX", OpCode::SqrtX}, {"sqrtY", OpCode::SqrtY}, {"sqrtXd", OpCode::SqrtXd}, {"sqrtYd", OpCode::SqrtYd},
+    {"CX", OpCode::CX}, {"CY", OpCode::CY}, {"CZ", OpCode::CZ}, {"SWAP", OpCode::SWAP}
+  };
 
-    merged_any = true;
-    auto [i, j] = merged_pair.value();
-    const Instruction& inst1 = dag.get_val(i);
-    const Instruction& inst2 = dag.get_val(j);
+  if (dynamic_cast<const SymbolicGate*>(&gate) == nullptr || !gate.is_clifford()) {
+    throw std::runtime_error(std::format("Cannot compile non-Clifford gate \"{}\".", gate.label()));
+  }
 
-    QuantumCircuit qc(num_qubits, num_cbits);
-    qc.add_instruction(inst1);
-    qc.add_instruction(inst2);
+  std::string name = gate.label();
+  auto it = std::ranges::find_if(opcodes, [&name](const auto& entry) { return name == entry.first; });
+  if (it == opcodes.end()) {
+    throw std::runtime_error(std::format("Cannot compile gate \"{}\".", name));
+  }
 
-    Qubits support = qc.get_support();
-    Qubits map = reduced_support(support, num_qubits);
-    qc.apply_qubit_map(map);
-    qc.resize_qubits(support.size());
+  CompiledOp op{};
+  op.code = it->second;
+  op.outcome = 2;
+  op.control = CompiledOp::NONE;
+  op.target = CompiledOp::NONE;
+  op.slot = CompiledOp::NONE;
+  for (size_t k = 0; k < gate.num_qubits; k++) {
+    op.args[k] = gate.qubits[k];
+  }
 
-    QuantumInstruction combined = std::make_shared<MatrixGate>(qc.to_matrix(), support);
+  return op;
+}
 
-    dag.set_val(i, combined);
+CompiledCircuit QuantumCircuit::compile() const {
+  Qubits qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return compile(qubits, num_qubits);
+}
 
-    std::vector<size_t> edges(dag.edges_of(j).begin(), dag.edges_of(j).end());
-    std::vector<size_t> reversed_edges(reversed_dag.edges_of(j).begin(), reversed_dag.edges_of(j).end());
+CompiledCircuit QuantumCircuit::compile(const Qubits& qubits, uint32_t register_size) const {
+  if (qubits.size() != num_qubits) {
+    throw std::runtime_error("Provided qubits do not match size of circuit.");
+  }
 
-    for (size_t k : edges) {
-      dag.add_edge(i, k);
-      reversed_dag.add_edge(k, i);
-    }
-    for (size_t k : reversed_edges) {
-      if (k == i) {
-        continue;
-      }
+  if (get_num_parameters() > 0) {
+    throw std::invalid_argument("Unbound QuantumCircuit parameters; cannot compile.");
+  }
 
-      dag.add_edge(k, i);
-      reversed_dag.add_edge(i, k);
-    }
+  CompiledCircuit program;
+  program.num_qubits = register_size;
+  program.num_cbits = num_cbits;
+  program.num_measurements = measurement_map.size();
+  program.ops.reserve(length());
+
+  std::map<size_t, size_t> reversed_map = reverse_map(measurement_map);
 
-    for (size_t p = 0; p < measurement_map.size(); p++) {
-      if (measurement_map[p] > j) {
-        measurement_map[p]--;
+  auto compile_qinst = [&](const QuantumInstruction& qinst, size_t i, CompiledOp& op) {
+    std::visit(quantumcircuit_utils::overloaded {
+      [&](const std::shared_ptr<Gate>& gate) {
+        CompiledOp gate_op = compile_gate(*gate);
+        op.code = gate_op.code;
+        for (size_t k = 0; k < gate->num_qubits; k++) {
+          op.args[k] = qubits[gate_op.args[k]];
+        }
+      },
+      [](const FreeFermionGate& gate) {
+        throw std::runtime_error("Cannot compile FreeFermionGate for Clifford states.");
+      },
+      [&](const Measurement& m) {
+        op.slot = reversed_map.at(i);
+        if (m.is_basis()) {
+          op.code = OpCode::Mzr;
+          op.args[0] = qubits[m.qubits[0]];
+          op.outcome = m.outcome ? m.outcome.value() : 2;
+        } else {
+          Measurement mapped = m;
+          for (size_t k = 0; k < m.qubits.size(); k++) {
+            mapped.qubits[k] = qubits[m.qubits[k]];
+          }
+
+          op.code = OpCode::Measure;
+          op.args[0] = program.measurements.size();
+          program.measurements.push_back(mapped);
+        }
+      },
+      [](const WeakMeasurement& m) {
+        throw std::runtime_error("Cannot compile weak measurements for Clifford states.");
       }
-    }
+    }, qinst);
+  };
 
-    for (size_t p = 0; p < parameter_map.size(); p++) {
-      if (parameter_map[p] > j) {
-        parameter_map[p]--;
+  for (size_t i = 0; i < length(); i++) {
+    CompiledOp op{};
+    op.outcome = 2;
+    op.control = CompiledOp::NONE;
+    op.target = CompiledOp::NONE;
+    op.slot = CompiledOp::NONE;
+
+    std::visit(quantumcircuit_utils::overloaded {
+      [&](const QuantumInstruction& qinst) {
+        compile_qinst(qinst, i, op);
+      },
+      [&](const ClassicalInstruction& clinst) {
+        constexpr OpCode classical_opcodes[] = {OpCode::NOT, OpCode::AND, OpCode::OR, OpCode::XOR, OpCode::NAND, OpCode::CLEAR};
+        op.code = classical_opcodes[static_cast<size_t>(clinst.op)];
+        std::copy(clinst.bits.begin(), clinst.bits.end(), op.args);
+      },
+      [&](const ConditionedInstruction& cinst) {
+        compile_qinst(cinst.inst, i, op);
+        op.control = cinst.control ? cinst.control.value() : CompiledOp::NONE;
+        op.target = cinst.target ? cinst.target.value() : CompiledOp::NONE;
       }
-    }
+    }, instructions[i]);
 
-    dag.remove_vertex(j);
-    reversed_dag.remove_vertex(j);
+    program.ops.push_back(op);
   }
-  
-  return to_circuit(dag, num_qubits, num_cbits, measurement_map, parameter_map, ltr);
+
+  // Record the length of every run of unconditioned gates, so that they can be dispatched together
+  uint32_t run = 0;
+  for (size_t i = program.ops.size(); i > 0; i--) {
+    CompiledOp& op = program.ops[i - 1];
+    run = (op.is_gate() && op.control == CompiledOp::NONE) ? run + 1 : 0;
+    op.run = run;
+  }
+
+  return program;
 }
 
 void QuantumCircuit::apply_qubit_map(const Qubits& qubits) {
@@ -5,6 +5,7 @@
 #include "Graph.hpp"
 
 #include "Instructions.hpp"
+#include "CompiledCircuit.hpp"
 
 #include <iostream>
 
@@ -62,6 +63,12 @@ class QuantumCircuit {
     static QuantumCircuit to_circuit(const CircuitDAG& dag, uint32_t num_qubits, uint32_t num_cbits, const std::vector<size_t>& measurement_map, const std::vector<size_t>& parameter_map, bool ltr=true);
     QuantumCircuit simplify(bool ltr) const;
 
+    // Lowers the circuit into a flat CompiledCircuit, which can be run repeatedly on Clifford states. The second
+    // form places the circuit on the given qubits of a register of num_qubits qubits. Throws if the circuit
+    // contains parameters or instructions other than Clifford gates, measurements and classical operations.
+    CompiledCircuit compile() const;
+    CompiledCircuit compile(const Qubits& qubits, uint32_t num_qubits) const;
+
     uint32_t get_num_qubits() const {
       return num_qubits;
     }
@@ -2,7 +2,9 @@
 
 #include <climits>
 
-#include <glaze/glaze.hpp>
+#include "BinaryMatrix.hpp"
+
+#include <bit>
 
 
 const uint32_t QuantumGraphState::ZGATES[4] = {IDGATE, ZGATE, SGATE, SDGATE};
@@ -93,14 +95,14 @@ const uint32_t QuantumGraphState::CZ_LOOKUP[24][24][2][3] =
 
 #include <iostream>
 QuantumGraphState::QuantumGraphState(uint32_t num_qubits) : CliffordState(num_qubits), num_qubits(num_qubits) {
-  graph = UndirectedGraph<int>();
+  graph = GraphType();
   for (uint32_t i = 0; i < num_qubits; i++) {
     graph.add_vertex(HGATE);
   }
 }
 
-QuantumGraphState::QuantumGraphState(UndirectedGraph<int> &graph) : CliffordState(graph.num_vertices) {
-  this->graph = UndirectedGraph<int>(graph);
+QuantumGraphState::QuantumGraphState(UndirectedGraph<int> &graph) : CliffordState(graph.num_vertices), num_qubits(graph.num_vertices) {
+  this->graph = GraphType(graph);
 }
 
 QuantumCHPState QuantumGraphState::to_chp() const {
@@ -455,112 +457,69 @@ uint32_t QuantumGraphState::distance(const QuantumGraphState& other) const {
   return s;
 }
 
-double QuantumGraphState::graph_state_entanglement(const Qubits& qubits, UndirectedGraph<int>& graph) {
-  auto bipartite_graph = graph.partition(qubits);
-  int s = 2*bipartite_graph.num_vertices;
-  for (uint32_t i = 0; i < bipartite_graph.num_vertices; i++) {
-    if (bipartite_graph.get_val(i)) {
-      s--;
+double QuantumGraphState::graph_state_entanglement(const Qubits& qubits, const GraphType& graph) {
+  constexpr uint32_t NOT_A_COLUMN = UINT32_MAX;
+  uint32_t num_vertices = graph.num_vertices;
+
+  thread_local std::vector<uint8_t> in_a;
+  in_a.assign(num_vertices, 0u);
+  for (uint32_t q : qubits) {
+    if (q >= num_vertices) {
+      throw std::invalid_argument(std::format("Qubit {} is out of range for a graph state of {} qubits.", q, num_vertices));
     }
+    in_a[q] = 1u;
   }
 
+  // The block and its transpose have the same rank, so the smaller side indexes the rows
+  size_t size_a = std::count(in_a.begin(), in_a.end(), 1u);
+  uint8_t row_side = (size_a <= num_vertices - size_a) ? 1u : 0u;
 
-  // Trim leafs in B
-  bool found_isolated = true;
-  while (!found_isolated) {
-    found_isolated = false;
-    for (uint32_t i = 0; i < bipartite_graph.num_vertices; i++) {
-      if (bipartite_graph.degree(i) == 1 && !bipartite_graph.get_val(i)) {
-        found_isolated = true;
-        uint32_t neighbor = bipartite_graph.neighbors(i)[0];
-        bipartite_graph.remove_vertex(std::max(i, neighbor));
-        bipartite_graph.remove_vertex(std::min(i, neighbor));
-        s -= 2;
-
-        break;
-      }
+  thread_local std::vector<uint32_t> rows;
+  thread_local std::vector<uint32_t> column;
+  rows.clear();
+  column.assign(num_vertices, NOT_A_COLUMN);
+  uint32_t num_cols = 0;
+  for (uint32_t v = 0; v < num_vertices; v++) {
+    if (in_a[v] == row_side) {
+      rows.push_back(v);
+    } else {
+      column[v] = num_cols++;
     }
   }
 
-  bool continue_deleting = true;
-  while (continue_deleting) {
-    continue_deleting = false;
-
-    uint32_t del_node;
-    for (uint32_t i = 0; i < bipartite_graph.num_vertices; i++) {
-      if (!bipartite_graph.get_val(i)) { // Vertex is in B; must delete it.
-        continue_deleting = true;
-        del_node = i;
-        break;
+  thread_local BinaryMatrix block;
+  block.resize(rows.size(), num_cols);
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (uint32_t u : graph.edges_of(rows[i])) {
+      if (column[u] != NOT_A_COLUMN) {
+        block.set(i, column[u], 1u);
       }
     }
+  }
 
-    if (!continue_deleting) {
-      break;
-    }
-
-    uint32_t del_node_degree = bipartite_graph.degree(del_node);
-    if (del_node_degree == 0) {
-      bipartite_graph.remove_vertex(del_node);
-      s -= 2;
-    } else if (del_node_degree == 1) {
-      uint32_t neighbor = bipartite_graph.neighbors(del_node)[0];
-      bipartite_graph.remove_vertex(std::max(del_node, neighbor));
-      bipartite_graph.remove_vertex(std::min(del_node, neighbor));
-      s -= 2;
-    } else {
-      bool found_pivot = false;
-      uint32_t pivot = 0;
-      uint32_t min_degree = INT_MAX;
-      for (auto neighbor : bipartite_graph.neighbors(del_node)) {
-        uint32_t deg = bipartite_graph.degree(neighbor);
-
-        if ((deg != 1) && (deg < min_degree)) {
-          found_pivot = true;
-          min_degree = deg;
-          pivot = neighbor;
-        }
-      }
-
-      // there is no valid pivot, so subgraph is a simple tree; clear it.
-      if (!found_pivot) {
-        std::vector<uint32_t> neighbors = bipartite_graph.neighbors(del_node);
-        neighbors.push_back(del_node);
-        std::sort(neighbors.begin(), neighbors.end(), std::greater<>());
-
-        for (auto neighbor : neighbors) {
-          bipartite_graph.remove_vertex(neighbor);
-        }
-
-        s -= neighbors.size();
-      } else {
-        for (auto neighbor : bipartite_graph.neighbors(del_node)) {
-          if (neighbor != pivot) {
-            std::vector<uint32_t> pivot_neighbors = bipartite_graph.neighbors(pivot);
-            for (uint32_t k = 0; k < min_degree; k++) {
-              uint32_t pivot_neighbor = pivot_neighbors[k];
-              bipartite_graph.toggle_edge(neighbor, pivot_neighbor);
-            }
-          }
-        }
+  return static_cast<double>(block.rank());
+}
 
-        // Pivot completed; ready to be deleted on the next iteration
-      }
+double QuantumGraphState::entanglement(const QubitSupport &support, uint32_t index) const {
+  return QuantumGraphState::graph_state_entanglement(to_qubits(support), graph);
+}
 
+std::vector<double> QuantumGraphState::cum_entanglement_profile(const std::vector<uint32_t>& cuts, uint32_t index, bool direction) const {
+  thread_local BinaryMatrix stabilizers;
+  stabilizers.resize(num_qubits, 2*num_qubits);
+  for (uint32_t v = 0; v < num_qubits; v++) {
+    stabilizers.set(v, 2*v, 1u);
+    for (uint32_t u : graph.edges_of(v)) {
+      stabilizers.set(v, 2*u + 1, 1u);
     }
   }
 
-  for (uint32_t i = 0; i < bipartite_graph.num_vertices; i++) {
-    if (bipartite_graph.degree(i) == 0) {
-      s--;
-    }
+  std::vector<uint32_t> counts(num_qubits);
+  for (uint32_t c : stabilizers.pivots()) {
+    counts[c / 2]++;
   }
 
-  return static_cast<double>(s);
-}
-
-double QuantumGraphState::entanglement(const QubitSupport &support, uint32_t index) {
-  return QuantumGraphState::graph_state_entanglement(to_qubits(support), graph);
+  return endpoint_entanglement(counts, cuts, direction);
 }
 
 double QuantumGraphState::sparsity() const {
@@ -574,21 +533,70 @@ double QuantumGraphState::sparsity() const {
   return s/(num_qubits*num_qubits);
 }
 
-template <>
-struct glz::meta<UndirectedGraph<int>> {
-  static constexpr auto value = glz::object(
-    "num_vertices", &UndirectedGraph<int>::num_vertices,
-    "vals", &UndirectedGraph<int>::vals,
-    "edges", &UndirectedGraph<int>::edges
-  );
-};
-
-template <>
-struct glz::meta<QuantumGraphState> {
-  static constexpr auto value = glz::object(
-    "num_qubits", &QuantumGraphState::num_qubits,
-    "graph", &QuantumGraphState::graph
-  );
-};
-
-DEFINE_SERIALIZATION(QuantumGraphState);
+std::vector<char> QuantumGraphState::serialize() const {
+  SnapshotWriter writer;
+  writer.write_header(SnapshotKind::GraphState, num_qubits, Random::get_state());
+  writer.write_array(graph.vals);
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    writer.write_array(graph.edges[i].words);
+  }
+  return std::move(writer.bytes);
+}
+
+void QuantumGraphState::deserialize(const std::vector<char>& bytes) {
+  SnapshotReader reader(bytes);
+  SnapshotHeader header = reader.read_header();
+  if (header.kind != SnapshotKind::GraphState) {
+    throw std::runtime_error(std::format("Cannot restore a QuantumGraphState from a snapshot of kind {}.", static_cast<uint32_t>(header.kind)));
+  }
+
+  QuantumGraphState state(header.num_qubits);
+  reader.read_into(std::span<int>(state.graph.vals));
+  for (uint32_t i = 0; i < state.num_qubits; i++) {
+    int v = state.graph.vals[i];
+    if (v < 0 || v >= 24) {
+      throw std::runtime_error(std::format("Snapshot VOP {} of vertex {} is not a single-qubit Clifford.", v, i));
+    }
+  }
+
+  for (uint32_t i = 0; i < state.num_qubits; i++) {
+    AdjacencyBitset& neighbors = state.graph.edges[i];
+    reader.read_array(neighbors.words);
+    if (neighbors.words.size() > (state.num_qubits + 63) / 64) {
+      throw std::runtime_error(std::format("Snapshot adjacency of vertex {} has {} words; expected at most {}.", i, neighbors.words.size(), (state.num_qubits + 63) / 64));
+    }
+
+    // Bits past num_qubits in the last word would be counted as neighbors which do not exist
+    if (state.num_qubits % 64 != 0 && neighbors.words.size() == (state.num_qubits + 63) / 64) {
+      uint64_t excess = neighbors.words.back() >> (state.num_qubits % 64);
+      if (excess != 0) {
+        throw std::runtime_error(std::format("Snapshot adjacency of vertex {} has neighbors past {} qubits.", i, state.num_qubits));
+      }
+    }
+
+    neighbors.num_neighbors = 0;
+    for (uint64_t w : neighbors.words) {
+      neighbors.num_neighbors += std::popcount(w);
+    }
+  }
+
+  auto has_edge = [&state](uint32_t i, uint32_t j) {
+    const std::vector<uint64_t>& words = state.graph.edges[i].words;
+    return j / 64 < words.size() && ((words[j / 64] >> (j % 64)) & 1u);
+  };
+
+  for (uint32_t i = 0; i < state.num_qubits; i++) {
+    for (uint32_t j = i + 1; j < state.num_qubits; j++) {
+      if (has_edge(i, j) != has_edge(j, i)) {
+        throw std::runtime_error(std::format("Snapshot adjacency is not symmetric between vertices {} and {}.", i, j));
+      }
+    }
+  }
+
+  *this = std::move(state);
+}
+
+// Graphs are copied eagerly; the adjacency bitsets take n^2/8 bytes, the same as a dense tableau
+std::shared_ptr<CliffordState> QuantumGraphState::fork() const {
+  return std::make_shared<QuantumGraphState>(*this);
+}
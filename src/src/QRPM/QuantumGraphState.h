@@ -4,6 +4,7 @@
 #include "Graph.hpp"
 #include "CliffordState.h"
 #include "QuantumCHPState.h"
+#include "Statevector.h"
 
 #define IDGATE     0
 #define XGATE      1
@@ -44,8 +45,12 @@ class QuantumGraphState : public CliffordState {
   public:
     using CliffordState::expectation;
 
+    // Edges are stored as adjacency bitsets: local complementation, the core of every gate and
+    // measurement, is then a word-wise XOR of the neighborhood into the rows of the neighbors
+    using GraphType = UndirectedGraph<int, void, BitsetEdges>;
+
     uint32_t num_qubits;
-    UndirectedGraph<int> graph;
+    GraphType graph;
 
     QuantumGraphState()=default;
     QuantumGraphState(uint32_t num_qubits);
@@ -79,11 +84,18 @@ class QuantumGraphState : public CliffordState {
 
     uint32_t distance(const QuantumGraphState& other) const;
 
-    static double graph_state_entanglement(const Qubits &qubits, UndirectedGraph<int> &graph);
-    virtual double entanglement(const QubitSupport &support, uint32_t index) override;
+    // The entanglement of a graph state across A|B is the GF(2) rank of the adjacency block between A and B;
+    // the vertex operators are local and do not change it. The block is packed into a scratch BinaryMatrix.
+    static double graph_state_entanglement(const Qubits &qubits, const GraphType &graph);
+    virtual double entanglement(const QubitSupport &support, uint32_t index) const override;
+
+    // Every contiguous cut from a single elimination of the graph stabilizers X_v Z_{N(v)}
+    virtual std::vector<double> cum_entanglement_profile(const std::vector<uint32_t>& cuts, uint32_t index=2u, bool direction=true) const override;
 
     virtual double sparsity() const override;
     
-    std::vector<char> serialize() const override;
-    void deserialize(const std::vector<char>& bytes) override;
+    // Snapshots hold the vertex operators and the raw adjacency words of every vertex
+    virtual std::vector<char> serialize() const override;
+    virtual void deserialize(const std::vector<char>& bytes) override;
+    virtual std::shared_ptr<CliffordState> fork() const override;
 };
@@ -385,3 +385,303 @@ MeasurementData QuantumState::measure(const Qubits& qubits, std::optional<PauliS
 MeasurementData QuantumState::weak_measure(const Qubits& qubits, double beta, std::optional<PauliString> pauli, std::optional<bool> outcome) {
   return weak_measure(WeakMeasurement(qubits, beta, pauli, outcome));
 }
+
+// --- MagicQuantumState --- //
+
+static Qubits all_qubits(size_t num_qubits) {
+  Qubits qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return qubits;
+}
+
+static Qubits union_qubits(const Qubits& qubitsA, const Qubits& qubitsB) {
+  Qubits qubits = qubitsA;
+  qubits.insert(qubits.end(), qubitsB.begin(), qubitsB.end());
+  std::sort(qubits.begin(), qubits.end());
+  qubits.erase(std::unique(qubits.begin(), qubits.end()), qubits.end());
+  return qubits;
+}
+
+// The k-th of the 4^|sites| Pauli strings supported on sites, with the x and z bits of site j in bits 2j and 2j+1 of k
+static PauliString pauli_on_sites(uint64_t k, const Qubits& sites, uint32_t num_qubits) {
+  PauliString pauli(num_qubits);
+  for (size_t j = 0; j < sites.size(); j++) {
+    pauli.set_x(sites[j], (k >> (2*j)) & 1u);
+    pauli.set_z(sites[j], (k >> (2*j + 1)) & 1u);
+  }
+  return pauli;
+}
+
+// The expectation of a Pauli, followed by the expectation of its restriction to each support, tr(rho_A P_A)
+static std::vector<double> pauli_amplitudes(const QuantumState& state, const PauliString& pauli, const std::vector<Qubits>& supports) {
+  std::vector<double> amplitudes = {state.expectation(pauli).real()};
+  for (const auto& qubits : supports) {
+    amplitudes.push_back(state.expectation(pauli.substring(qubits)).real());
+  }
+  return amplitudes;
+}
+
+static std::vector<Qubits> supports_to_qubits(const std::vector<QubitSupport>& supports) {
+  std::vector<Qubits> qubits;
+  for (const auto& support : supports) {
+    qubits.push_back(to_qubits(support));
+  }
+  return qubits;
+}
+
+std::vector<PauliAmplitudes> MagicQuantumState::sample_paulis_exhaustive(const std::vector<QubitSupport>& supports) {
+  auto qubits = supports_to_qubits(supports);
+  Qubits sites = all_qubits(num_qubits);
+
+  std::vector<PauliAmplitudes> samples;
+  uint64_t num_paulis = 1ull << (2*num_qubits);
+  for (uint64_t k = 0; k < num_paulis; k++) {
+    PauliString pauli = pauli_on_sites(k, sites, num_qubits);
+    samples.push_back({pauli, pauli_amplitudes(*this, pauli, qubits)});
+  }
+
+  return samples;
+}
+
+std::vector<PauliAmplitudes> MagicQuantumState::sample_paulis_exact(const std::vector<QubitSupport>& supports, size_t num_samples, ProbabilityFunc prob) {
+  auto qubits = supports_to_qubits(supports);
+  Qubits sites = all_qubits(num_qubits);
+
+  uint64_t num_paulis = 1ull << (2*num_qubits);
+  std::vector<double> weights(num_paulis);
+  for (uint64_t k = 0; k < num_paulis; k++) {
+    weights[k] = prob(expectation(pauli_on_sites(k, sites, num_qubits)).real());
+  }
+
+  std::minstd_rand rng(randi());
+  std::discrete_distribution<uint64_t> dist(weights.begin(), weights.end());
+
+  std::vector<PauliAmplitudes> samples;
+  for (size_t i = 0; i < num_samples; i++) {
+    PauliString pauli = pauli_on_sites(dist(rng), sites, num_qubits);
+    samples.push_back({pauli, pauli_amplitudes(*this, pauli, qubits)});
+  }
+
+  return samples;
+}
+
+// Metropolis chain over Pauli strings with weight prob(<P>), starting from the identity. By default every step 
+// replaces the Pauli on a single random site.
+std::vector<PauliAmplitudes> MagicQuantumState::sample_paulis_montecarlo(const std::vector<QubitSupport>& supports, size_t num_samples, size_t equilibration_timesteps, ProbabilityFunc prob, std::optional<PauliMutationFunc> mutation_opt) {
+  auto qubits = supports_to_qubits(supports);
+  PauliMutationFunc mutation = mutation_opt ? mutation_opt.value() : single_qubit_random_mutation;
+
+  PauliString pauli(num_qubits);
+  double weight = prob(expectation(pauli).real());
+
+  auto step = [&]() {
+    PauliString proposal = pauli;
+    mutation(proposal);
+    double proposal_weight = prob(expectation(proposal).real());
+    if (proposal_weight >= weight || randf() < proposal_weight / weight) {
+      pauli = proposal;
+      weight = proposal_weight;
+    }
+  };
+
+  for (size_t i = 0; i < equilibration_timesteps; i++) {
+    step();
+  }
+
+  std::vector<PauliAmplitudes> samples;
+  for (size_t i = 0; i < num_samples; i++) {
+    step();
+    samples.push_back({pauli, pauli_amplitudes(*this, pauli, qubits)});
+  }
+
+  return samples;
+}
+
+// The stabilizer Renyi entropy of a (mixed) state rho_X is M(X) = -log(W4/W2) with Wk = sum_P tr(rho_X P)^k, over the
+// Paulis P supported on X, and the magic mutual information is L(A:B) = M(AB) - M(A) - M(B). Sampling P from 
+// t^2/W2 gives W4/W2 = E2[t^2], and sampling from t^4/W4 gives W2/W4 = E4[t^-2]; both estimates are averaged. The 
+// samples of each region come from a separate chain on that region.
+double MagicQuantumState::calculate_magic_mutual_information_from_samples(const MutualMagicAmplitudes& samples2, const MutualMagicAmplitudes& samples4) {
+  if (samples2.size() != 3 || samples4.size() != 3) {
+    throw std::invalid_argument("Magic mutual information needs samples of tA, tB and tAB.");
+  }
+
+  auto stabilizer_entropy = [&](size_t i) {
+    double e2 = 0.0;
+    for (double t : samples2[i]) {
+      e2 += t*t;
+    }
+    e2 /= samples2[i].size();
+
+    double e4 = 0.0;
+    for (double t : samples4[i]) {
+      e4 += 1.0/(t*t);
+    }
+    e4 /= samples4[i].size();
+
+    return 0.5*(std::log(e4) - std::log(e2));
+  };
+
+  return stabilizer_entropy(2) - stabilizer_entropy(0) - stabilizer_entropy(1);
+}
+
+MutualMagicData MagicQuantumState::magic_mutual_information_samples_montecarlo(const Qubits& qubitsA, const Qubits& qubitsB, size_t num_samples, size_t equilibration_timesteps, std::optional<PauliMutationFunc> mutation_opt) {
+  Qubits qubitsAB = union_qubits(qubitsA, qubitsB);
+
+  auto prob2 = [](double t) { return t*t; };
+  auto prob4 = [](double t) { return t*t*t*t; };
+
+  MutualMagicAmplitudes samples2;
+  MutualMagicAmplitudes samples4;
+  for (const Qubits& region : {qubitsA, qubitsB, qubitsAB}) {
+    if (region.empty()) {
+      throw std::invalid_argument("Cannot compute the magic mutual information of an empty region.");
+    }
+
+    // Mutations are kept on the region
+    PauliMutationFunc mutation = [&region, &mutation_opt](PauliString& pauli) {
+      if (mutation_opt) {
+        mutation_opt.value()(pauli);
+        pauli = pauli.substring(region);
+      } else {
+        uint32_t q = region[randi() % region.size()];
+        uint32_t g = randi() % 4;
+        pauli.set_x(q, g & 1u);
+        pauli.set_z(q, (g >> 1) & 1u);
+      }
+    };
+
+    samples2.push_back(extract_amplitudes(sample_paulis_montecarlo({}, num_samples, equilibration_timesteps, prob2, mutation))[0]);
+    samples4.push_back(extract_amplitudes(sample_paulis_montecarlo({}, num_samples, equilibration_timesteps, prob4, mutation))[0]);
+  }
+
+  return {samples2, samples4};
+}
+
+double MagicQuantumState::magic_mutual_information_montecarlo(const Qubits& qubitsA, const Qubits& qubitsB, size_t num_samples, size_t equilibration_timesteps, std::optional<PauliMutationFunc> mutation_opt) {
+  return calculate_magic_mutual_information_from_samples(magic_mutual_information_samples_montecarlo(qubitsA, qubitsB, num_samples, equilibration_timesteps, mutation_opt));
+}
+
+MutualMagicData MagicQuantumState::magic_mutual_information_samples_exact(const Qubits& qubitsA, const Qubits& qubitsB, size_t num_samples) {
+  Qubits qubitsAB = union_qubits(qubitsA, qubitsB);
+  std::minstd_rand rng(randi());
+
+  MutualMagicAmplitudes samples2;
+  MutualMagicAmplitudes samples4;
+  for (const Qubits& region : {qubitsA, qubitsB, qubitsAB}) {
+    uint64_t num_paulis = 1ull << (2*region.size());
+    std::vector<double> t(num_paulis);
+    std::vector<double> weights2(num_paulis);
+    std::vector<double> weights4(num_paulis);
+    for (uint64_t k = 0; k < num_paulis; k++) {
+      t[k] = expectation(pauli_on_sites(k, region, num_qubits)).real();
+      weights2[k] = t[k]*t[k];
+      weights4[k] = weights2[k]*weights2[k];
+    }
+
+    std::discrete_distribution<uint64_t> dist2(weights2.begin(), weights2.end());
+    std::discrete_distribution<uint64_t> dist4(weights4.begin(), weights4.end());
+    std::vector<double> t2(num_samples);
+    std::vector<double> t4(num_samples);
+    for (size_t i = 0; i < num_samples; i++) {
+      t2[i] = t[dist2(rng)];
+      t4[i] = t[dist4(rng)];
+    }
+
+    samples2.push_back(t2);
+    samples4.push_back(t4);
+  }
+
+  return {samples2, samples4};
+}
+
+double MagicQuantumState::magic_mutual_information_exact(const Qubits& qubitsA, const Qubits& qubitsB, size_t num_samples) {
+  return calculate_magic_mutual_information_from_samples(magic_mutual_information_samples_exact(qubitsA, qubitsB, num_samples));
+}
+
+double MagicQuantumState::magic_mutual_information_exhaustive(const Qubits& qubitsA, const Qubits& qubitsB) {
+  Qubits qubitsAB = union_qubits(qubitsA, qubitsB);
+
+  auto stabilizer_entropy = [&](const Qubits& region) {
+    double w2 = 0.0;
+    double w4 = 0.0;
+    uint64_t num_paulis = 1ull << (2*region.size());
+    for (uint64_t k = 0; k < num_paulis; k++) {
+      double t = expectation(pauli_on_sites(k, region, num_qubits)).real();
+      w2 += t*t;
+      w4 += t*t*t*t;
+    }
+    return -std::log(w4/w2);
+  };
+
+  return stabilizer_entropy(qubitsAB) - stabilizer_entropy(qubitsA) - stabilizer_entropy(qubitsB);
+}
+
+double MagicQuantumState::magic_mutual_information(const Qubits& qubitsA, const Qubits& qubitsB, size_t num_samples) {
+  size_t equilibration_timesteps = 10*union_qubits(qubitsA, qubitsB).size();
+  return magic_mutual_information_montecarlo(qubitsA, qubitsB, num_samples, equilibration_timesteps);
+}
+
+std::vector<QubitSupport> get_bipartite_supports(size_t num_qubits) {
+  std::vector<QubitSupport> supports;
+  for (size_t i = 1; i < num_qubits; i++) {
+    supports.push_back(QubitInterval(std::pair<uint32_t, uint32_t>(0, i)));
+  }
+  return supports;
+}
+
+std::tuple<Qubits, Qubits, Qubits> get_traced_qubits(const Qubits& qubitsA, const Qubits& qubitsB, size_t num_qubits) {
+  Qubits qubitsAB = union_qubits(qubitsA, qubitsB);
+  return {
+    to_qubits(support_complement(qubitsA, num_qubits)), 
+    to_qubits(support_complement(qubitsB, num_qubits)), 
+    to_qubits(support_complement(qubitsAB, num_qubits))
+  };
+}
+
+// Each cut [0, i) : [i, n) of the chain, for i = 1, ..., n - 1
+template <typename F>
+static auto map_bipartitions(size_t num_qubits, F&& f) {
+  using T = decltype(f(Qubits(), Qubits()));
+  std::vector<T> results;
+  for (const auto& support : get_bipartite_supports(num_qubits)) {
+    results.push_back(f(to_qubits(support), to_qubits(support_complement(support, num_qubits))));
+  }
+  return results;
+}
+
+std::vector<double> MagicQuantumState::bipartite_magic_mutual_information(size_t num_samples) {
+  return map_bipartitions(num_qubits, [&](const Qubits& qubitsA, const Qubits& qubitsB) {
+    return magic_mutual_information(qubitsA, qubitsB, num_samples);
+  });
+}
+
+std::vector<MutualMagicData> MagicQuantumState::bipartite_magic_mutual_information_samples_montecarlo(size_t num_samples, size_t equilibration_timesteps, std::optional<PauliMutationFunc> mutation_opt) {
+  return map_bipartitions(num_qubits, [&](const Qubits& qubitsA, const Qubits& qubitsB) {
+    return magic_mutual_information_samples_montecarlo(qubitsA, qubitsB, num_samples, equilibration_timesteps, mutation_opt);
+  });
+}
+
+std::vector<double> MagicQuantumState::bipartite_magic_mutual_information_montecarlo(size_t num_samples, size_t equilibration_timesteps, std::optional<PauliMutationFunc> mutation_opt) {
+  return map_bipartitions(num_qubits, [&](const Qubits& qubitsA, const Qubits& qubitsB) {
+    return magic_mutual_information_montecarlo(qubitsA, qubitsB, num_samples, equilibration_timesteps, mutation_opt);
+  });
+}
+
+std::vector<MutualMagicData> MagicQuantumState::bipartite_magic_mutual_information_samples_exact(size_t num_samples) {
+  return map_bipartitions(num_qubits, [&](const Qubits& qubitsA, const Qubits& qubitsB) {
+    return magic_mutual_information_samples_exact(qubitsA, qubitsB, num_samples);
+  });
+}
+
+std::vector<double> MagicQuantumState::bipartite_magic_mutual_information_exact(size_t num_samples) {
+  return map_bipartitions(num_qubits, [&](const Qubits& qubitsA, const Qubits& qubitsB) {
+    return magic_mutual_information_exact(qubitsA, qubitsB, num_samples);
+  });
+}
+
+std::vector<double> MagicQuantumState::bipartite_magic_mutual_information_exhaustive() {
+  return map_bipartitions(num_qubits, [&](const Qubits& qubitsA, const Qubits& qubitsB) {
+    return magic_mutual_information_exhaustive(qubitsA, qubitsB);
+  });
+}
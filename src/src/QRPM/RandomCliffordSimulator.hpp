@@ -22,6 +22,7 @@ inline static void rc_timestep(std::shared_ptr<CliffordState> state, uint32_t ga
 	std::vector<uint32_t> qubits(gate_width);
 	std::iota(qubits.begin(), qubits.end(), 0);
 
+	std::vector<Qubits> supports;
 	for (uint32_t j = 0; j < num_gates; j++) {
 		uint32_t offset = offset_layer ? gate_width*j : gate_width*j + gate_width/2;
 
@@ -37,9 +38,11 @@ inline static void rc_timestep(std::shared_ptr<CliffordState> state, uint32_t ga
 						});
 		
 		if (!(!periodic_bc && periodic)) {
-			state->random_clifford(offset_qubits);
+			supports.push_back(offset_qubits);
 		}
 	}
+
+	state->random_clifford_layer(supports);
 }
 
 static inline double rc_power_law(double x0, double x1, double n, double r) {
@@ -65,12 +68,14 @@ class RandomCliffordSimulator : public Simulator {
 		bool offset;
 		bool pbc;
 
+		std::vector<double> draws;
+
     uint32_t randpl() {
       return rc_power_law(1.0, system_size/2.0, -alpha, randf()); 
     }
 
     void timestep_random_local() {
-      uint32_t q1 = rand() % system_size;
+      uint32_t q1 = randi() % system_size;
       uint32_t q2 = (q1 + 1) % system_size;
 
       std::vector<uint32_t> qbits{q1, q2};;
@@ -120,8 +125,9 @@ class RandomCliffordSimulator : public Simulator {
         rc_timestep(state, gate_width, offset, pbc);
 
         // Apply measurements
+        Random::fill_uniform(draws);
         for (uint32_t j = 0; j < system_size; j++) {
-          if (randf() < mzr_prob) {
+          if (draws[j] < mzr_prob) {
             mzr(j);
           }
         }
@@ -152,6 +158,7 @@ class RandomCliffordSimulator : public Simulator {
 
       offset = false;
       pbc = get<int>(params, "pbc", RC_DEFAULT_PBC);
+      draws = std::vector<double>(system_size);
 
       state = std::make_shared<QuantumCHPState>(system_size);
     }
@@ -167,7 +174,7 @@ class RandomCliffordSimulator : public Simulator {
         timestep_powerlaw();
       }
 
-      state->tableau->rref();
+      state->rref();
     }
 };
 
@@ -37,6 +37,8 @@ SandpileCliffordSimulator::SandpileCliffordSimulator(Params& params) {
   set_feedback_strategy(feedback_mode);
 
   state = std::make_shared<QuantumCHPState>(system_size);
+  // feedback() queries the entanglement across three neighbouring cuts at every step
+  state->set_track_entanglement(true);
 
   if (initial_state == SUBSTRATE) {
     // Do nothing
@@ -197,9 +199,10 @@ void SandpileCliffordSimulator::feedback(uint32_t q) {
     q2 = q + 1;
   }
 
-  int s0 = state->cum_entanglement<int>(q0);
-  int s1 = state->cum_entanglement<int>(q);
-  int s2 = state->cum_entanglement<int>(q2);
+  std::vector<int> s = state->get_entanglement<int>({q0, q, q2});
+  int s0 = s[0];
+  int s1 = s[1];
+  int s2 = s[2];
 
   uint32_t shape = get_shape(s0, s1, s2);
 
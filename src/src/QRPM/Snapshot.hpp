@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include <format>
+#include <stdexcept>
+#include <type_traits>
+
+// Binary snapshots of Clifford states. Every snapshot starts with a fixed header,
+//   magic "QRPMSNAP" | version | kind | num_qubits | generator state (length-prefixed text)
+// followed by the payload of the backend. Packed words are written raw, in host byte order, so that restoring
+// a tableau is one memcpy per array. Snapshots are meant for checkpointing runs, not as an exchange format
+// between machines of different endianness.
+constexpr char SNAPSHOT_MAGIC[8] = {'Q', 'R', 'P', 'M', 'S', 'N', 'A', 'P'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+enum class SnapshotKind : uint32_t { Tableau = 1, TableauSIMD = 2, TableauSparse = 3, GraphState = 4, StaticTableau = 5 };
+
+class SnapshotWriter {
+  public:
+    std::vector<char> bytes;
+
+    template <typename T>
+    void write(const T& value) {
+      static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written to a snapshot.");
+      size_t pos = bytes.size();
+      bytes.resize(pos + sizeof(T));
+      std::memcpy(bytes.data() + pos, &value, sizeof(T));
+    }
+
+    // Length-prefixed array of raw values
+    template <typename T>
+    void write_array(std::span<const T> values) {
+      static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written to a snapshot.");
+      write<uint64_t>(values.size());
+      size_t pos = bytes.size();
+      bytes.resize(pos + values.size_bytes());
+      if (!values.empty()) {
+        std::memcpy(bytes.data() + pos, values.data(), values.size_bytes());
+      }
+    }
+
+    template <typename Container>
+    void write_array(const Container& values) {
+      write_array(std::span<const typename Container::value_type>(values.data(), values.size()));
+    }
+
+    void write_string(const std::string& s) {
+      write_array(s);
+    }
+
+    void write_header(SnapshotKind kind, uint32_t num_qubits, const std::string& rng_state) {
+      bytes.insert(bytes.end(), std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC));
+      write(SNAPSHOT_VERSION);
+      write(kind);
+      write(num_qubits);
+      write_string(rng_state);
+    }
+};
+
+struct SnapshotHeader {
+  uint32_t version;
+  SnapshotKind kind;
+  uint32_t num_qubits;
+  std::string rng_state;
+};
+
+class SnapshotReader {
+  public:
+    SnapshotReader(const std::vector<char>& bytes) : bytes(bytes), pos(0) {}
+
+    template <typename T>
+    T read() {
+      static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read from a snapshot.");
+      require(sizeof(T));
+      T value;
+      std::memcpy(&value, bytes.data() + pos, sizeof(T));
+      pos += sizeof(T);
+      return value;
+    }
+
+    // Reads a length-prefixed array into a contiguous container, resizing it to fit
+    template <typename Container>
+    void read_array(Container& values) {
+      using T = typename Container::value_type;
+      static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read from a snapshot.");
+      uint64_t size = read<uint64_t>();
+      if (size > (bytes.size() - pos) / sizeof(T)) {
+        throw std::runtime_error(std::format("Snapshot array of {} elements overruns the end of the snapshot.", size));
+      }
+
+      values.resize(size);
+      if (size) {
+        std::memcpy(values.data(), bytes.data() + pos, size*sizeof(T));
+      }
+      pos += size*sizeof(T);
+    }
+
+    // As above, into storage whose size is already known
+    template <typename T>
+    void read_into(std::span<T> values) {
+      uint64_t size = read<uint64_t>();
+      if (size != values.size()) {
+        throw std::runtime_error(std::format("Expected a snapshot array of {} elements, found {}.", values.size(), size));
+      }
+
+      require(values.size_bytes());
+      if (size) {
+        std::memcpy(values.data(), bytes.data() + pos, values.size_bytes());
+      }
+      pos += values.size_bytes();
+    }
+
+    std::string read_string() {
+      std::string s;
+      read_array(s);
+      return s;
+    }
+
+    SnapshotHeader read_header() {
+      require(sizeof(SNAPSHOT_MAGIC));
+      if (std::memcmp(bytes.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::runtime_error("Data is not a QRPM snapshot.");
+      }
+      pos += sizeof(SNAPSHOT_MAGIC);
+
+      SnapshotHeader header;
+      header.version = read<uint32_t>();
+      if (header.version != SNAPSHOT_VERSION) {
+        throw std::runtime_error(std::format("Cannot read snapshot version {}; expected version {}.", header.version, SNAPSHOT_VERSION));
+      }
+      header.kind = read<SnapshotKind>();
+      header.num_qubits = read<uint32_t>();
+      header.rng_state = read_string();
+      return header;
+    }
+
+  private:
+    const std::vector<char>& bytes;
+    size_t pos;
+
+    void require(size_t n) const {
+      if (n > bytes.size() - pos) {
+        throw std::runtime_error(std::format("Snapshot is truncated: needed {} more bytes at offset {} of {}.", n, pos, bytes.size()));
+      }
+    }
+};
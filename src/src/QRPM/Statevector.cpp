@@ -0,0 +1,626 @@
+#include "Statevector.h"
+
+#include <thread>
+#include <exception>
+#include <bit>
+
+#include <Eigen/Eigenvalues>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using complex = std::complex<double>;
+
+// Index of the k-th amplitude with bit q clear
+inline size_t insert_zero(size_t k, uint32_t q) {
+  size_t low = k & ((static_cast<size_t>(1) << q) - 1);
+  return ((k >> q) << (q + 1)) | low;
+}
+
+// Splits [0, count) into contiguous blocks of a multiple of grain, one per thread, and runs f(begin, end, thread_id)
+// on each. The calling thread takes the first block.
+template <typename F>
+static void parallel_blocks(uint32_t num_threads, size_t count, size_t grain, F&& f) {
+  if (num_threads <= 1 || count < 2*grain) {
+    f(0, count, 0);
+    return;
+  }
+
+  size_t block = (count + num_threads - 1) / num_threads;
+  block = (block + grain - 1) / grain * grain;
+  num_threads = (count + block - 1) / block;
+
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto worker = [&](uint32_t t) {
+    try {
+      f(t*block, std::min(count, (t + 1)*block), t);
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STATEVECTOR_X86
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+// The kernels act on the pairs (one qubit) or quadruples (two qubits) of amplitudes [begin, end) mixed by the
+// gate, where m holds the gate in row-major order. The diagonal kernel multiplies amplitudes [begin, end) by
+// d[reduce(z)], with the bits of z on qubits gathered into the index of d.
+using OneQubitKernel = void (*)(complex* data, const complex* m, uint32_t q, size_t begin, size_t end);
+using TwoQubitKernel = void (*)(complex* data, const complex* m, uint32_t q0, uint32_t q1, size_t begin, size_t end);
+using DiagonalKernel = void (*)(complex* data, const complex* d, const uint32_t* qubits, uint32_t k, size_t begin, size_t end);
+
+struct StatevectorKernels {
+  const char* name;
+  OneQubitKernel one_qubit;
+  TwoQubitKernel two_qubit;
+  DiagonalKernel diagonal;
+};
+
+static void one_qubit_scalar(complex* data, const complex* m, uint32_t q, size_t begin, size_t end) {
+  size_t s = static_cast<size_t>(1) << q;
+  for (size_t k = begin; k < end; k++) {
+    size_t z0 = insert_zero(k, q);
+    complex a0 = data[z0];
+    complex a1 = data[z0 + s];
+    data[z0] = m[0]*a0 + m[1]*a1;
+    data[z0 + s] = m[2]*a0 + m[3]*a1;
+  }
+}
+
+static void two_qubit_scalar(complex* data, const complex* m, uint32_t q0, uint32_t q1, size_t begin, size_t end) {
+  size_t s0 = static_cast<size_t>(1) << q0;
+  size_t s1 = static_cast<size_t>(1) << q1;
+  uint32_t lo = std::min(q0, q1);
+  uint32_t hi = std::max(q0, q1);
+  for (size_t k = begin; k < end; k++) {
+    size_t z = insert_zero(insert_zero(k, lo), hi);
+    complex a[4] = {data[z], data[z + s0], data[z + s1], data[z + s0 + s1]};
+    data[z]           = m[0]*a[0]  + m[1]*a[1]  + m[2]*a[2]  + m[3]*a[3];
+    data[z + s0]      = m[4]*a[0]  + m[5]*a[1]  + m[6]*a[2]  + m[7]*a[3];
+    data[z + s1]      = m[8]*a[0]  + m[9]*a[1]  + m[10]*a[2] + m[11]*a[3];
+    data[z + s0 + s1] = m[12]*a[0] + m[13]*a[1] + m[14]*a[2] + m[15]*a[3];
+  }
+}
+
+inline size_t reduce_index(size_t z, const uint32_t* qubits, uint32_t k) {
+  size_t i = 0;
+  for (uint32_t j = 0; j < k; j++) {
+    i |= ((z >> qubits[j]) & 1u) << j;
+  }
+  return i;
+}
+
+static void diagonal_scalar(complex* data, const complex* d, const uint32_t* qubits, uint32_t k, size_t begin, size_t end) {
+  for (size_t z = begin; z < end; z++) {
+    data[z] *= d[reduce_index(z, qubits, k)];
+  }
+}
+
+#ifdef STATEVECTOR_X86
+// Two complex numbers per register, as (re, im, re, im). The products of x and y are
+// (x_re y_re - x_im y_im, x_im y_re + x_re y_im) in each half.
+TARGET_AVX2 inline __m256d cmul(__m256d x, __m256d y) {
+  __m256d yr = _mm256_movedup_pd(y);
+  __m256d yi = _mm256_permute_pd(y, 0xF);
+  __m256d xs = _mm256_permute_pd(x, 0x5);
+  return _mm256_fmaddsub_pd(x, yr, _mm256_mul_pd(xs, yi));
+}
+
+TARGET_AVX2 inline __m256d broadcast(const complex& c) {
+  return _mm256_broadcast_pd(reinterpret_cast<const __m128d*>(&c));
+}
+
+TARGET_AVX2 inline __m256d load(const complex* p) {
+  return _mm256_loadu_pd(reinterpret_cast<const double*>(p));
+}
+
+TARGET_AVX2 inline void store(complex* p, __m256d v) {
+  _mm256_storeu_pd(reinterpret_cast<double*>(p), v);
+}
+
+// For q >= 1 the pairs come in runs of 2^q, with both halves of a run contiguous; two pairs are updated per
+// iteration. For q = 0 the two amplitudes of a pair share a register, which is multiplied by both columns.
+TARGET_AVX2 static void one_qubit_avx2(complex* data, const complex* m, uint32_t q, size_t begin, size_t end) {
+  if (q == 0) {
+    __m256d c0 = _mm256_set_pd(m[2].imag(), m[2].real(), m[0].imag(), m[0].real());
+    __m256d c1 = _mm256_set_pd(m[3].imag(), m[3].real(), m[1].imag(), m[1].real());
+    for (size_t k = begin; k < end; k++) {
+      __m256d a = load(data + 2*k);
+      __m256d a0 = _mm256_permute2f128_pd(a, a, 0x00);
+      __m256d a1 = _mm256_permute2f128_pd(a, a, 0x11);
+      store(data + 2*k, _mm256_add_pd(cmul(a0, c0), cmul(a1, c1)));
+    }
+    return;
+  }
+
+  __m256d m00 = broadcast(m[0]), m01 = broadcast(m[1]), m10 = broadcast(m[2]), m11 = broadcast(m[3]);
+  size_t s = static_cast<size_t>(1) << q;
+  size_t k = begin;
+  while (k < end) {
+    size_t run_end = std::min(end, (k | (s - 1)) + 1);
+    size_t z0 = insert_zero(k, q);
+    size_t len = run_end - k;
+    size_t j = 0;
+    for (; j + 2 <= len; j += 2) {
+      __m256d a0 = load(data + z0 + j);
+      __m256d a1 = load(data + z0 + s + j);
+      store(data + z0 + j,     _mm256_add_pd(cmul(a0, m00), cmul(a1, m01)));
+      store(data + z0 + s + j, _mm256_add_pd(cmul(a0, m10), cmul(a1, m11)));
+    }
+    if (j < len) {
+      one_qubit_scalar(data, m, q, k + j, run_end);
+    }
+    k = run_end;
+  }
+}
+
+TARGET_AVX2 static void two_qubit_avx2(complex* data, const complex* m, uint32_t q0, uint32_t q1, size_t begin, size_t end) {
+  uint32_t lo = std::min(q0, q1);
+  uint32_t hi = std::max(q0, q1);
+  if (lo == 0) {
+    two_qubit_scalar(data, m, q0, q1, begin, end);
+    return;
+  }
+
+  __m256d g[16];
+  for (size_t i = 0; i < 16; i++) {
+    g[i] = broadcast(m[i]);
+  }
+
+  size_t s0 = static_cast<size_t>(1) << q0;
+  size_t s1 = static_cast<size_t>(1) << q1;
+  size_t run = static_cast<size_t>(1) << lo;
+  size_t k = begin;
+  while (k < end) {
+    size_t run_end = std::min(end, (k | (run - 1)) + 1);
+    size_t z = insert_zero(insert_zero(k, lo), hi);
+    size_t len = run_end - k;
+    size_t j = 0;
+    for (; j + 2 <= len; j += 2) {
+      complex* p = data + z + j;
+      __m256d a0 = load(p), a1 = load(p + s0), a2 = load(p + s1), a3 = load(p + s0 + s1);
+      for (size_t r = 0; r < 4; r++) {
+        __m256d v = _mm256_add_pd(_mm256_add_pd(cmul(a0, g[4*r]), cmul(a1, g[4*r + 1])), _mm256_add_pd(cmul(a2, g[4*r + 2]), cmul(a3, g[4*r + 3])));
+        store(p + ((r & 1) ? s0 : 0) + ((r & 2) ? s1 : 0), v);
+      }
+    }
+    if (j < len) {
+      two_qubit_scalar(data, m, q0, q1, k + j, run_end);
+    }
+    k = run_end;
+  }
+}
+
+TARGET_AVX2 static void diagonal_avx2(complex* data, const complex* d, const uint32_t* qubits, uint32_t k, size_t begin, size_t end) {
+  size_t z = begin;
+  for (; z + 2 <= end; z += 2) {
+    __m128d d0 = _mm_loadu_pd(reinterpret_cast<const double*>(d + reduce_index(z, qubits, k)));
+    __m128d d1 = _mm_loadu_pd(reinterpret_cast<const double*>(d + reduce_index(z + 1, qubits, k)));
+    __m256d dv = _mm256_insertf128_pd(_mm256_castpd128_pd256(d0), d1, 1);
+    store(data + z, cmul(load(data + z), dv));
+  }
+  diagonal_scalar(data, d, qubits, k, z, end);
+}
+#endif
+
+static StatevectorKernels select_kernels() {
+#ifdef STATEVECTOR_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return {"avx2", one_qubit_avx2, two_qubit_avx2, diagonal_avx2};
+  }
+#endif
+
+  return {"scalar", one_qubit_scalar, two_qubit_scalar, diagonal_scalar};
+}
+
+static const StatevectorKernels& statevector_kernels() {
+  static const StatevectorKernels kernels = select_kernels();
+  return kernels;
+}
+
+std::string Statevector::instruction_set() {
+  return statevector_kernels().name;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Statevector::Statevector(uint32_t num_qubits) : MagicQuantumState(num_qubits) {
+  data = Amplitudes(static_cast<size_t>(1) << num_qubits, 0.0);
+  data[0] = 1.0;
+}
+
+static uint32_t register_size(size_t size) {
+  if (size == 0 || !std::has_single_bit(size)) {
+    throw std::invalid_argument(std::format("Cannot create a Statevector from a vector of size {}, which is not a power of 2.", size));
+  }
+
+  return std::countr_zero(size);
+}
+
+Statevector::Statevector(const Eigen::VectorXcd& vec) : Statevector(register_size(vec.size())) {
+  for (size_t z = 0; z < data.size(); z++) {
+    data[z] = vec(z);
+  }
+}
+
+Eigen::VectorXcd Statevector::to_vector() const {
+  Eigen::VectorXcd vec(data.size());
+  for (size_t z = 0; z < data.size(); z++) {
+    vec(z) = data[z];
+  }
+  return vec;
+}
+
+uint32_t Statevector::threads_for(size_t num_amplitudes) const {
+  if (num_amplitudes < (static_cast<size_t>(1) << PARALLEL_MIN_QUBITS)) {
+    return 1;
+  }
+
+  return num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::string Statevector::to_string() const {
+  std::string s = "";
+  for (size_t z = 0; z < data.size(); z++) {
+    if (std::abs(data[z]) < QS_ATOL) {
+      continue;
+    }
+
+    std::string bits = "";
+    for (uint32_t q = 0; q < num_qubits; q++) {
+      bits += ((z >> (num_qubits - q - 1)) & 1u) ? "1" : "0";
+    }
+
+    s += std::format("{}({:.4f}{:+.4f}i)|{}>", s.empty() ? "" : " + ", data[z].real(), data[z].imag(), bits);
+  }
+
+  return s;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Statevector::apply_one_qubit(const Eigen::Matrix2cd& gate, uint32_t q) {
+  complex m[4] = {gate(0, 0), gate(0, 1), gate(1, 0), gate(1, 1)};
+  size_t num_pairs = data.size() / 2;
+  parallel_blocks(threads_for(data.size()), num_pairs, 64, [&](size_t begin, size_t end, uint32_t) {
+    statevector_kernels().one_qubit(data.data(), m, q, begin, end);
+  });
+}
+
+void Statevector::apply_two_qubit(const Eigen::Matrix4cd& gate, uint32_t q0, uint32_t q1) {
+  complex m[16];
+  for (size_t r = 0; r < 4; r++) {
+    for (size_t c = 0; c < 4; c++) {
+      m[4*r + c] = gate(r, c);
+    }
+  }
+
+  size_t num_quads = data.size() / 4;
+  parallel_blocks(threads_for(data.size()), num_quads, 64, [&](size_t begin, size_t end, uint32_t) {
+    statevector_kernels().two_qubit(data.data(), m, q0, q1, begin, end);
+  });
+}
+
+// Every block of 2^k amplitudes mixed by the gate is gathered, multiplied and scattered back
+void Statevector::apply_general(const Eigen::MatrixXcd& gate, const Qubits& qubits) {
+  uint32_t k = qubits.size();
+  size_t h = static_cast<size_t>(1) << k;
+
+  std::vector<size_t> offsets(h, 0);
+  for (size_t i = 0; i < h; i++) {
+    for (uint32_t j = 0; j < k; j++) {
+      if ((i >> j) & 1u) {
+        offsets[i] |= static_cast<size_t>(1) << qubits[j];
+      }
+    }
+  }
+
+  Qubits sorted = qubits;
+  std::sort(sorted.begin(), sorted.end());
+
+  size_t num_blocks = data.size() / h;
+  parallel_blocks(threads_for(data.size()), num_blocks, 1, [&](size_t begin, size_t end, uint32_t) {
+    std::vector<complex> in(h);
+    std::vector<complex> out(h);
+    for (size_t b = begin; b < end; b++) {
+      size_t z = b;
+      for (uint32_t q : sorted) {
+        z = insert_zero(z, q);
+      }
+
+      for (size_t i = 0; i < h; i++) {
+        in[i] = data[z + offsets[i]];
+      }
+
+      for (size_t r = 0; r < h; r++) {
+        complex v = 0.0;
+        for (size_t c = 0; c < h; c++) {
+          v += gate(r, c)*in[c];
+        }
+        out[r] = v;
+      }
+
+      for (size_t i = 0; i < h; i++) {
+        data[z + offsets[i]] = out[i];
+      }
+    }
+  });
+}
+
+void Statevector::evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) {
+  assert_gate_shape(gate, qubits);
+  validate_qubits(qubits);
+  for (size_t i = 0; i < qubits.size(); i++) {
+    if (qubits[i] >= num_qubits || std::count(qubits.begin(), qubits.end(), qubits[i]) > 1) {
+      throw std::invalid_argument(std::format("Invalid qubits {} for a gate on a Statevector of {} qubits.", qubits, num_qubits));
+    }
+  }
+
+  if (qubits.size() == 1) {
+    apply_one_qubit(gate, qubits[0]);
+  } else if (qubits.size() == 2) {
+    apply_two_qubit(gate, qubits[0], qubits[1]);
+  } else if (qubits.size() > 0) {
+    apply_general(gate, qubits);
+  }
+}
+
+void Statevector::evolve_diagonal(const Eigen::VectorXcd& gate, const Qubits& qubits) {
+  if (gate.size() != (static_cast<Eigen::Index>(1) << qubits.size())) {
+    throw std::invalid_argument("Invalid gate dimensions for provided qubits.");
+  }
+  validate_qubits(qubits);
+
+  std::vector<complex> d(gate.data(), gate.data() + gate.size());
+  parallel_blocks(threads_for(data.size()), data.size(), 64, [&](size_t begin, size_t end, uint32_t) {
+    statevector_kernels().diagonal(data.data(), d.data(), qubits.data(), qubits.size(), begin, end);
+  });
+}
+
+// ------------------------------------------------------------------------------------------------
+
+// P|z> = i^phase (-1)^|z & z_mask| |z ^ x_mask> for a Pauli on the given qubits of the state
+struct PauliMasks {
+  size_t x;
+  size_t z;
+  uint8_t phase;
+
+  PauliMasks(const PauliString& pauli, const Qubits& qubits) : x(0), z(0) {
+    uint32_t num_y = 0;
+    for (size_t j = 0; j < qubits.size(); j++) {
+      size_t bit = static_cast<size_t>(1) << qubits[j];
+      if (pauli.get_x(j)) {
+        x |= bit;
+      }
+      if (pauli.get_z(j)) {
+        z |= bit;
+      }
+      num_y += pauli.get_x(j) && pauli.get_z(j);
+    }
+
+    phase = (pauli.get_r() + num_y) % 4;
+  }
+
+  inline complex coefficient(size_t b) const {
+    uint8_t p = (phase + 2*(std::popcount(b & z) & 1u)) % 4;
+    return sign_from_bits(p);
+  }
+};
+
+static complex pauli_expectation(const Amplitudes& data, const PauliMasks& masks, uint32_t threads) {
+  std::vector<complex> partial(threads, 0.0);
+  parallel_blocks(threads, data.size(), 64, [&](size_t begin, size_t end, uint32_t t) {
+    complex c = 0.0;
+    for (size_t b = begin; b < end; b++) {
+      c += std::conj(data[b ^ masks.x])*masks.coefficient(b)*data[b];
+    }
+    partial[t] = c;
+  });
+
+  complex c = 0.0;
+  for (complex p : partial) {
+    c += p;
+  }
+  return c;
+}
+
+std::complex<double> Statevector::expectation(const PauliString& pauli) const {
+  if (pauli.num_qubits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a Statevector of {} qubits.", pauli.num_qubits, num_qubits));
+  }
+
+  Qubits qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return pauli_expectation(data, PauliMasks(pauli, qubits), threads_for(data.size()));
+}
+
+double Statevector::expectation(const BitString& bits, std::optional<QubitSupport> support) const {
+  if (!support) {
+    if (bits.num_bits != num_qubits) {
+      throw std::invalid_argument(std::format("Cannot evaluate a bitstring of {} bits on a Statevector of {} qubits.", bits.num_bits, num_qubits));
+    }
+    return std::norm(data[bits.to_integer()]);
+  }
+
+  Qubits qubits = to_qubits(support.value());
+  size_t target = bits.to_integer();
+  double p = 0.0;
+  for (size_t z = 0; z < data.size(); z++) {
+    if (reduce_index(z, qubits.data(), qubits.size()) == target) {
+      p += std::norm(data[z]);
+    }
+  }
+
+  return p;
+}
+
+void Statevector::apply_pauli_combination(const PauliString& pauli, const Qubits& qubits, complex a, complex b) {
+  PauliMasks masks(pauli, qubits);
+
+  if (masks.x == 0) {
+    parallel_blocks(threads_for(data.size()), data.size(), 64, [&](size_t begin, size_t end, uint32_t) {
+      for (size_t z = begin; z < end; z++) {
+        data[z] *= a + b*masks.coefficient(z);
+      }
+    });
+    return;
+  }
+
+  // Amplitudes z and w = z ^ x are paired, with z the one whose leading bit of x is clear
+  uint32_t h = std::bit_width(masks.x) - 1;
+  parallel_blocks(threads_for(data.size()), data.size() / 2, 64, [&](size_t begin, size_t end, uint32_t) {
+    for (size_t k = begin; k < end; k++) {
+      size_t z = insert_zero(k, h);
+      size_t w = z ^ masks.x;
+      complex alpha = data[z];
+      complex beta = data[w];
+      data[z] = a*alpha + b*masks.coefficient(w)*beta;
+      data[w] = a*beta + b*masks.coefficient(z)*alpha;
+    }
+  });
+}
+
+MeasurementData Statevector::measure(const Measurement& m) {
+  validate_qubits(m.qubits);
+  PauliString pauli = m.get_pauli();
+  PauliMasks masks(pauli, m.qubits);
+
+  double prob_zero = std::clamp((1.0 + pauli_expectation(data, masks, threads_for(data.size())).real())/2.0, 0.0, 1.0);
+
+  bool outcome;
+  if (m.is_forced()) {
+    outcome = m.get_outcome();
+    check_forced_measure(outcome, prob_zero);
+  } else {
+    outcome = randf() >= prob_zero;
+  }
+
+  double p = outcome ? 1.0 - prob_zero : prob_zero;
+  double c = 1.0/(2.0*std::sqrt(p));
+  apply_pauli_combination(pauli, m.qubits, c, outcome ? -c : c);
+
+  return {outcome, p};
+}
+
+MeasurementData Statevector::weak_measure(const WeakMeasurement& m) {
+  if (!m.beta) {
+    throw std::invalid_argument("Cannot perform a weak measurement with an unbound parameter.");
+  }
+  validate_qubits(m.qubits);
+
+  double beta = m.beta.value();
+  PauliString pauli = m.get_pauli();
+  PauliMasks masks(pauli, m.qubits);
+
+  double prob_zero = std::clamp((1.0 + std::tanh(2.0*beta)*pauli_expectation(data, masks, threads_for(data.size())).real())/2.0, 0.0, 1.0);
+
+  bool outcome;
+  if (m.is_forced()) {
+    outcome = m.get_outcome();
+    check_forced_measure(outcome, prob_zero);
+  } else {
+    outcome = randf() >= prob_zero;
+  }
+
+  double p = outcome ? 1.0 - prob_zero : prob_zero;
+  double c = 1.0/std::sqrt(2.0*std::cosh(2.0*beta)*p);
+  double sign = outcome ? -1.0 : 1.0;
+  apply_pauli_combination(pauli, m.qubits, c*std::cosh(beta), sign*c*std::sinh(beta));
+
+  return {outcome, p};
+}
+
+// ------------------------------------------------------------------------------------------------
+
+// The spectrum of the reduced state on the smaller side of the cut, from the 2^|A| x 2^|B| matrix of amplitudes
+double Statevector::entanglement(const QubitSupport& support, uint32_t index) const {
+  Qubits qubitsA = to_qubits(support);
+  Qubits qubitsB = to_qubits(support_complement(support, num_qubits));
+  if (qubitsA.size() > qubitsB.size()) {
+    std::swap(qubitsA, qubitsB);
+  }
+
+  if (qubitsA.empty()) {
+    return 0.0;
+  }
+
+  size_t dimA = static_cast<size_t>(1) << qubitsA.size();
+  size_t dimB = static_cast<size_t>(1) << qubitsB.size();
+  Eigen::MatrixXcd M(dimA, dimB);
+  for (size_t z = 0; z < data.size(); z++) {
+    M(reduce_index(z, qubitsA.data(), qubitsA.size()), reduce_index(z, qubitsB.data(), qubitsB.size())) = data[z];
+  }
+
+  Eigen::MatrixXcd rho = M*M.adjoint();
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> solver(rho, Eigen::EigenvaluesOnly);
+
+  std::vector<double> eigenvalues(dimA);
+  for (size_t i = 0; i < dimA; i++) {
+    eigenvalues[i] = std::max(solver.eigenvalues()(i), 0.0);
+  }
+
+  return renyi_entropy(index, eigenvalues, 2);
+}
+
+std::shared_ptr<QuantumState> Statevector::partial_trace(const Qubits& qubits) const {
+  throw not_implemented();
+}
+
+std::vector<double> Statevector::probabilities() const {
+  std::vector<double> probs(data.size());
+  parallel_blocks(threads_for(data.size()), data.size(), 64, [&](size_t begin, size_t end, uint32_t) {
+    for (size_t z = begin; z < end; z++) {
+      probs[z] = std::norm(data[z]);
+    }
+  });
+
+  return probs;
+}
+
+double Statevector::purity() const {
+  return 1.0;
+}
+
+double Statevector::norm() const {
+  double n = 0.0;
+  for (const complex& a : data) {
+    n += std::norm(a);
+  }
+  return std::sqrt(n);
+}
+
+void Statevector::normalize() {
+  double n = norm();
+  for (complex& a : data) {
+    a /= n;
+  }
+}
+
+// Paulis are drawn from the distribution <P>^2 / 2^n by a Markov chain of single site mutations
+std::vector<PauliAmplitudes> Statevector::sample_paulis(const std::vector<QubitSupport>& supports, size_t num_samples) {
+  auto prob = [](double t) { return t*t; };
+  return sample_paulis_montecarlo(supports, num_samples, 10*num_qubits, prob);
+}
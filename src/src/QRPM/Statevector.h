@@ -0,0 +1,73 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "QuantumStates.h"
+#include "BinaryMatrix.hpp"
+
+using Amplitudes = std::vector<std::complex<double>, AlignedAllocator<std::complex<double>, 64>>;
+
+// A dense state of up to ~30 qubits, with amplitude z on bit q of z for qubit q. Gates are applied in place
+// by strided kernels over the amplitudes they mix, never through embed_unitary: one and two qubit gates
+// and diagonal gates have their own kernels (scalar and AVX2/FMA, chosen at runtime), and larger gates
+// gather and scatter blocks of 2^k amplitudes. Registers of at least 2^PARALLEL_MIN_QUBITS amplitudes are
+// split into contiguous blocks across num_threads threads.
+class Statevector : public MagicQuantumState {
+  public:
+    static constexpr uint32_t PARALLEL_MIN_QUBITS = 18;
+
+    Amplitudes data;
+
+    // 0 uses every hardware thread
+    uint32_t num_threads = 0;
+
+    Statevector()=default;
+
+    // The state |0...0>
+    Statevector(uint32_t num_qubits);
+    Statevector(const Eigen::VectorXcd& vec);
+
+    // Kernels run on the scalar path or on AVX2/FMA; returns "scalar" or "avx2"
+    static std::string instruction_set();
+
+    Eigen::VectorXcd to_vector() const;
+
+    virtual std::string to_string() const override;
+
+    virtual double entanglement(const QubitSupport& support, uint32_t index) const override;
+
+    virtual std::complex<double> expectation(const PauliString& pauli) const override;
+    virtual double expectation(const BitString& bits, std::optional<QubitSupport> support=std::nullopt) const override;
+
+    // There is no dense mixed state backend to hold the result
+    virtual std::shared_ptr<QuantumState> partial_trace(const Qubits& qubits) const override;
+
+    virtual void evolve(const Eigen::MatrixXcd& gate, const Qubits& qubits) override;
+    virtual void evolve_diagonal(const Eigen::VectorXcd& gate, const Qubits& qubits) override;
+    using QuantumState::evolve;
+    using QuantumState::evolve_diagonal;
+
+    // Projective measurement onto the eigenspaces of the Pauli, applied pairwise to the amplitudes |z> and
+    // P|z> in place. Weak measurements apply the Kraus operators exp(+-beta P)/sqrt(2 cosh(2 beta)).
+    virtual MeasurementData measure(const Measurement& m) override;
+    virtual MeasurementData weak_measure(const WeakMeasurement& m) override;
+
+    virtual std::vector<double> probabilities() const override;
+    virtual double purity() const override;
+
+    virtual std::vector<PauliAmplitudes> sample_paulis(const std::vector<QubitSupport>& supports, size_t num_samples) override;
+
+    double norm() const;
+    void normalize();
+
+  private:
+    uint32_t threads_for(size_t num_amplitudes) const;
+
+    void apply_one_qubit(const Eigen::Matrix2cd& gate, uint32_t q);
+    void apply_two_qubit(const Eigen::Matrix4cd& gate, uint32_t q0, uint32_t q1);
+    void apply_general(const Eigen::MatrixXcd& gate, const Qubits& qubits);
+
+    // Pairs each amplitude z with P|z> and replaces the pair by (a + b P) acting on it
+    void apply_pauli_combination(const PauliString& pauli, const Qubits& qubits, std::complex<double> a, std::complex<double> b);
+};
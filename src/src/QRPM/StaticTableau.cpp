@@ -0,0 +1,725 @@
+#include "StaticTableau.h"
+#include "BinaryMatrix.hpp"
+
+#include <bit>
+
+constexpr size_t WORD_SIZE = binary_word_size();
+
+template <uint32_t N>
+StaticTableau<N>::StaticTableau(uint32_t num_qubits) : TableauBase(num_qubits), columns{}, phase{} {
+  if (num_qubits > N) {
+    throw std::invalid_argument(std::format("Cannot create a {}-qubit StaticTableau with room for {} qubits.", num_qubits, N));
+  }
+
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    set(i, 2*i, true);
+    set(i + num_qubits, 2*i+1, true);
+  }
+}
+
+template <uint32_t N>
+std::unique_ptr<TableauBase> StaticTableau<N>::clone() const {
+  return std::make_unique<StaticTableau<N>>(*this);
+}
+
+// Only the columns in use are written, so a snapshot does not depend on N
+template <uint32_t N>
+void StaticTableau<N>::write_snapshot(SnapshotWriter& writer) const {
+  writer.write_array(std::span<const binary_word>(columns[0].data(), 2*num_qubits*WORDS));
+  writer.write_array(phase);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::read_snapshot(SnapshotReader& reader) {
+  columns = {};
+  reader.read_into(std::span<binary_word>(columns[0].data(), 2*num_qubits*WORDS));
+  reader.read_into(std::span<binary_word>(phase));
+}
+
+// Index of the first set bit of a bit vector in [begin, end), or end if there is none
+template <size_t W>
+static size_t find_set_bit(const std::array<binary_word, W>& bits, size_t begin, size_t end) {
+  for (size_t w = begin / WORD_SIZE; w*WORD_SIZE < end; w++) {
+    binary_word word = bits[w];
+    if (w == begin / WORD_SIZE) {
+      word &= ~static_cast<binary_word>(0) << (begin % WORD_SIZE);
+    }
+
+    if (word) {
+      return std::min(w*WORD_SIZE + std::countr_zero(word), end);
+    }
+  }
+
+  return end;
+}
+
+// The bit vector with bits [begin, end) set
+template <size_t W>
+static std::array<binary_word, W> range_mask(size_t begin, size_t end) {
+  std::array<binary_word, W> mask{};
+  for (size_t i = begin; i < end; i++) {
+    mask[i / WORD_SIZE] |= static_cast<binary_word>(1) << (i % WORD_SIZE);
+  }
+  return mask;
+}
+
+template <size_t W>
+static void swap_bits(std::array<binary_word, W>& v, size_t i, size_t j) {
+  binary_word t = ((v[i / WORD_SIZE] >> (i % WORD_SIZE)) ^ (v[j / WORD_SIZE] >> (j % WORD_SIZE))) & 1u;
+  v[i / WORD_SIZE] ^= t << (i % WORD_SIZE);
+  v[j / WORD_SIZE] ^= t << (j % WORD_SIZE);
+}
+
+// Parity of the bits of v at or below each position
+static binary_word prefix_parity(binary_word v) {
+  for (size_t k = 1; k < WORD_SIZE; k <<= 1) {
+    v ^= v << k;
+  }
+  return v;
+}
+
+// Reduces v against a basis of words indexed by their leading bit; returns whether v was independent and added
+static bool insert_into_basis(std::array<binary_word, WORD_SIZE>& basis, binary_word v) {
+  while (v) {
+    size_t b = std::bit_width(v) - 1;
+    if (!basis[b]) {
+      basis[b] = v;
+      return true;
+    }
+    v ^= basis[b];
+  }
+
+  return false;
+}
+
+template <uint32_t N>
+void StaticTableau<N>::reset(size_t i) {
+  binary_word mask = ~(static_cast<binary_word>(1) << (i % WORD_SIZE));
+  for (size_t c = 0; c < 2*num_qubits; c++) {
+    columns[c][i / WORD_SIZE] &= mask;
+  }
+  phase[i / WORD_SIZE] &= mask;
+}
+
+template <uint32_t N>
+void StaticTableau<N>::swap(size_t i, size_t j) {
+  size_t wi = i / WORD_SIZE;
+  size_t wj = j / WORD_SIZE;
+  size_t bi = i % WORD_SIZE;
+  size_t bj = j % WORD_SIZE;
+  for (size_t c = 0; c < 2*num_qubits; c++) {
+    binary_word t = ((columns[c][wi] >> bi) ^ (columns[c][wj] >> bj)) & 1u;
+    columns[c][wi] ^= t << bi;
+    columns[c][wj] ^= t << bj;
+  }
+  swap_bits(phase, i, j);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::move_row(size_t i, size_t j) {
+  size_t wi = i / WORD_SIZE;
+  size_t wj = j / WORD_SIZE;
+  size_t bi = i % WORD_SIZE;
+  size_t bj = j % WORD_SIZE;
+  auto move_bit = [&](Bits& v) {
+    binary_word t = (v[wi] >> bi) & 1u;
+    v[wi] &= ~(static_cast<binary_word>(1) << bi);
+    v[wj] = (v[wj] & ~(static_cast<binary_word>(1) << bj)) | (t << bj);
+  };
+
+  for (size_t c = 0; c < 2*num_qubits; c++) {
+    move_bit(columns[c]);
+  }
+  move_bit(phase);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::rowsum(size_t i, size_t j) {
+  // The phase g of each qubit, indexed by the Paulis of row j and row i as xz bits
+  constexpr int8_t g[16] = {0, 0, 0, 0, 0, 0, 1, -1, 0, -1, 0, 1, 0, 1, -1, 0};
+
+  size_t wi = i / WORD_SIZE;
+  size_t wj = j / WORD_SIZE;
+  size_t bi = i % WORD_SIZE;
+  size_t bj = j % WORD_SIZE;
+  int s = 2*get_phase_bit(i) + 2*get_phase_bit(j);
+  for (size_t q = 0; q < num_qubits; q++) {
+    binary_word x1 = (columns[2*q][wj] >> bj) & 1u;
+    binary_word z1 = (columns[2*q + 1][wj] >> bj) & 1u;
+    binary_word x2 = (columns[2*q][wi] >> bi) & 1u;
+    binary_word z2 = (columns[2*q + 1][wi] >> bi) & 1u;
+    s += g[x1 | (z1 << 1u) | (x2 << 2u) | (z2 << 3u)];
+    columns[2*q][wi] ^= x1 << bi;
+    columns[2*q + 1][wi] ^= z1 << bi;
+  }
+
+  set_phase_bit(i, (s % 4 + 4) % 4 == 2);
+}
+
+// For every target row, s = 2 r_i + 2 r_j + sum_q g_q is counted mod 4 in the bit planes (lo, hi), with g_q
+// from phase_counts on the broadcast bits of row j and the columns of qubit q.
+template <uint32_t N>
+void StaticTableau<N>::rowsum(const Bits& targets, size_t j) {
+  Bits lo{};
+  Bits hi{};
+  binary_word rj = -static_cast<binary_word>(get_phase_bit(j));
+  for (size_t w = 0; w < WORDS; w++) {
+    hi[w] = (phase[w] ^ rj) & targets[w];
+  }
+
+  for (size_t q = 0; q < num_qubits; q++) {
+    uint8_t src = get(j, 2*q) | (get(j, 2*q + 1) << 1u);
+    if (!src) {
+      continue;
+    }
+
+    // With a fixed source Pauli, phase_counts reduces to two products of the target bits
+    Bits& x2 = columns[2*q];
+    Bits& z2 = columns[2*q + 1];
+    for (size_t w = 0; w < WORDS; w++) {
+      binary_word plus, minus;
+      if (src == 1) {
+        plus = x2[w] & z2[w];
+        minus = ~x2[w] & z2[w];
+      } else if (src == 2) {
+        plus = x2[w] & ~z2[w];
+        minus = x2[w] & z2[w];
+      } else {
+        plus = ~x2[w] & z2[w];
+        minus = x2[w] & ~z2[w];
+      }
+      plus &= targets[w];
+      minus &= targets[w];
+
+      hi[w] ^= lo[w] & plus;
+      lo[w] ^= plus;
+      lo[w] ^= minus;
+      hi[w] ^= lo[w] & minus;
+
+      x2[w] ^= targets[w] & -static_cast<binary_word>(src & 1u);
+      z2[w] ^= targets[w] & -static_cast<binary_word>(src >> 1u);
+    }
+  }
+
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] = (phase[w] & ~targets[w]) | (hi[w] & ~lo[w] & targets[w]);
+  }
+}
+
+// Writing each row as (-1)^r i^{x.z} X^x Z^z, moving every X of the ordered product to the left picks up a sign
+// (-1) for each pair of a z before an x on the same qubit, and i^{-X.Z} turns X^X Z^Z back into a Pauli. So
+// qubit by qubit, s = sum_m x_m z_m + 2 sum_{m < l} z_m x_l - X Z, which is counted on the columns.
+template <uint32_t N>
+int StaticTableau<N>::product_phase(const Bits& rows) const {
+  int s = 0;
+  for (size_t w = 0; w < WORDS; w++) {
+    s += 2*std::popcount(phase[w] & rows[w]);
+  }
+
+  for (size_t q = 0; q < num_qubits; q++) {
+    binary_word z_before = 0;
+    binary_word x_total = 0;
+    binary_word z_total = 0;
+    for (size_t w = 0; w < WORDS; w++) {
+      binary_word x = columns[2*q][w] & rows[w];
+      binary_word z = columns[2*q + 1][w] & rows[w];
+      s += std::popcount(x & z) + 2*std::popcount(x & ((prefix_parity(z) << 1) ^ z_before));
+      z_before ^= -static_cast<binary_word>(std::popcount(z) & 1);
+      x_total ^= x;
+      z_total ^= z;
+    }
+    s -= (std::popcount(x_total) & std::popcount(z_total)) & 1;
+  }
+
+  return s;
+}
+
+// The stabilizer rows paired with the destabilizers marked in [0, n)
+template <uint32_t N>
+typename StaticTableau<N>::Bits StaticTableau<N>::paired_stabilizers(const Bits& destabilizers) const {
+  Bits stabilizers{};
+  for (size_t i = find_set_bit(destabilizers, 0, num_qubits); i < num_qubits; i = find_set_bit(destabilizers, i + 1, num_qubits)) {
+    stabilizers[(i + num_qubits) / WORD_SIZE] |= static_cast<binary_word>(1) << ((i + num_qubits) % WORD_SIZE);
+  }
+  return stabilizers;
+}
+
+template <uint32_t N>
+Pauli StaticTableau<N>::get_pauli(size_t i, size_t j) const {
+  return static_cast<Pauli>(get(i + num_qubits, 2*j) | (get(i + num_qubits, 2*j + 1) << 1u));
+}
+
+template <uint32_t N>
+PauliString StaticTableau<N>::get_stabilizer(size_t i) const {
+  PauliString p(num_qubits);
+  for (size_t q = 0; q < num_qubits; q++) {
+    p.set_x(q, get(i + num_qubits, 2*q));
+    p.set_z(q, get(i + num_qubits, 2*q + 1));
+  }
+  p.set_r(2*get_phase_bit(i + num_qubits));
+  return p;
+}
+
+template <uint32_t N>
+PauliString StaticTableau<N>::get_destabilizer(size_t i) const {
+  PauliString p(num_qubits);
+  for (size_t q = 0; q < num_qubits; q++) {
+    p.set_x(q, get(i, 2*q));
+    p.set_z(q, get(i, 2*q + 1));
+  }
+  p.set_r(2*get_phase_bit(i));
+  return p;
+}
+
+template <uint32_t N>
+uint8_t StaticTableau<N>::get_phase(size_t i) const {
+  return 2*get_phase_bit(i + num_qubits);
+}
+
+// The stabilizers carrying the pivot column are eliminated with a single bitsliced rowsum. The destabilizer of
+// the pivot then absorbs their destabilizers one at a time, in the same order as TableauSIMD::rref.
+template <uint32_t N>
+void StaticTableau<N>::rref_impl(const Qubits& sites, bool x_only) {
+  const Bits stabilizer_rows = range_mask<WORDS>(num_qubits, 2*num_qubits);
+  uint32_t row = num_qubits;
+
+  for (uint32_t k = 0; k < 2*sites.size(); k++) {
+    uint32_t c = sites[k % sites.size()];
+    bool z = k < sites.size();
+    if (z && x_only) {
+      continue;
+    }
+
+    size_t j = z ? 2*c+1 : 2*c;
+    size_t pivot_row = find_set_bit(columns[j], row, 2*num_qubits);
+    if (pivot_row == 2*num_qubits) {
+      continue;
+    }
+
+    swap(row, pivot_row);
+    swap(row - num_qubits, pivot_row - num_qubits);
+
+    Bits carriers = columns[j];
+    for (size_t w = 0; w < WORDS; w++) {
+      carriers[w] &= stabilizer_rows[w];
+    }
+    carriers[row / WORD_SIZE] &= ~(static_cast<binary_word>(1) << (row % WORD_SIZE));
+
+    rowsum(carriers, row);
+    for (size_t i = find_set_bit(carriers, 0, 2*num_qubits); i < 2*num_qubits; i = find_set_bit(carriers, i + 1, 2*num_qubits)) {
+      rowsum(row - num_qubits, i - num_qubits);
+    }
+
+    row += 1;
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::rref(const Qubits& sites) {
+  rref_impl(sites, false);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::xrref(const Qubits& sites) {
+  rref_impl(sites, true);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::rref() {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  rref(qubits);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::xrref() {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  xrref(qubits);
+}
+
+// The rank of the stabilizers restricted to sites is the rank of the corresponding columns
+template <uint32_t N>
+uint32_t StaticTableau<N>::restricted_rank(const Qubits& sites, bool x_only) const {
+  std::array<binary_word, WORD_SIZE> basis{};
+  uint32_t r = 0;
+  for (uint32_t q : sites) {
+    for (size_t c = 2*q; c < 2*q + (x_only ? 1 : 2); c++) {
+      binary_word v = 0;
+      copy_bits(columns[c].data(), WORDS, num_qubits, num_qubits, &v);
+      r += insert_into_basis(basis, v);
+    }
+  }
+
+  return r;
+}
+
+template <uint32_t N>
+uint32_t StaticTableau<N>::rank(const Qubits& sites) const {
+  return restricted_rank(sites, false);
+}
+
+template <uint32_t N>
+uint32_t StaticTableau<N>::xrank(const Qubits& sites) const {
+  return restricted_rank(sites, true);
+}
+
+template <uint32_t N>
+uint32_t StaticTableau<N>::rank() const {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return rank(qubits);
+}
+
+template <uint32_t N>
+uint32_t StaticTableau<N>::xrank() const {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return xrank(qubits);
+}
+
+// The pivot columns of the row echelon form are the columns which are independent of the ones before them
+template <uint32_t N>
+std::vector<uint32_t> StaticTableau<N>::endpoint_counts() const {
+  std::array<binary_word, WORD_SIZE> basis{};
+  std::vector<uint32_t> counts(num_qubits);
+  for (size_t c = 0; c < 2*num_qubits; c++) {
+    binary_word v = 0;
+    copy_bits(columns[c].data(), WORDS, num_qubits, num_qubits, &v);
+    if (insert_into_basis(basis, v)) {
+      counts[c / 2]++;
+    }
+  }
+  return counts;
+}
+
+template <uint32_t N>
+double StaticTableau<N>::bitstring_amplitude(const BitString& bits) {
+  if (bits.num_bits != num_qubits) {
+    throw std::runtime_error(std::format("Cannot evaluate a bitstring of {} bits on a StaticTableau of {} qubits.", bits.num_bits, num_qubits));
+  }
+
+  xrref();
+  double p = 1/std::pow(2.0, xrank());
+
+  // Every z-only stabilizer g must act on |z> as g|z> = |z>, i.e. the parity of z on its support is its sign
+  Bits has_x{};
+  Bits parity{};
+  for (size_t q = 0; q < num_qubits; q++) {
+    bool zq = bits.get(q);
+    for (size_t w = 0; w < WORDS; w++) {
+      has_x[w] |= columns[2*q][w];
+      parity[w] ^= columns[2*q + 1][w] & -static_cast<binary_word>(zq);
+    }
+  }
+
+  const Bits stabilizer_rows = range_mask<WORDS>(num_qubits, 2*num_qubits);
+  for (size_t w = 0; w < WORDS; w++) {
+    if (stabilizer_rows[w] & ~has_x[w] & (parity[w] ^ phase[w])) {
+      return 0.0;
+    }
+  }
+
+  return p;
+}
+
+// The rows which anticommute with the Pauli are the sum of the z columns at its x sites and the x columns at
+// its z sites. It vanishes if any stabilizer is among them; otherwise it is, up to sign, the product of the
+// stabilizers paired with the destabilizers among them.
+template <uint32_t N>
+std::complex<double> StaticTableau<N>::expectation(const PauliString& pauli) const {
+  if (pauli.num_qubits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a StaticTableau of {} qubits.", pauli.num_qubits, num_qubits));
+  }
+
+  Bits anticommuting{};
+  for (size_t q = 0; q < num_qubits; q++) {
+    uint8_t xz = pauli.get_xz(q);
+    binary_word xq = -static_cast<binary_word>(xz & 1u);
+    binary_word zq = -static_cast<binary_word>((xz >> 1u) & 1u);
+    for (size_t w = 0; w < WORDS; w++) {
+      anticommuting[w] ^= (columns[2*q + 1][w] & xq) ^ (columns[2*q][w] & zq);
+    }
+  }
+
+  if (find_set_bit(anticommuting, num_qubits, 2*num_qubits) < 2*num_qubits) {
+    return 0.0;
+  }
+
+  int s = product_phase(paired_stabilizers(anticommuting));
+
+  // The product of the stabilizers is i^s times the Pauli operators of pauli, and is +1 on the state
+  return sign_from_bits(((pauli.get_r() - s) % 4 + 4) % 4);
+}
+
+template <uint32_t N>
+std::string StaticTableau<N>::to_string(bool print_destabilizers) const {
+  auto row_to_string = [&](size_t r) {
+    std::string s = get_phase_bit(r) ? "-" : "+";
+    for (size_t j = 0; j < 2*num_qubits; j++) {
+      s += std::format("{}", get(r, j));
+    }
+    return s;
+  };
+
+  std::string s = "";
+  if (print_destabilizers) {
+    for (size_t i = 0; i < num_qubits; i++) {
+      s += (i == 0) ? "[" : " ";
+      s += row_to_string(i);
+      s += (i == num_qubits - 1) ? "]" : "\n";
+    }
+    s += "\n";
+  }
+
+  for (size_t i = num_qubits; i < 2*num_qubits; i++) {
+    s += (i == 0) ? "[" : " ";
+    s += row_to_string(i);
+    s += (i == num_qubits - 1) ? "]" : "\n";
+  }
+
+  return s;
+}
+
+template <uint32_t N>
+std::string StaticTableau<N>::to_string_ops(bool print_destabilizers) const {
+  auto row_to_string = [&](size_t r) {
+    std::string s = get_phase_bit(r) ? "-" : "+";
+    for (size_t j = 0; j < num_qubits; j++) {
+      s += pauli_to_char(static_cast<Pauli>(get(r, 2*j) | (get(r, 2*j + 1) << 1u)));
+    }
+    return s;
+  };
+
+  std::string s = "";
+  if (print_destabilizers) {
+    for (size_t i = 0; i < num_qubits; i++) {
+      s += (i == 0) ? "[" : " ";
+      s += row_to_string(i);
+      s += (i == num_qubits - 1) ? "]" : "\n";
+    }
+    s += "\n";
+  }
+
+  for (size_t i = num_qubits; i < 2*num_qubits; i++) {
+    s += (i == num_qubits) ? "[" : " ";
+    s += row_to_string(i);
+    s += (i == 2*num_qubits - 1) ? "]" : "\n";
+  }
+  return s;
+}
+
+template <uint32_t N>
+void StaticTableau<N>::h(uint32_t a) {
+  validate_qubit(a);
+  Bits& x = columns[2*a];
+  Bits& z = columns[2*a + 1];
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= x[w] & z[w];
+    std::swap(x[w], z[w]);
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::s(uint32_t a) {
+  validate_qubit(a);
+  const Bits& x = columns[2*a];
+  Bits& z = columns[2*a + 1];
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= x[w] & z[w];
+    z[w] ^= x[w];
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::sd(uint32_t a) {
+  validate_qubit(a);
+  const Bits& x = columns[2*a];
+  Bits& z = columns[2*a + 1];
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= x[w] & ~z[w];
+    z[w] ^= x[w];
+  }
+}
+
+// Conjugation by a Pauli only flips the phases of the rows which anticommute with it
+template <uint32_t N>
+void StaticTableau<N>::x(uint32_t a) {
+  validate_qubit(a);
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= columns[2*a + 1][w];
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::y(uint32_t a) {
+  validate_qubit(a);
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= columns[2*a][w] ^ columns[2*a + 1][w];
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::z(uint32_t a) {
+  validate_qubit(a);
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= columns[2*a][w];
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::cx(uint32_t a, uint32_t b) {
+  validate_qubit(a);
+  validate_qubit(b);
+  Bits& xa = columns[2*a];
+  Bits& za = columns[2*a + 1];
+  Bits& xb = columns[2*b];
+  Bits& zb = columns[2*b + 1];
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= xa[w] & zb[w] & ~(xb[w] ^ za[w]);
+    xb[w] ^= xa[w];
+    za[w] ^= zb[w];
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::cz(uint32_t a, uint32_t b) {
+  validate_qubit(a);
+  validate_qubit(b);
+  Bits& xa = columns[2*a];
+  Bits& za = columns[2*a + 1];
+  Bits& xb = columns[2*b];
+  Bits& zb = columns[2*b + 1];
+  for (size_t w = 0; w < WORDS; w++) {
+    phase[w] ^= xa[w] & xb[w] & (za[w] ^ zb[w]);
+    za[w] ^= xb[w];
+    zb[w] ^= xa[w];
+  }
+}
+
+// Evaluates an op bitsliced on its (xa, za, xb, zb) columns from its algebraic normal form. The number of
+// inputs is a template parameter so that the monomials and coefficient masks are unrolled without branches.
+template <size_t num_inputs, size_t W>
+static void apply_anf(const std::array<uint8_t, 16>& anf, std::array<binary_word, W>* const* in, std::array<binary_word, W>& phase) {
+  constexpr size_t num_monomials = 1u << num_inputs;
+
+  for (size_t w = 0; w < W; w++) {
+    binary_word monomials[num_monomials];
+    monomials[0] = ~static_cast<binary_word>(0);
+    for (size_t m = 1; m < num_monomials; m++) {
+      size_t j = std::bit_width(m) - 1;
+      monomials[m] = monomials[m ^ (1u << j)] & (*in[j])[w];
+    }
+
+    // Output k is accumulated in a register over the monomials; the sign is output bit 4
+    binary_word out[num_inputs + 1];
+    for (size_t k = 0; k <= num_inputs; k++) {
+      size_t bit = k < num_inputs ? k : 4;
+      binary_word acc = 0;
+      for (size_t m = 0; m < num_monomials; m++) {
+        acc ^= monomials[m] & -static_cast<binary_word>((anf[m] >> bit) & 1u);
+      }
+      out[k] = acc;
+    }
+
+    for (size_t k = 0; k < num_inputs; k++) {
+      (*in[k])[w] = out[k];
+    }
+    phase[w] ^= out[num_inputs];
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::apply_layer(std::span<const CliffordOp> ops) {
+  for (const CliffordOp& op : ops) {
+    validate_qubit(op.qubits[0]);
+    validate_qubit(op.qubits[1]);
+  }
+
+  for (const CliffordOp& op : ops) {
+    Bits* in[4] = {&columns[2*op.qubits[0]], &columns[2*op.qubits[0] + 1], &columns[2*op.qubits[1]], &columns[2*op.qubits[1] + 1]};
+    if (op.num_qubits == 2) {
+      apply_anf<4>(op.anf(), in, phase);
+    } else {
+      apply_anf<2>(op.anf(), in, phase);
+    }
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::apply_clifford(const CliffordOp& op) {
+  apply_layer(std::span(&op, 1));
+}
+
+template <uint32_t N>
+std::pair<bool, uint32_t> StaticTableau<N>::mzr_deterministic(uint32_t a) const {
+  // Suitable p identified; outcome is random
+  size_t p = find_set_bit(columns[2*a], num_qubits, 2*num_qubits);
+  if (p < 2*num_qubits) {
+    return std::pair(false, p);
+  }
+
+  // No p found; outcome is deterministic
+  return std::pair(true, 0);
+}
+
+template <uint32_t N>
+MeasurementData StaticTableau<N>::mzr(uint32_t a, std::optional<bool> outcome) {
+  validate_qubit(a);
+
+  // Rows with an x on qubit a; every one of them other than p is multiplied by p at once
+  Bits x = columns[2*a];
+  size_t p = find_set_bit(x, num_qubits, 2*num_qubits);
+  bool deterministic = p == 2*num_qubits;
+
+  if (!deterministic) {
+    bool b = outcome ? outcome.value() : randi() % 2;
+
+    x[p / WORD_SIZE] &= ~(static_cast<binary_word>(1) << (p % WORD_SIZE));
+    rowsum(x, p);
+
+    // swap(p, p - n) followed by reset(p): row p moves to p - n and is cleared
+    move_row(p, p - num_qubits);
+    set_phase_bit(p, b);
+    set(p, 2*a+1, true);
+
+    return {b, 0.5};
+  } else { // deterministic
+    // The product of the stabilizers paired with the destabilizers with an x on qubit a is +-Z_a
+    int s = product_phase(paired_stabilizers(x));
+    bool b = (s % 4 + 4) % 4 == 2;
+
+    if (outcome) {
+      if (b != outcome.value()) {
+        throw std::runtime_error("Invalid forced measurement of QuantumCHPState.");
+      }
+    }
+
+    return {b, 1.0};
+  }
+}
+
+template <uint32_t N>
+void StaticTableau<N>::stabilizer_rowsum(uint32_t i, uint32_t j) {
+  rowsum(i + num_qubits, j + num_qubits);
+  rowsum(j, i);
+}
+
+template <uint32_t N>
+void StaticTableau<N>::stabilizer_swap(uint32_t i, uint32_t j) {
+  swap(i + num_qubits, j + num_qubits);
+  swap(i, j);
+}
+
+template class StaticTableau<32>;
+template class StaticTableau<64>;
+
+std::unique_ptr<TableauBase> make_static_tableau(uint32_t num_qubits) {
+  if (num_qubits <= 32) {
+    return std::make_unique<StaticTableau<32>>(num_qubits);
+  } else if (num_qubits <= 64) {
+    return std::make_unique<StaticTableau<64>>(num_qubits);
+  } else {
+    throw std::invalid_argument(std::format("Cannot create a StaticTableau of {} > {} qubits.", num_qubits, STATIC_TABLEAU_MAX_QUBITS));
+  }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "Tableau.h"
+
+// A tableau of at most N qubits whose storage is fixed at compile time. It is kept qubit-major: columns[2q]
+// and columns[2q + 1] hold the x and z bits of qubit q over the rows [0, 2n) (destabilizers, then stabilizers),
+// packed into WORDS = 2N/64 words, and phase holds the sign bits in the same way. Since every column of a
+// tableau of up to 64 qubits fits in one or two words, a gate is a handful of word operations, independent of
+// n, and a layer of CliffordOps is evaluated bitsliced. Rowsums are bitsliced over the rows as well: the
+// rowsums of a measurement all share their source row, so they are applied at once, with the phases counted
+// mod 4 in two bit planes. Loops over the words of a column have compile-time bounds and are unrolled.
+//
+// The class is final, so calls between its own methods are not virtual. It is instantiated for N = 32 and
+// N = 64; make_static_tableau picks the smaller one that fits.
+template <uint32_t N>
+class StaticTableau final : public TableauBase {
+  public:
+    static constexpr size_t WORDS = (2*N + binary_word_size() - 1) / binary_word_size();
+
+    // A bit vector over the rows, or a row of interleaved (x, z) bits over the qubits
+    using Bits = std::array<binary_word, WORDS>;
+
+    std::array<Bits, 2*N> columns;
+    Bits phase;
+
+    StaticTableau()=default;
+    StaticTableau(uint32_t num_qubits);
+
+    inline bool get(size_t i, size_t j) const {
+      return (columns[j][i / binary_word_size()] >> (i % binary_word_size())) & 1u;
+    }
+
+    inline void set(size_t i, size_t j, binary_word v) {
+      binary_word& word = columns[j][i / binary_word_size()];
+      size_t bit_ind = i % binary_word_size();
+      word = (word & ~(static_cast<binary_word>(1) << bit_ind)) | (v << bit_ind);
+    }
+
+    inline bool get_phase_bit(size_t i) const {
+      return (phase[i / binary_word_size()] >> (i % binary_word_size())) & 1u;
+    }
+
+    inline void set_phase_bit(size_t i, bool v) {
+      binary_word& word = phase[i / binary_word_size()];
+      size_t bit_ind = i % binary_word_size();
+      word = (word & ~(static_cast<binary_word>(1) << bit_ind)) | (static_cast<binary_word>(v) << bit_ind);
+    }
+
+    void reset(size_t i);
+    void swap(size_t i, size_t j);
+
+    // Overwrites row j with row i and clears row i
+    void move_row(size_t i, size_t j);
+
+    // Multiplies row j into row i, as in TableauSIMD::rowsum, or into every row marked in targets at once
+    void rowsum(size_t i, size_t j);
+    void rowsum(const Bits& targets, size_t j);
+
+    virtual std::unique_ptr<TableauBase> clone() const override;
+    virtual void write_snapshot(SnapshotWriter& writer) const override;
+    virtual void read_snapshot(SnapshotReader& reader) override;
+
+    virtual Pauli get_pauli(size_t i, size_t j) const override;
+    virtual PauliString get_stabilizer(size_t i) const override;
+    virtual PauliString get_destabilizer(size_t i) const override;
+    virtual uint8_t get_phase(size_t i) const override;
+
+    // Put tableau into reduced row echelon form
+    virtual void rref(const Qubits& sites) override;
+    virtual void rref() override;
+    virtual void xrref(const Qubits& sites) override;
+    virtual void xrref() override;
+
+    // The restriction of a column to the stabilizers is a single word, so ranks are found by inserting the
+    // columns into a basis of words on the stack
+    virtual uint32_t rank(const Qubits& sites) const override;
+    virtual uint32_t rank() const override;
+    virtual uint32_t xrank(const Qubits& sites) const override;
+    virtual uint32_t xrank() const override;
+    virtual std::vector<uint32_t> endpoint_counts() const override;
+
+    virtual double bitstring_amplitude(const BitString& bits) override;
+
+    virtual std::complex<double> expectation(const PauliString& pauli) const override;
+    using TableauBase::expectation;
+
+    virtual std::string to_string(bool print_destabilizers=true) const override;
+    virtual std::string to_string_ops(bool print_destabilizers=true) const override;
+
+    virtual void h(uint32_t a) override;
+    virtual void s(uint32_t a) override;
+    virtual void sd(uint32_t a) override;
+    virtual void x(uint32_t a) override;
+    virtual void y(uint32_t a) override;
+    virtual void z(uint32_t a) override;
+    virtual void cx(uint32_t a, uint32_t b) override;
+    virtual void cz(uint32_t a, uint32_t b) override;
+    virtual void apply_layer(std::span<const CliffordOp> ops) override;
+    virtual void apply_clifford(const CliffordOp& op) override;
+
+    // Returns a pair containing (1) wether the outcome of a measurement on qubit a is deterministic
+    // and (2) the index on which the CHP algorithm performs rowsum if the mzr is random
+    virtual std::pair<bool, uint32_t> mzr_deterministic(uint32_t a) const override;
+
+    virtual MeasurementData mzr(uint32_t a, std::optional<bool> outcome=std::nullopt) override;
+
+    virtual void stabilizer_rowsum(uint32_t i, uint32_t j) override;
+    virtual void stabilizer_swap(uint32_t i, uint32_t j) override;
+
+  private:
+    void rref_impl(const Qubits& sites, bool x_only);
+    uint32_t restricted_rank(const Qubits& sites, bool x_only) const;
+
+    // The exponent s with prod_{i in rows} R_i = i^s P, the rows taken in order and P the product without
+    // phases, for rows which commute
+    int product_phase(const Bits& rows) const;
+    Bits paired_stabilizers(const Bits& destabilizers) const;
+};
+
+extern template class StaticTableau<32>;
+extern template class StaticTableau<64>;
+
+constexpr uint32_t STATIC_TABLEAU_MAX_QUBITS = 64;
+
+// The smallest StaticTableau which holds num_qubits <= STATIC_TABLEAU_MAX_QUBITS qubits
+std::unique_ptr<TableauBase> make_static_tableau(uint32_t num_qubits);
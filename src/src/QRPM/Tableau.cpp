@@ -1,5 +1,10 @@
 #include "Tableau.h"
+#include "BinaryMatrix.hpp"
 #include <stdexcept>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <bit>
 
 void TableauBase::sd(uint32_t a) {
   s(a);
@@ -34,6 +39,16 @@ void TableauBase::cz(uint32_t a, uint32_t b) {
   h(b);
 }
 
+void TableauBase::apply_clifford(const CliffordOp& op) {
+  apply_layer(std::span(&op, 1));
+}
+
+void TableauBase::execute(std::span<const CompiledOp> ops) {
+  for (const CompiledOp& op : ops) {
+    apply_compiled_gate(*this, op);
+  }
+}
+
 PauliString TableauBase::get_stabilizer(size_t i) const {
   std::vector<Pauli> paulis(num_qubits);
   for (size_t j = 0; j < num_qubits; j++) {
@@ -43,6 +58,302 @@ PauliString TableauBase::get_stabilizer(size_t i) const {
   return PauliString(paulis, phase);
 }
 
+std::complex<double> TableauBase::expectation(const PauliString& pauli) const {
+  if (pauli.num_qubits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a tableau of {} qubits.", pauli.num_qubits, num_qubits));
+  }
+
+  PauliString product(num_qubits);
+  for (size_t i = 0; i < num_qubits; i++) {
+    PauliString stabilizer = get_stabilizer(i);
+    if (!pauli.commutes(stabilizer)) {
+      return 0.0;
+    }
+
+    if (!pauli.commutes(get_destabilizer(i))) {
+      product = product * stabilizer;
+    }
+  }
+
+  // The product is +1 on the state and carries the same Pauli operators as pauli
+  return sign_from_bits((pauli.get_r() + 4 - product.get_r()) % 4);
+}
+
+std::complex<double> TableauBase::expectation(const SparsePauliObs& obs) const {
+  std::complex<double> c = 0.0;
+  for (const auto& [a, P] : obs) {
+    c += a*expectation(P);
+  }
+
+  return c;
+}
+
+StabilizerSampler::StabilizerSampler(const TableauBase& tableau) : num_qubits(tableau.num_qubits), offset(tableau.num_qubits), basis(tableau.num_qubits, tableau.num_qubits) {
+  // Measuring every qubit of a copy, choosing 0 whenever the outcome is random, gives a point of the support
+  // without consuming random numbers
+  std::unique_ptr<TableauBase> copy = tableau.clone();
+  for (uint32_t a = 0; a < num_qubits; a++) {
+    auto [deterministic, _] = copy->mzr_deterministic(a);
+    auto [outcome, p] = copy->mzr(a, deterministic ? std::nullopt : std::optional<bool>(false));
+    offset.set(a, outcome);
+  }
+
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    for (uint32_t j = 0; j < num_qubits; j++) {
+      if (tableau.get_pauli(i, j) & 0b01) {
+        basis.set(i, j, 1);
+      }
+    }
+  }
+
+  pivots = basis.pivots();
+}
+
+double StabilizerSampler::probability() const {
+  return std::pow(2.0, -static_cast<double>(rank()));
+}
+
+// bits is in the support if bits + z0 reduces to zero against the basis. The basis is in row echelon form,
+// so a single pass over its rows in order suffices.
+double StabilizerSampler::probability(const BitString& bits) const {
+  if (bits.num_bits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a bitstring of {} bits on a state of {} qubits.", bits.num_bits, num_qubits));
+  }
+
+  thread_local std::vector<binary_word> v;
+  v.resize(offset.bits.size());
+  for (size_t w = 0; w < v.size(); w++) {
+    v[w] = bits.bits[w] ^ offset.bits[w];
+  }
+
+  constexpr size_t word_size = binary_word_size();
+  for (size_t r = 0; r < rank(); r++) {
+    uint32_t c = pivots[r];
+    if ((v[c / word_size] >> (c % word_size)) & 1u) {
+      const binary_word* row = basis.row(r);
+      for (size_t w = c / word_size; w < v.size(); w++) {
+        v[w] ^= row[w];
+      }
+    }
+  }
+
+  bool in_support = std::ranges::all_of(v, [](binary_word w) { return w == 0; });
+  return in_support ? probability() : 0.0;
+}
+
+BitString StabilizerSampler::combine(const binary_word* coefficients) const {
+  constexpr size_t word_size = binary_word_size();
+  BitString bits = offset;
+  for (size_t r = 0; r < rank(); r++) {
+    if ((coefficients[r / word_size] >> (r % word_size)) & 1u) {
+      const binary_word* row = basis.row(r);
+      for (size_t w = 0; w < bits.bits.size(); w++) {
+        bits.bits[w] ^= row[w];
+      }
+    }
+  }
+
+  return bits;
+}
+
+BitString StabilizerSampler::sample() const {
+  return sample(1)[0];
+}
+
+std::vector<BitString> StabilizerSampler::sample(size_t num_samples) const {
+  // The coefficients of every sample are drawn in one batch
+  size_t words = rank() / binary_word_size() + 1;
+  std::vector<binary_word> coefficients(num_samples*words);
+  Random::fill_bits(coefficients);
+
+  std::vector<BitString> samples;
+  samples.reserve(num_samples);
+  for (size_t i = 0; i < num_samples; i++) {
+    samples.push_back(combine(coefficients.data() + i*words));
+  }
+
+  return samples;
+}
+
+bool RegionEntropies::ColumnSpan::insert(const binary_word* v) {
+  constexpr size_t word_size = binary_word_size();
+  size_t r = pivots.size();
+  rows.resize((r + 1)*words);
+  binary_word* w = rows.data() + r*words;
+  std::copy(v, v + words, w);
+
+  for (size_t i = 0; i < r; i++) {
+    uint32_t c = pivots[i];
+    if ((w[c / word_size] >> (c % word_size)) & 1u) {
+      const binary_word* b = row(i);
+      for (size_t k = 0; k < words; k++) {
+        w[k] ^= b[k];
+      }
+    }
+  }
+
+  for (size_t k = 0; k < words; k++) {
+    if (w[k]) {
+      pivots.push_back(k*word_size + std::countr_zero(w[k]));
+      return true;
+    }
+  }
+
+  rows.resize(r*words);
+  return false;
+}
+
+RegionEntropies::RegionEntropies(const TableauBase& tableau, const std::vector<Qubits>& regions) : num_qubits(tableau.num_qubits), regions(regions) {
+  constexpr size_t word_size = binary_word_size();
+  size_t words = num_qubits / word_size + static_cast<bool>(num_qubits % word_size);
+
+  std::vector<bool> used(num_qubits, false);
+  for (auto& region : this->regions) {
+    std::sort(region.begin(), region.end());
+    region.erase(std::unique(region.begin(), region.end()), region.end());
+    for (uint32_t q : region) {
+      if (q >= num_qubits) {
+        throw std::invalid_argument(std::format("Region contains qubit {}, which is not valid for a state with {} qubits.", q, num_qubits));
+      }
+      used[q] = true;
+    }
+  }
+
+  // Columns 2q and 2q + 1 are the x and z bits of qubit q over the stabilizers
+  std::vector<binary_word> columns(2*num_qubits*words, 0u);
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    for (uint32_t q = 0; q < num_qubits; q++) {
+      if (!used[q]) {
+        continue;
+      }
+
+      uint8_t p = tableau.get_pauli(i, q);
+      binary_word bit = static_cast<binary_word>(1) << (i % word_size);
+      if (p & 0b01) {
+        columns[(2*q)*words + i / word_size] |= bit;
+      }
+      if (p & 0b10) {
+        columns[(2*q + 1)*words + i / word_size] |= bit;
+      }
+    }
+  }
+
+  spans.resize(this->regions.size());
+  for (size_t r = 0; r < this->regions.size(); r++) {
+    spans[r].words = words;
+    for (uint32_t q : this->regions[r]) {
+      spans[r].insert(columns.data() + (2*q)*words);
+      spans[r].insert(columns.data() + (2*q + 1)*words);
+    }
+  }
+}
+
+void RegionEntropies::validate_region(size_t i) const {
+  if (i >= regions.size()) {
+    throw std::invalid_argument(std::format("Region {} is out of range for {} regions.", i, regions.size()));
+  }
+}
+
+uint32_t RegionEntropies::union_rank(const std::vector<size_t>& indices, ColumnSpan& span) const {
+  span = spans[indices[0]];
+  for (size_t k = 1; k < indices.size(); k++) {
+    const ColumnSpan& other = spans[indices[k]];
+    for (size_t r = 0; r < other.rank(); r++) {
+      span.insert(other.row(r));
+    }
+  }
+
+  return span.rank();
+}
+
+uint32_t RegionEntropies::union_size(const std::vector<size_t>& indices) const {
+  Qubits qubits = regions[indices[0]];
+  Qubits merged;
+  for (size_t k = 1; k < indices.size(); k++) {
+    const Qubits& region = regions[indices[k]];
+    merged.clear();
+    std::set_union(qubits.begin(), qubits.end(), region.begin(), region.end(), std::back_inserter(merged));
+    std::swap(qubits, merged);
+  }
+
+  return qubits.size();
+}
+
+double RegionEntropies::entropy(const std::vector<size_t>& indices) const {
+  if (indices.empty()) {
+    return 0.0;
+  }
+
+  for (size_t i : indices) {
+    validate_region(i);
+  }
+
+  thread_local ColumnSpan span;
+  int s = static_cast<int>(union_rank(indices, span)) - static_cast<int>(union_size(indices));
+  return static_cast<double>(s);
+}
+
+double RegionEntropies::entropy(size_t i) const {
+  validate_region(i);
+  return static_cast<double>(static_cast<int>(spans[i].rank()) - static_cast<int>(regions[i].size()));
+}
+
+double RegionEntropies::mutual_information(size_t i, size_t j) const {
+  return entropy(i) + entropy(j) - entropy({i, j});
+}
+
+double RegionEntropies::tripartite_information(size_t i, size_t j, size_t k) const {
+  return entropy(i) + entropy(j) + entropy(k) - entropy({i, j}) - entropy({i, k}) - entropy({j, k}) + entropy({i, j, k});
+}
+
+std::vector<std::vector<double>> RegionEntropies::mutual_information(uint32_t num_threads) const {
+  size_t m = regions.size();
+  std::vector<std::vector<double>> information(m, std::vector<double>(m));
+  if (m == 0) {
+    return information;
+  }
+
+  num_threads = num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min<size_t>(num_threads, m);
+
+  std::vector<std::exception_ptr> errors(num_threads);
+  std::atomic<size_t> next_row = 0;
+
+  // Row i fills the upper triangle; the cost of a row shrinks with i, so rows are claimed from a shared counter
+  auto worker = [&](uint32_t thread_id) {
+    try {
+      size_t i;
+      while ((i = next_row.fetch_add(1, std::memory_order_relaxed)) < m) {
+        for (size_t j = i; j < m; j++) {
+          information[i][j] = mutual_information(i, j);
+          information[j][i] = information[i][j];
+        }
+      }
+    } catch (...) {
+      errors[thread_id] = std::current_exception();
+      next_row = m;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(worker, t);
+  }
+  worker(0);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  return information;
+}
+
 Eigen::MatrixXi TableauBase::to_matrix() const {
   Eigen::MatrixXi M = Eigen::MatrixXi::Zero(num_qubits, 2*num_qubits);
 
@@ -105,6 +416,30 @@ Tableau::Tableau(uint32_t num_qubits) : TableauBase(num_qubits) {
   }
 }
 
+std::unique_ptr<TableauBase> Tableau::clone() const {
+  return std::make_unique<Tableau>(*this);
+}
+
+void Tableau::write_snapshot(SnapshotWriter& writer) const {
+  for (const auto* strings : {&stabilizers, &destabilizers}) {
+    for (const PauliString& p : *strings) {
+      writer.write(p.phase);
+      writer.write_array(p.bit_string.bits);
+    }
+  }
+}
+
+void Tableau::read_snapshot(SnapshotReader& reader) {
+  stabilizers = std::vector<PauliString>(num_qubits, PauliString(num_qubits));
+  destabilizers = std::vector<PauliString>(num_qubits, PauliString(num_qubits));
+  for (auto* strings : {&stabilizers, &destabilizers}) {
+    for (PauliString& p : *strings) {
+      p.phase = reader.read<uint8_t>();
+      reader.read_into(std::span<binary_word>(p.bit_string.bits));
+    }
+  }
+}
+
 Pauli Tableau::get_pauli(size_t i, size_t j) const {
   return stabilizers[i].to_pauli(j);
 }
@@ -222,36 +557,40 @@ void Tableau::xrref(const Qubits& sites) {
   }
 }
 
-uint32_t Tableau::xrank(const Qubits& sites) {
-  xrref(sites);
+static uint32_t restricted_rank(const std::vector<PauliString>& stabilizers, const Qubits& sites, bool x_only) {
+  thread_local BinaryMatrix scratch;
+  scratch.resize(stabilizers.size(), x_only ? sites.size() : 2*sites.size());
 
-  uint32_t r = 0;
-  for (uint32_t i = 0; i < stabilizers.size(); i++) {
-    for (uint32_t j = 0; j < sites.size(); j++) {
-      if (stabilizers[i].get_x(sites[j])) {
-        r++;
-        break;
-      }
-    }
+  bool contiguous = qubits_ascending_contiguous(sites);
+  for (size_t i = 0; i < stabilizers.size(); i++) {
+    const auto& bits = stabilizers[i].bit_string.bits;
+    pack_paulis(bits.data(), bits.size(), sites, contiguous, x_only, scratch.row(i));
   }
 
-  return r;
+  return scratch.rank();
 }
 
-uint32_t Tableau::rank(const Qubits& sites) {
-  rref(sites);
+uint32_t Tableau::xrank(const Qubits& sites) const {
+  return restricted_rank(stabilizers, sites, true);
+}
 
-  uint32_t r = 0;
-  for (uint32_t i = 0; i < stabilizers.size(); i++) {
-    for (uint32_t j = 0; j < sites.size(); j++) {
-      if (stabilizers[i].get_x(sites[j]) || stabilizers[i].get_z(sites[j])) {
-        r++;
-        break;
-      }
-    }
+uint32_t Tableau::rank(const Qubits& sites) const {
+  return restricted_rank(stabilizers, sites, false);
+}
+
+std::vector<uint32_t> Tableau::endpoint_counts() const {
+  thread_local BinaryMatrix scratch;
+  scratch.resize(num_qubits, 2*num_qubits);
+  for (size_t i = 0; i < num_qubits; i++) {
+    const auto& bits = stabilizers[i].bit_string.bits;
+    copy_bits(bits.data(), bits.size(), 0, 2*num_qubits, scratch.row(i));
   }
 
-  return r;
+  std::vector<uint32_t> counts(num_qubits);
+  for (uint32_t c : scratch.pivots()) {
+    counts[c / 2]++;
+  }
+  return counts;
 }
 
 void Tableau::rref() {
@@ -266,13 +605,13 @@ void Tableau::xrref() {
   xrref(qubits);
 }
 
-uint32_t Tableau::rank() {
+uint32_t Tableau::rank() const {
   std::vector<uint32_t> qubits(num_qubits);
   std::iota(qubits.begin(), qubits.end(), 0);
   return rank(qubits);
 }
 
-uint32_t Tableau::xrank() {
+uint32_t Tableau::xrank() const {
   std::vector<uint32_t> qubits(num_qubits);
   std::iota(qubits.begin(), qubits.end(), 0);
   return xrank(qubits);
@@ -308,6 +647,7 @@ double Tableau::bitstring_amplitude(const BitString& bits) {
     throw std::runtime_error(std::format("Cannot evaluate a bitstring of {} bits on a Tableau of {} qubits.", bits.num_bits, num_qubits));
   }
 
+  xrref();
   double p = 1/std::pow(2.0, xrank() + num_qubits - stabilizers.size());
 
   bool in_support = true;
@@ -461,6 +801,44 @@ void Tableau::cz(uint32_t a, uint32_t b) {
   h(b);
 }
 
+void Tableau::apply_layer(std::span<const CliffordOp> ops) {
+  for (const CliffordOp& op : ops) {
+    validate_qubit(op.qubits[0]);
+    validate_qubit(op.qubits[1]);
+  }
+
+  auto apply_ops = [&ops](PauliString& p) {
+    for (const CliffordOp& op : ops) {
+      uint32_t a = op.qubits[0];
+      uint32_t b = op.qubits[1];
+      uint8_t bits = p.get_xz(a);
+      if (op.num_qubits == 2) {
+        bits |= p.get_xz(b) << 2;
+      }
+
+      uint8_t v = op.apply(bits);
+      p.set_x(a, (v >> 0u) & 1u);
+      p.set_z(a, (v >> 1u) & 1u);
+      if (op.num_qubits == 2) {
+        p.set_x(b, (v >> 2u) & 1u);
+        p.set_z(b, (v >> 3u) & 1u);
+      }
+
+      if (v & 16u) {
+        p.set_r(p.get_r() + 2);
+      }
+    }
+  };
+
+  for (PauliString& p : stabilizers) {
+    apply_ops(p);
+  }
+
+  for (PauliString& p : destabilizers) {
+    apply_ops(p);
+  }
+}
+
 std::pair<bool, uint32_t> Tableau::mzr_deterministic(uint32_t a) const {
   for (uint32_t p = 0; p < stabilizers.size(); p++) {
     // Suitable p identified; outcome is random
@@ -519,3 +897,13 @@ MeasurementData Tableau::mzr(uint32_t a, std::optional<bool> outcome) {
     return {b, 1.0};
   }
 }
+
+void Tableau::stabilizer_rowsum(uint32_t i, uint32_t j) {
+  stabilizers[i] = stabilizers[i] * stabilizers[j];
+  destabilizers[j] = destabilizers[j] * destabilizers[i];
+}
+
+void Tableau::stabilizer_swap(uint32_t i, uint32_t j) {
+  std::swap(stabilizers[i], stabilizers[j]);
+  std::swap(destabilizers[i], destabilizers[j]);
+}
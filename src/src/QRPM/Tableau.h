@@ -5,9 +5,14 @@
 #include <random>
 #include <variant>
 #include <algorithm>
+#include <span>
+#include <memory>
 
 #include "QuantumStates.h"
 #include "QuantumCircuit.h"
+#include "CliffordOp.hpp"
+#include "Snapshot.hpp"
+#include "BinaryMatrix.hpp"
 
 class TableauBase {
   public:
@@ -18,6 +23,13 @@ class TableauBase {
 
     bool operator==(const TableauBase& other) const;
 
+    virtual std::unique_ptr<TableauBase> clone() const=0;
+
+    // Writes the packed words of the tableau to a snapshot as they are stored; read_snapshot restores them
+    // into a tableau of the same type, overwriting its contents.
+    virtual void write_snapshot(SnapshotWriter& writer) const=0;
+    virtual void read_snapshot(SnapshotReader& reader)=0;
+
     virtual Pauli get_pauli(size_t i, size_t j) const=0;
     virtual PauliString get_stabilizer(size_t i) const;
     virtual PauliString get_destabilizer(size_t i) const=0;
@@ -28,15 +40,30 @@ class TableauBase {
     // Put tableau into reduced row echelon form
     virtual void rref(const Qubits& sites)=0;
     virtual void rref()=0;
-    virtual uint32_t rank(const Qubits& sites)=0;
-    virtual uint32_t rank()=0;
     virtual void xrref(const Qubits& sites)=0;
     virtual void xrref()=0;
-    virtual uint32_t xrank(const Qubits& sites)=0;
-    virtual uint32_t xrank()=0;
+
+    // Rank of the stabilizer group restricted to sites (xrank: of its x-part). These do not modify the 
+    // tableau; the restricted stabilizer bits are copied into a thread-local scratch matrix and eliminated there.
+    virtual uint32_t rank(const Qubits& sites) const=0;
+    virtual uint32_t rank() const=0;
+    virtual uint32_t xrank(const Qubits& sites) const=0;
+    virtual uint32_t xrank() const=0;
+
+    // Number of stabilizers starting on each site once the stabilizers are in row echelon form over the 
+    // columns (x_0, z_0, x_1, z_1, ...). The stabilizers starting on or after site j span the subgroup
+    // supported on [j, n), which gives the entanglement across every cut at once. Like rank, this 
+    // eliminates in scratch space and leaves the tableau untouched.
+    virtual std::vector<uint32_t> endpoint_counts() const=0;
 
     virtual double bitstring_amplitude(const BitString& bits)=0;
 
+    // Expectation of a Pauli string in the stabilizer state. It vanishes unless the Pauli commutes with every
+    // stabilizer, in which case it is, up to sign, the product of the stabilizers paired with the destabilizers
+    // it anticommutes with. Reads the tableau without modifying it, so concurrent calls are safe.
+    virtual std::complex<double> expectation(const PauliString& pauli) const;
+    virtual std::complex<double> expectation(const SparsePauliObs& obs) const;
+
     inline void validate_qubit(uint32_t a) const {
       if (!(a >= 0 && a < num_qubits)) {
         std::string error_message = "A gate was applied to qubit " + std::to_string(a) + 
@@ -59,15 +86,113 @@ class TableauBase {
     virtual void cx(uint32_t a, uint32_t b)=0;
     virtual void cz(uint32_t a, uint32_t b);
 
+    // Applies a sequence of ops in a single pass over the rows of the tableau, rather than one pass
+    // per elementary gate. Equivalent to applying the ops one after another.
+    virtual void apply_layer(std::span<const CliffordOp> ops)=0;
+
+    // Applies a single op in one pass, e.g. a Clifford drawn from CliffordOp::random_clifford
+    virtual void apply_clifford(const CliffordOp& op);
+
+    // Applies a run of gate ops from a CompiledCircuit (see QuantumCircuit::compile)
+    virtual void execute(std::span<const CompiledOp> ops);
+
     // Returns a pair containing (1) wether the outcome of a measurement on qubit a is deterministic
     // and (2) the index on which the CHP algorithm performs rowsum if the mzr is random
     virtual std::pair<bool, uint32_t> mzr_deterministic(uint32_t a) const=0;
 
     virtual MeasurementData mzr(uint32_t a, std::optional<bool> outcome)=0;
 
+    // Row operations on the stabilizer group which leave the state unchanged. stabilizer_rowsum
+    // replaces stabilizer i with the product of stabilizers i and j, compensating destabilizer j
+    // so that the tableau remains symplectic. stabilizer_swap exchanges both (de)stabilizer pairs.
+    virtual void stabilizer_rowsum(uint32_t i, uint32_t j)=0;
+    virtual void stabilizer_swap(uint32_t i, uint32_t j)=0;
+
     virtual double sparsity() const;
 };
 
+// The computational basis distribution of a stabilizer state is uniform on the affine subspace z0 + span(x_i),
+// where the x_i are the x-parts of the stabilizers. The sampler finds a point z0 of the support by measuring 
+// a copy of the tableau and a row echelon basis of the span by one elimination, in O(n^3/64) in total. Every 
+// sample and probability after that costs O(n^2/64), and nothing of size 2^n is ever formed.
+class StabilizerSampler {
+  public:
+    StabilizerSampler(const TableauBase& tableau);
+
+    // Dimension of the support; every bitstring in it has probability 2^-rank
+    uint32_t rank() const {
+      return pivots.size();
+    }
+
+    double probability() const;
+    double probability(const BitString& bits) const;
+
+    BitString sample() const;
+    std::vector<BitString> sample(size_t num_samples) const;
+
+  private:
+    uint32_t num_qubits;
+    BitString offset;
+    BinaryMatrix basis;
+    std::vector<uint32_t> pivots;
+
+    // offset + the basis rows selected by the first rank() bits of coefficients
+    BitString combine(const binary_word* coefficients) const;
+};
+
+// Entropies of regions of a pure stabilizer state and of their unions. S(A) = rank_A - |A|, where rank_A is the 
+// rank of the 2|A| columns (x_q, z_q), q in A, of the stabilizer matrix, each a bit vector over the n stabilizers.
+// The columns of every region are reduced to a basis once; the rank of a union then only reduces the bases of 
+// the other regions against the first, so that the mutual information between every pair of single sites 
+// costs O(n^3/64) in total. The tableau is read once, on construction.
+class RegionEntropies {
+  public:
+    RegionEntropies(const TableauBase& tableau, const std::vector<Qubits>& regions);
+
+    size_t num_regions() const {
+      return regions.size();
+    }
+
+    // Entropy (in bits) of the union of the given regions
+    double entropy(const std::vector<size_t>& indices) const;
+    double entropy(size_t i) const;
+
+    double mutual_information(size_t i, size_t j) const;
+    double tripartite_information(size_t i, size_t j, size_t k) const;
+
+    // I(i:j) for every pair of regions. Rows of the matrix are handed out to num_threads threads; 0 uses 
+    // every hardware thread.
+    std::vector<std::vector<double>> mutual_information(uint32_t num_threads=0) const;
+
+  private:
+    // Bit vectors over the stabilizers, each of which vanishes on the pivots of the vectors before it. A vector
+    // is then reduced against the span by a single pass over the rows.
+    struct ColumnSpan {
+      size_t words;
+      std::vector<binary_word> rows;
+      std::vector<uint32_t> pivots;
+
+      uint32_t rank() const {
+        return pivots.size();
+      }
+
+      const binary_word* row(size_t i) const {
+        return rows.data() + i*words;
+      }
+
+      // Returns false, leaving the span unchanged, if v is already in the span
+      bool insert(const binary_word* v);
+    };
+
+    uint32_t num_qubits;
+    std::vector<Qubits> regions;
+    std::vector<ColumnSpan> spans;
+
+    uint32_t union_rank(const std::vector<size_t>& indices, ColumnSpan& span) const;
+    uint32_t union_size(const std::vector<size_t>& indices) const;
+    void validate_region(size_t i) const;
+};
+
 class Tableau : public TableauBase {
   public:
     std::vector<PauliString> stabilizers;
@@ -86,15 +211,20 @@ class Tableau : public TableauBase {
 
     bool operator==(Tableau& other);
 
+    virtual std::unique_ptr<TableauBase> clone() const override;
+    virtual void write_snapshot(SnapshotWriter& writer) const override;
+    virtual void read_snapshot(SnapshotReader& reader) override;
+
     // Put tableau into reduced row echelon form
     virtual void rref(const Qubits& sites) override;
     virtual void rref() override;
-    virtual uint32_t rank(const Qubits& sites) override;
-    virtual uint32_t rank() override;
+    virtual uint32_t rank(const Qubits& sites) const override;
+    virtual uint32_t rank() const override;
     virtual void xrref(const Qubits& sites) override;
     virtual void xrref() override;
-    virtual uint32_t xrank(const Qubits& sites) override;
-    virtual uint32_t xrank() override;
+    virtual uint32_t xrank(const Qubits& sites) const override;
+    virtual uint32_t xrank() const override;
+    virtual std::vector<uint32_t> endpoint_counts() const override;
 
     Tableau partial_trace(const Qubits& qubits);
 
@@ -111,10 +241,14 @@ class Tableau : public TableauBase {
     virtual void z(uint32_t a) override;
     virtual void cx(uint32_t a, uint32_t b) override;
     virtual void cz(uint32_t a, uint32_t b) override;
+    virtual void apply_layer(std::span<const CliffordOp> ops) override;
 
     // Returns a pair containing (1) wether the outcome of a measurement on qubit a is deterministic
     // and (2) the index on which the CHP algorithm performs rowsum if the mzr is random
     virtual std::pair<bool, uint32_t> mzr_deterministic(uint32_t a) const override;
 
     virtual MeasurementData mzr(uint32_t a, std::optional<bool> outcome=std::nullopt) override;
+
+    virtual void stabilizer_rowsum(uint32_t i, uint32_t j) override;
+    virtual void stabilizer_swap(uint32_t i, uint32_t j) override;
 };
@@ -1,7 +1,11 @@
 #include "TableauSIMD.h"
+#include "BinaryMatrix.hpp"
 
-#ifdef __AVX__
+#include <bit>
+
+#if defined(__x86_64__)
 #include <immintrin.h>
+#endif
 
 inline binary_word _get(const binary_word* data, size_t j) {
   binary_word word = data[j / binary_word_size()];
@@ -18,38 +22,118 @@ inline void _set(binary_word* data, size_t j, binary_word v) {
 }
 
 bool TableauSIMD::get(size_t i, size_t j) const {
-  return _get(rows[i], j);
+  if (transposed) {
+    return _get(column(j), i);
+  }
+  return _get(row(i), j);
 }
 
 void TableauSIMD::set(size_t i, size_t j, binary_word v) {
-  _set(rows[i], j, v);
+  if (transposed) {
+    _set(column(j), i, v);
+  } else {
+    _set(row(i), j, v);
+  }
 }
 
 inline size_t get_width(size_t num_bits) {
   return num_bits / binary_word_size() + static_cast<bool>(num_bits % binary_word_size());
 }
 
-TableauSIMD::TableauSIMD(uint32_t num_qubits) : TableauBase(num_qubits) {
-  width = get_width(2*num_qubits);
-  rows.resize(2*num_qubits + 1);
-  for (auto& row : rows) {
-    row = new binary_word[width];
-  }
+// Rows are padded to a whole number of 512-bit vectors, the widest used by the row kernels
+constexpr size_t ROW_WORDS = 512/binary_word_size();
 
+TableauSIMD::TableauSIMD(uint32_t num_qubits, bool column_major) : TableauBase(num_qubits), column_major(column_major), transposed(false) {
+  width = (get_width(2*num_qubits) + ROW_WORDS - 1) / ROW_WORDS * ROW_WORDS;
   pwidth = get_width(2*num_qubits + 1);
-  phase = new binary_word[pwidth];
+
+  // Rows are padded to a whole number of 64x64 blocks for transposition
+  slab = AlignedWords(pwidth*binary_word_size()*width, 0u);
+  phase = std::vector<binary_word>(pwidth, 0u);
 
   for (uint32_t i = 0; i < num_qubits; i++) {
-    reset(i);
-    reset(i + num_qubits);
     set(i, 2*i, true);
     set(i + num_qubits, 2*i+1, true);
   }
 }
 
+void TableauSIMD::set_column_major(bool column_major) {
+  this->column_major = column_major;
+  if (!column_major) {
+    to_rows();
+  }
+}
+
+// In-place transpose of a 64x64 bit block; afterwards bit j of a[i] is bit i of the original a[j]
+static void transpose_block(binary_word* a) {
+  static_assert(sizeof(binary_word) == 8, "transpose_block assumes 64-bit words.");
+  constexpr binary_word masks[6] = {
+    0x00000000FFFFFFFFull, 0x0000FFFF0000FFFFull, 0x00FF00FF00FF00FFull,
+    0x0F0F0F0F0F0F0F0Full, 0x3333333333333333ull, 0x5555555555555555ull
+  };
+
+  size_t j = 32;
+  for (size_t l = 0; l < 6; l++, j >>= 1) {
+    binary_word m = masks[l];
+    for (size_t k = 0; k < 64; k++) {
+      if (k & j) {
+        continue;
+      }
+
+      binary_word t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    }
+  }
+}
+
+void TableauSIMD::to_columns() {
+  if (transposed) {
+    return;
+  }
+
+  columns.resize(width*binary_word_size()*pwidth);
+
+  alignas(64) binary_word block[binary_word_size()];
+  for (size_t r = 0; r < pwidth; r++) {
+    for (size_t c = 0; c < width; c++) {
+      for (size_t k = 0; k < binary_word_size(); k++) {
+        block[k] = row(r*binary_word_size() + k)[c];
+      }
+      transpose_block(block);
+      for (size_t k = 0; k < binary_word_size(); k++) {
+        column(c*binary_word_size() + k)[r] = block[k];
+      }
+    }
+  }
+
+  transposed = true;
+}
+
+void TableauSIMD::to_rows() {
+  if (!transposed) {
+    return;
+  }
+
+  alignas(64) binary_word block[binary_word_size()];
+  for (size_t c = 0; c < width; c++) {
+    for (size_t r = 0; r < pwidth; r++) {
+      for (size_t k = 0; k < binary_word_size(); k++) {
+        block[k] = column(c*binary_word_size() + k)[r];
+      }
+      transpose_block(block);
+      for (size_t k = 0; k < binary_word_size(); k++) {
+        row(r*binary_word_size() + k)[c] = block[k];
+      }
+    }
+  }
+
+  transposed = false;
+}
+
 Pauli TableauSIMD::get_pauli(size_t i, size_t j) const {
-  bool x = _get(rows[i + num_qubits], 2*j);
-  bool z = _get(rows[i + num_qubits], 2*j+1);
+  bool x = get(i + num_qubits, 2*j);
+  bool z = get(i + num_qubits, 2*j+1);
   if (x && z) {
     return Pauli::Y;
   } else if (x) {
@@ -64,8 +148,8 @@ Pauli TableauSIMD::get_pauli(size_t i, size_t j) const {
 PauliString TableauSIMD::get_stabilizer(size_t i) const {
   std::vector<Pauli> paulis(num_qubits);
   for (size_t j = 0; j < num_qubits; j++) {
-    bool x = _get(rows[i + num_qubits], 2*j);
-    bool z = _get(rows[i + num_qubits], 2*j+1);
+    bool x = get(i + num_qubits, 2*j);
+    bool z = get(i + num_qubits, 2*j+1);
     if (x && z) {
       paulis[j] = Pauli::Y;
     } else if (x) {
@@ -77,14 +161,14 @@ PauliString TableauSIMD::get_stabilizer(size_t i) const {
     } 
   }
 
-  return PauliString(paulis, 2*_get(phase, i + num_qubits));
+  return PauliString(paulis, 2*_get(phase.data(), i + num_qubits));
 }
 
 PauliString TableauSIMD::get_destabilizer(size_t i) const {
   std::vector<Pauli> paulis(num_qubits);
   for (size_t j = 0; j < num_qubits; j++) {
-    bool x = _get(rows[i], 2*j);
-    bool z = _get(rows[i], 2*j+1);
+    bool x = get(i, 2*j);
+    bool z = get(i, 2*j+1);
     if (x && z) {
       paulis[j] = Pauli::Y;
     } else if (x) {
@@ -96,36 +180,132 @@ PauliString TableauSIMD::get_destabilizer(size_t i) const {
     } 
   }
 
-  return PauliString(paulis, 2*_get(phase, i));
+  return PauliString(paulis, 2*_get(phase.data(), i));
 }
 
 uint8_t TableauSIMD::get_phase(size_t i) const {
-  return 2*_get(phase, i + num_qubits);
+  return 2*_get(phase.data(), i + num_qubits);
 }
 
 void TableauSIMD::reset(int i) {
-  std::fill(rows[i], rows[i] + width, 0u);
-  _set(phase, i, false);
+  to_rows();
+  std::fill(row(i), row(i) + width, 0u);
+  _set(phase.data(), i, false);
 }
 
-constexpr __m256i generate_phase_vector() {
-  constexpr std::array<int, 16> table = generate_phase_table();
-  alignas(32) int8_t bytes[32];
-
-  for (int i = 0; i < 16; ++i) {
-    bytes[i]    = table[i];
-    bytes[i+16] = table[i];
-  }
-  return std::bit_cast<__m256i>(bytes);
-}
+// ------------------------------------------------------------------------------------------------
+// Row kernels. Each kernel is compiled for several instruction sets and the widest one supported by 
+// the CPU is selected at runtime, so that a single binary runs on any x86 machine (and elsewhere, 
+// e.g. under WebAssembly, falls back to the portable scalar kernels).
+// ------------------------------------------------------------------------------------------------
 
-constexpr size_t LANES = 256/binary_word_size();
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TABLEAU_SIMD_X86
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512vpopcntdq")))
+#endif
 
 constexpr bool WORD_64_BITS = (sizeof(binary_word) == 8);
 constexpr bool WORD_32_BITS = (sizeof(binary_word) == 4);
 constexpr bool WORD_16_BITS = (sizeof(binary_word) == 2);
 
-inline __m256i slli(__m256i v, size_t i) {
+// The kernels operate on rows [begin, end) of a slab with rows of width words, and on the 
+// phase bit vector of the tableau. rowsum returns the sum of the phases g picked up at every 
+// site when the row src is multiplied into dst (see Aaronson & Gottesman), which may be negative.
+using RowsumKernel = int (*)(binary_word* dst, const binary_word* src, size_t width);
+using OneQubitKernel = void (*)(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a);
+using TwoQubitKernel = void (*)(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a, uint32_t b);
+// Packs bit j of rows [begin, end) into the bit vector column, which is assumed to be zeroed
+using ColumnKernel = void (*)(const binary_word* slab, size_t width, size_t begin, size_t end, size_t j, binary_word* column);
+
+struct TableauKernels {
+  const char* name;
+  RowsumKernel rowsum;
+  OneQubitKernel h;
+  OneQubitKernel s;
+  TwoQubitKernel cx;
+  ColumnKernel column;
+};
+
+static int rowsum_scalar(binary_word* dst, const binary_word* src, size_t width) {
+  int s = 0;
+  for (size_t k = 0; k < width; k++) {
+    binary_word x1 = src[k] & EVEN_BITS;
+    binary_word z1 = (src[k] >> 1) & EVEN_BITS;
+    binary_word x2 = dst[k] & EVEN_BITS;
+    binary_word z2 = (dst[k] >> 1) & EVEN_BITS;
+
+    binary_word plus, minus;
+    phase_counts(x1, z1, x2, z2, plus, minus);
+    s += std::popcount(plus) - std::popcount(minus);
+
+    dst[k] ^= src[k];
+  }
+
+  return s;
+}
+
+static void h_scalar(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a) {
+  size_t word_ind = (2*a) / binary_word_size();
+  size_t offset = (2*a) % binary_word_size();
+
+  for (size_t i = begin; i < end; i++) {
+    binary_word& word = slab[i*width + word_ind];
+    binary_word x = (word >> offset) & 1u;
+    binary_word z = (word >> (offset + 1)) & 1u;
+
+    phase[i / binary_word_size()] ^= (x & z) << (i % binary_word_size());
+    word ^= ((x ^ z) * static_cast<binary_word>(3)) << offset;
+  }
+}
+
+static void s_scalar(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a) {
+  size_t word_ind = (2*a) / binary_word_size();
+  size_t offset = (2*a) % binary_word_size();
+
+  for (size_t i = begin; i < end; i++) {
+    binary_word& word = slab[i*width + word_ind];
+    binary_word x = (word >> offset) & 1u;
+    binary_word z = (word >> (offset + 1)) & 1u;
+
+    phase[i / binary_word_size()] ^= (x & z) << (i % binary_word_size());
+    word ^= x << (offset + 1);
+  }
+}
+
+static void cx_scalar(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a, uint32_t b) {
+  size_t word_ind_a = (2*a) / binary_word_size();
+  size_t offset_a = (2*a) % binary_word_size();
+  size_t word_ind_b = (2*b) / binary_word_size();
+  size_t offset_b = (2*b) % binary_word_size();
+
+  for (size_t i = begin; i < end; i++) {
+    binary_word& word_a = slab[i*width + word_ind_a];
+    binary_word& word_b = slab[i*width + word_ind_b];
+    binary_word xa = (word_a >> offset_a) & 1u;
+    binary_word za = (word_a >> (offset_a + 1)) & 1u;
+    binary_word xb = (word_b >> offset_b) & 1u;
+    binary_word zb = (word_b >> (offset_b + 1)) & 1u;
+
+    phase[i / binary_word_size()] ^= (xa & zb & ~(xb ^ za) & 1u) << (i % binary_word_size());
+    word_b ^= xa << offset_b;
+    word_a ^= zb << (offset_a + 1);
+  }
+}
+
+static void column_scalar(const binary_word* slab, size_t width, size_t begin, size_t end, size_t j, binary_word* column) {
+  size_t word_ind = j / binary_word_size();
+  size_t offset = j % binary_word_size();
+
+  for (size_t i = begin; i < end; i++) {
+    column[i / binary_word_size()] |= ((slab[i*width + word_ind] >> offset) & 1u) << (i % binary_word_size());
+  }
+}
+
+#ifdef TABLEAU_SIMD_X86
+constexpr size_t LANES = 256/binary_word_size();
+
+TARGET_AVX2 inline __m256i slli(__m256i v, size_t i) {
   if constexpr (WORD_64_BITS) {
     return _mm256_slli_epi64(v, i);
   } else if constexpr (WORD_32_BITS) {
@@ -135,7 +315,7 @@ inline __m256i slli(__m256i v, size_t i) {
   }
 }
 
-inline __m256i srli(__m256i v, size_t i) {
+TARGET_AVX2 inline __m256i srli(__m256i v, size_t i) {
   if constexpr (WORD_64_BITS) {
     return _mm256_srli_epi64(v, i);
   } else if constexpr (WORD_32_BITS) {
@@ -145,7 +325,7 @@ inline __m256i srli(__m256i v, size_t i) {
   }
 }
 
-inline __m256i set1(size_t i) {
+TARGET_AVX2 inline __m256i set1(size_t i) {
   if constexpr (WORD_64_BITS) {
     return _mm256_set1_epi64x(i);
   } else if constexpr (WORD_32_BITS) {
@@ -155,15 +335,112 @@ inline __m256i set1(size_t i) {
   }
 }
 
-void TableauSIMD::rowsum(int i, int j) {
-  uint8_t s = 2*_get(phase, i) + 2*_get(phase, j);
+TARGET_AVX2 inline __m256i load_words(size_t i, size_t word_ind, const binary_word* slab, size_t width) {
+  static_assert(std::is_unsigned_v<binary_word>, "binary_word must be an unsigned integral type.");
+
+  if constexpr (WORD_64_BITS) {
+    return _mm256_setr_epi64x(slab[(i+0)*width + word_ind], slab[(i+1)*width + word_ind], slab[(i+2)*width + word_ind], slab[(i+3)*width + word_ind]);
+  } else if constexpr (WORD_32_BITS) {
+    return _mm256_setr_epi32(slab[(i+0)*width + word_ind], slab[(i+1)*width + word_ind], slab[(i+2)*width + word_ind], slab[(i+3)*width + word_ind],
+                             slab[(i+4)*width + word_ind], slab[(i+5)*width + word_ind], slab[(i+6)*width + word_ind], slab[(i+7)*width + word_ind]);
+  } else if constexpr (WORD_16_BITS) {
+    return _mm256_setr_epi16(slab[(i+0 )*width + word_ind], slab[(i+1 )*width + word_ind], slab[(i+2 )*width + word_ind], slab[(i+3 )*width + word_ind],
+                             slab[(i+4 )*width + word_ind], slab[(i+5 )*width + word_ind], slab[(i+6 )*width + word_ind], slab[(i+7 )*width + word_ind],
+                             slab[(i+8 )*width + word_ind], slab[(i+9 )*width + word_ind], slab[(i+10)*width + word_ind], slab[(i+11)*width + word_ind],
+                             slab[(i+12)*width + word_ind], slab[(i+13)*width + word_ind], slab[(i+14)*width + word_ind], slab[(i+15)*width + word_ind]);
+  }
+}
+TARGET_AVX2 inline void save_words(size_t i, size_t word_ind, binary_word* slab, size_t width, __m256i words) {
+  if constexpr (WORD_64_BITS) {
+    slab[(i+0)*width + word_ind] = _mm256_extract_epi64(words, 0);
+    slab[(i+1)*width + word_ind] = _mm256_extract_epi64(words, 1);
+    slab[(i+2)*width + word_ind] = _mm256_extract_epi64(words, 2);
+    slab[(i+3)*width + word_ind] = _mm256_extract_epi64(words, 3);
+  } else if constexpr (WORD_32_BITS) {
+    slab[(i+0)*width + word_ind] = _mm256_extract_epi32(words, 0);
+    slab[(i+1)*width + word_ind] = _mm256_extract_epi32(words, 1);
+    slab[(i+2)*width + word_ind] = _mm256_extract_epi32(words, 2);
+    slab[(i+3)*width + word_ind] = _mm256_extract_epi32(words, 3);
+    slab[(i+4)*width + word_ind] = _mm256_extract_epi32(words, 4);
+    slab[(i+5)*width + word_ind] = _mm256_extract_epi32(words, 5);
+    slab[(i+6)*width + word_ind] = _mm256_extract_epi32(words, 6);
+    slab[(i+7)*width + word_ind] = _mm256_extract_epi32(words, 7);
+  } else if constexpr (WORD_16_BITS) {
+    slab[(i+0)*width + word_ind] = _mm256_extract_epi16(words, 0 );
+    slab[(i+1)*width + word_ind] = _mm256_extract_epi16(words, 1 );
+    slab[(i+2)*width + word_ind] = _mm256_extract_epi16(words, 2 );
+    slab[(i+3)*width + word_ind] = _mm256_extract_epi16(words, 3 );
+    slab[(i+4)*width + word_ind] = _mm256_extract_epi16(words, 4 );
+    slab[(i+5)*width + word_ind] = _mm256_extract_epi16(words, 5 );
+    slab[(i+6)*width + word_ind] = _mm256_extract_epi16(words, 6 );
+    slab[(i+7)*width + word_ind] = _mm256_extract_epi16(words, 7 );
+    slab[(i+8)*width + word_ind] = _mm256_extract_epi16(words, 8 );
+    slab[(i+9)*width + word_ind] = _mm256_extract_epi16(words, 9 );
+    slab[(i+10)*width + word_ind] = _mm256_extract_epi16(words, 10);
+    slab[(i+11)*width + word_ind] = _mm256_extract_epi16(words, 11);
+    slab[(i+12)*width + word_ind] = _mm256_extract_epi16(words, 12);
+    slab[(i+13)*width + word_ind] = _mm256_extract_epi16(words, 13);
+    slab[(i+14)*width + word_ind] = _mm256_extract_epi16(words, 14);
+    slab[(i+15)*width + word_ind] = _mm256_extract_epi16(words, 15);
+  }
+}
+
+TARGET_AVX2 inline void xor_phase_bits(size_t word_ind, size_t offset, binary_word* phase, __m256i bits) {
+  if constexpr (WORD_64_BITS) {
+    phase[word_ind] ^= _mm256_extract_epi64(bits, 0) << (offset + 0);
+    phase[word_ind] ^= _mm256_extract_epi64(bits, 1) << (offset + 1);
+    phase[word_ind] ^= _mm256_extract_epi64(bits, 2) << (offset + 2);
+    phase[word_ind] ^= _mm256_extract_epi64(bits, 3) << (offset + 3);
+  } else if constexpr (WORD_32_BITS) {
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 0) << (offset + 0);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 1) << (offset + 1);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 2) << (offset + 2);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 3) << (offset + 3);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 4) << (offset + 4);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 5) << (offset + 5);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 6) << (offset + 6);
+    phase[word_ind] ^= _mm256_extract_epi32(bits, 7) << (offset + 7);
+  } else if constexpr (WORD_16_BITS) {
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 0 ) << (offset + 0);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 1 ) << (offset + 1);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 2 ) << (offset + 2);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 3 ) << (offset + 3);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 4 ) << (offset + 4);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 5 ) << (offset + 5);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 6 ) << (offset + 6);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 7 ) << (offset + 7);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 8 ) << (offset + 8);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 9 ) << (offset + 9);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 10) << (offset + 10);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 11) << (offset + 11);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 12) << (offset + 12);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 13) << (offset + 13);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 14) << (offset + 14);
+    phase[word_ind] ^= _mm256_extract_epi16(bits, 15) << (offset + 15);
+  }
+}
+
+
+// Builds the byte table of the phases g(xz1, xz2), indexed by xz2 + 4*xz1, for _mm256_shuffle_epi8
+constexpr std::array<int8_t, 32> generate_phase_bytes() {
+  constexpr std::array<int, 16> table = generate_phase_table();
+  std::array<int8_t, 32> bytes;
+  for (int i = 0; i < 16; ++i) {
+    bytes[i]    = table[i];
+    bytes[i+16] = table[i];
+  }
+  return bytes;
+}
 
-  size_t p = width - width % LANES;
-  constexpr __m256i phase_vector_table = generate_phase_vector();
+TARGET_AVX2 static int rowsum_avx2(binary_word* dst, const binary_word* src, size_t width) {
+  alignas(32) static constexpr std::array<int8_t, 32> phase_bytes = generate_phase_bytes();
+  const __m256i phase_vector_table = _mm256_load_si256(reinterpret_cast<const __m256i*>(phase_bytes.data()));
   const __m256i mask = _mm256_set1_epi8(static_cast<char>(0b11));
-  for (size_t k = 0; k < p; k += LANES) {
-    __m256i xz1_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[i] + k));
-    __m256i xz2_vec = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[j] + k));
+
+  int s = 0;
+  for (size_t k = 0; k < width; k += LANES) {
+    __m256i xz1_vec = _mm256_load_si256(reinterpret_cast<const __m256i*>(dst + k));
+    __m256i xz2_vec = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + k));
 
     __m256i phases = _mm256_setzero_si256();
     for (size_t s = 0; s < 4; s++) {
@@ -174,128 +451,421 @@ void TableauSIMD::rowsum(int i, int j) {
     }
 
     alignas(32) int8_t temp_bytes[32];
-    _mm256_storeu_si256(reinterpret_cast<__m256i*>(temp_bytes), phases);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(temp_bytes), phases);
     for (int l = 0; l < 32; ++l) {
       s += temp_bytes[l];
     }
 
-    __m256i a = _mm256_loadu_si256((const __m256i*)(rows[i] + k));
-    __m256i b = _mm256_loadu_si256((const __m256i*)(rows[j] + k));
+    __m256i a = _mm256_load_si256((const __m256i*)(dst + k));
+    __m256i b = _mm256_load_si256((const __m256i*)(src + k));
     __m256i r = _mm256_xor_si256(a, b);
-    _mm256_storeu_si256((__m256i*)(rows[i] + k), r);
-  }
-
-  // Tail loops
-  for (uint32_t n = p*binary_word_size()/2; n < num_qubits; n++) {
-    s += multiplication_phase(get_xz(j, n), get_xz(i, n));
+    _mm256_store_si256((__m256i*)(dst + k), r);
   }
 
-  for (uint32_t n = p; n < width; n++) {
-    rows[i][n] ^= rows[j][n];
-  }
-
-  _set(phase, i, s % 4 == 2);
+  return s;
 }
 
-TableauSIMD::~TableauSIMD() {
-  for (auto ptr : rows) {
-    delete[] ptr;
-  }
+TARGET_AVX2 static void h_avx2(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a) {
+  size_t k = end - (end - begin) % LANES;
+  size_t word_ind = (2*a) / binary_word_size();
+  size_t offset = (2*a) % binary_word_size();
 
-  delete[] phase;
-}
+  __m256i mask_x = set1(1ULL << offset);
+  __m256i mask_z = set1(1ULL << (offset+1));
 
-bool TableauSIMD::operator==(TableauSIMD& other) {
-  if (num_qubits != other.num_qubits) {
-    return false;
-  }
+  for (size_t i = begin; i < k; i += LANES) {
+    __m256i v = load_words(i, word_ind, slab, width);
 
-  rref();
-  other.rref();
+    __m256i bit_x = _mm256_and_si256(v, mask_x);
+    __m256i bit_z = _mm256_and_si256(v, mask_z);
 
-  for (uint32_t i = 0; i < num_qubits; i++) {
-    if (_get(phase, i) != _get(other.phase, i)) {
-      return false;
-    }
+    __m256i bit_x_to_z = slli(bit_x, 1);
+    __m256i bit_z_to_x = srli(bit_z, 1);
 
-    for (uint32_t j = 0; j < 2*num_qubits; j++) {
-      if (get(i + num_qubits, j) != other.get(i + num_qubits, j)) {
-        return false;
-      }
-    }
+    __m256i cleared = _mm256_andnot_si256(_mm256_or_si256(mask_x, mask_z), v);
+    save_words(i, word_ind, slab, width, _mm256_or_si256(cleared, _mm256_or_si256(bit_x_to_z, bit_z_to_x)));
+
+    __m256i x0 = srli(bit_x, offset);
+    __m256i z0 = srli(bit_z, offset+1);
+    __m256i x_and_z = _mm256_and_si256(x0, z0);
+    xor_phase_bits(i / binary_word_size(), i % binary_word_size(), phase, x_and_z);
   }
 
-  return true;
+  // Scalar version for remainder
+  h_scalar(slab, width, phase, k, end, a);
 }
 
-void TableauSIMD::rref(const Qubits& sites) {
-  uint32_t pivot_row = num_qubits;
-  uint32_t row = num_qubits;
+TARGET_AVX2 static void s_avx2(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a) {
+  size_t k = end - (end - begin) % LANES;
+  size_t word_ind = (2*a) / binary_word_size();
+  size_t offset = (2*a) % binary_word_size();
 
-  for (uint32_t k = 0; k < 2*sites.size(); k++) {
-    uint32_t c = sites[k % sites.size()];
-    bool z = k < sites.size();
-    bool found_pivot = false;
-    for (uint32_t i = row; i < 2*num_qubits; i++) {
-      if ((z && get(i, 2*c+1)) || (!z && get(i, 2*c))) {
-        pivot_row = i;
-        found_pivot = true;
-        break;
-      }
-    }
+  __m256i mask_x = set1(1ULL << offset);
+  __m256i mask_z = set1(1ULL << (offset+1));
 
-    if (found_pivot) {
-      swap(row, pivot_row);
-      swap(row - num_qubits, pivot_row - num_qubits);
+  for (size_t i = begin; i < k; i += LANES) {
+    __m256i v = load_words(i, word_ind, slab, width);
 
-      for (uint32_t i = num_qubits; i < 2*num_qubits; i++) {
-        if (i == row) {
-          continue;
-        }
+    __m256i bit_x = _mm256_and_si256(v, mask_x);
+    __m256i bit_z = _mm256_and_si256(v, mask_z);
 
-        if ((z && get(i, 2*c+1)) || (!z && get(i, 2*c))) {
-          rowsum(i, row);
-          rowsum(row - num_qubits, i - num_qubits);
-        }
-      }
+    __m256i bit_x_to_z = slli(bit_x, 1);
 
-      row += 1;
-    } else {
-      continue;
-    }
+    __m256i cleared = _mm256_andnot_si256(mask_z, v);
+    save_words(i, word_ind, slab, width, _mm256_xor_si256(cleared, _mm256_xor_si256(bit_z, bit_x_to_z)));
+
+    __m256i x0 = srli(bit_x, offset);
+    __m256i z0 = srli(bit_z, offset+1);
+    __m256i x_and_z = _mm256_and_si256(x0, z0);
+    xor_phase_bits(i / binary_word_size(), i % binary_word_size(), phase, x_and_z);
   }
+
+  // Scalar version for remainder
+  s_scalar(slab, width, phase, k, end, a);
 }
 
-void TableauSIMD::xrref(const Qubits& sites) {
-  uint32_t pivot_row = num_qubits;
-  uint32_t row = num_qubits;
+TARGET_AVX2 static void cx_avx2(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a, uint32_t b) {
+  size_t k = end - (end - begin) % LANES;
+  size_t word_ind_a = (2*a) / binary_word_size();
+  size_t offset_a = (2*a) % binary_word_size();
+  __m256i mask_x_a = set1(1ULL << offset_a);
+  __m256i mask_z_a = set1(1ULL << (offset_a + 1));
 
-  for (uint32_t k = 0; k < 2*sites.size(); k++) {
-    uint32_t c = sites[k % sites.size()];
-    bool z = k < sites.size();
-    bool found_pivot = false;
-    for (uint32_t i = row; i < 2*num_qubits; i++) {
-      if (!z && get(i, 2*c)) {
-        pivot_row = i;
-        found_pivot = true;
-        break;
-      }
-    }
+  size_t word_ind_b = (2*b) / binary_word_size();
+  size_t offset_b = (2*b) % binary_word_size();
+  __m256i mask_x_b = set1(1ULL << offset_b);
+  __m256i mask_z_b = set1(1ULL << (offset_b + 1));
 
-    if (found_pivot) {
-      swap(row, pivot_row);
-      swap(row - num_qubits, pivot_row - num_qubits);
+  for (size_t i = begin; i < k; i += LANES) {
+    __m256i v_a = load_words(i, word_ind_a, slab, width);
+    __m256i bit_x_a = _mm256_and_si256(v_a, mask_x_a);
+    __m256i bit_z_a = _mm256_and_si256(v_a, mask_z_a);
 
-      for (uint32_t i = num_qubits; i < 2*num_qubits; i++) {
-        if (i == row) {
-          continue;
-        }
+    __m256i v_b = load_words(i, word_ind_b, slab, width);
+    __m256i bit_x_b = _mm256_and_si256(v_b, mask_x_b);
+    __m256i bit_z_b = _mm256_and_si256(v_b, mask_z_b);
 
-        if (!z && get(i, 2*c)) {
-          rowsum(i, row);
-          rowsum(row - num_qubits, i - num_qubits);
-        }
-      }
+    int bit_shift = std::abs(static_cast<int>(offset_a) - static_cast<int>(offset_b));
+    bool left = offset_b < offset_a;
+
+    // update za -> za != zb
+    __m256i bit_shifted_zb = left ? slli(bit_z_b, bit_shift) : srli(bit_z_b, bit_shift);
+    __m256i cleared_a = _mm256_andnot_si256(mask_z_a, v_a);
+    __m256i v_new_a = _mm256_or_si256(cleared_a, _mm256_xor_si256(bit_shifted_zb, bit_z_a));
+
+    if (word_ind_a == word_ind_b) {
+      v_b = v_new_a;
+    } else {
+      save_words(i, word_ind_a, slab, width, v_new_a);
+    }
+
+    // update xb -> xa != xb
+    __m256i bit_shifted_xa = left ? srli(bit_x_a, bit_shift) : slli(bit_x_a, bit_shift);
+    __m256i cleared_b = _mm256_andnot_si256(mask_x_b, v_b);
+    save_words(i, word_ind_b, slab, width, _mm256_or_si256(cleared_b, _mm256_xor_si256(bit_shifted_xa, bit_x_b)));
+
+
+    __m256i x0_a = srli(bit_x_a, offset_a);
+    __m256i z0_a = srli(bit_z_a, offset_a+1);
+    __m256i x0_b = srli(bit_x_b, offset_b);
+    __m256i z0_b = srli(bit_z_b, offset_b+1);
+    __m256i one_vec = set1(1);
+    __m256i result = _mm256_and_si256(_mm256_and_si256(x0_a, z0_b), _mm256_xor_si256(_mm256_xor_si256(x0_b, z0_a), one_vec));
+    xor_phase_bits(i / binary_word_size(), i % binary_word_size(), phase, result);
+  }
+
+  // Scalar version for remainder
+  cx_scalar(slab, width, phase, k, end, a, b);
+}
+
+// Moves bit j of each row to the sign bit and collects the four signs at once
+TARGET_AVX2 static void column_avx2(const binary_word* slab, size_t width, size_t begin, size_t end, size_t j, binary_word* column) {
+  size_t k = begin;
+  if constexpr (WORD_64_BITS) {
+    k = end - (end - begin) % LANES;
+    size_t word_ind = j / binary_word_size();
+    size_t offset = j % binary_word_size();
+
+    for (size_t i = begin; i < k; i += LANES) {
+      __m256i v = slli(load_words(i, word_ind, slab, width), binary_word_size() - 1 - offset);
+      binary_word bits = _mm256_movemask_pd(_mm256_castsi256_pd(v));
+      column[i / binary_word_size()] |= bits << (i % binary_word_size());
+    }
+  }
+
+  column_scalar(slab, width, k, end, j, column);
+}
+
+// The AVX-512 kernels handle eight rows per iteration, gathering the words of a qubit from
+// each. Phase bits of eight consecutive rows fall in the same word, since begin is a multiple of 8.
+constexpr size_t LANES_512 = 512/binary_word_size();
+
+TARGET_AVX512 static int rowsum_avx512(binary_word* dst, const binary_word* src, size_t width) {
+  const __m512i even = _mm512_set1_epi64(EVEN_BITS);
+
+  __m512i plus_count = _mm512_setzero_si512();
+  __m512i minus_count = _mm512_setzero_si512();
+  for (size_t k = 0; k < width; k += LANES_512) {
+    __m512i v1 = _mm512_load_si512(src + k);
+    __m512i v2 = _mm512_load_si512(dst + k);
+
+    __m512i x1 = _mm512_and_si512(v1, even);
+    __m512i z1 = _mm512_and_si512(_mm512_srli_epi64(v1, 1), even);
+    __m512i x2 = _mm512_and_si512(v2, even);
+    __m512i z2 = _mm512_and_si512(_mm512_srli_epi64(v2, 1), even);
+
+    // Same expressions as in phase_counts; x1 or z1 always appears, so the odd bits stay clear
+    __m512i plus = _mm512_or_si512(_mm512_or_si512(
+        _mm512_andnot_si512(x2, _mm512_and_si512(_mm512_and_si512(x1, z1), z2)),
+        _mm512_and_si512(_mm512_andnot_si512(z1, x1), _mm512_and_si512(x2, z2))),
+        _mm512_andnot_si512(x1, _mm512_andnot_si512(z2, _mm512_and_si512(z1, x2))));
+    __m512i minus = _mm512_or_si512(_mm512_or_si512(
+        _mm512_andnot_si512(z2, _mm512_and_si512(_mm512_and_si512(x1, z1), x2)),
+        _mm512_andnot_si512(x2, _mm512_andnot_si512(z1, _mm512_and_si512(x1, z2)))),
+        _mm512_andnot_si512(x1, _mm512_and_si512(z1, _mm512_and_si512(x2, z2))));
+
+    plus_count = _mm512_add_epi64(plus_count, _mm512_popcnt_epi64(plus));
+    minus_count = _mm512_add_epi64(minus_count, _mm512_popcnt_epi64(minus));
+
+    _mm512_store_si512(dst + k, _mm512_xor_si512(v1, v2));
+  }
+
+  return static_cast<int>(_mm512_reduce_add_epi64(plus_count) - _mm512_reduce_add_epi64(minus_count));
+}
+
+TARGET_AVX512 inline __m512i row_offsets(size_t width) {
+  long long w = width;
+  return _mm512_setr_epi64(0, w, 2*w, 3*w, 4*w, 5*w, 6*w, 7*w);
+}
+
+TARGET_AVX512 static void h_avx512(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a) {
+  size_t k = end - (end - begin) % LANES_512;
+  size_t word_ind = (2*a) / binary_word_size();
+  size_t offset = (2*a) % binary_word_size();
+
+  const __m512i index = row_offsets(width);
+  const __m512i mask_x = _mm512_set1_epi64(1ull << offset);
+
+  for (size_t i = begin; i < k; i += LANES_512) {
+    binary_word* base = slab + i*width + word_ind;
+    __m512i v = _mm512_i64gather_epi64(index, base, sizeof(binary_word));
+
+    // x and z at offset, and x xor z at offset (swapping the bits flips both iff they differ)
+    __m512i shifted = _mm512_srli_epi64(v, 1);
+    __mmask8 x_and_z = _mm512_test_epi64_mask(_mm512_and_si512(v, shifted), mask_x);
+    __m512i differ = _mm512_and_si512(_mm512_xor_si512(v, shifted), mask_x);
+    v = _mm512_xor_si512(v, _mm512_or_si512(differ, _mm512_slli_epi64(differ, 1)));
+
+    _mm512_i64scatter_epi64(base, index, v, sizeof(binary_word));
+    phase[i / binary_word_size()] ^= static_cast<binary_word>(x_and_z) << (i % binary_word_size());
+  }
+
+  h_scalar(slab, width, phase, k, end, a);
+}
+
+TARGET_AVX512 static void s_avx512(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a) {
+  size_t k = end - (end - begin) % LANES_512;
+  size_t word_ind = (2*a) / binary_word_size();
+  size_t offset = (2*a) % binary_word_size();
+
+  const __m512i index = row_offsets(width);
+  const __m512i mask_x = _mm512_set1_epi64(1ull << offset);
+
+  for (size_t i = begin; i < k; i += LANES_512) {
+    binary_word* base = slab + i*width + word_ind;
+    __m512i v = _mm512_i64gather_epi64(index, base, sizeof(binary_word));
+
+    __mmask8 x_and_z = _mm512_test_epi64_mask(_mm512_and_si512(v, _mm512_srli_epi64(v, 1)), mask_x);
+    v = _mm512_xor_si512(v, _mm512_slli_epi64(_mm512_and_si512(v, mask_x), 1));
+
+    _mm512_i64scatter_epi64(base, index, v, sizeof(binary_word));
+    phase[i / binary_word_size()] ^= static_cast<binary_word>(x_and_z) << (i % binary_word_size());
+  }
+
+  s_scalar(slab, width, phase, k, end, a);
+}
+
+TARGET_AVX512 static void cx_avx512(binary_word* slab, size_t width, binary_word* phase, size_t begin, size_t end, uint32_t a, uint32_t b) {
+  size_t k = end - (end - begin) % LANES_512;
+  size_t word_ind_a = (2*a) / binary_word_size();
+  size_t offset_a = (2*a) % binary_word_size();
+  size_t word_ind_b = (2*b) / binary_word_size();
+  size_t offset_b = (2*b) % binary_word_size();
+
+  const __m512i index = row_offsets(width);
+  const __m512i one = _mm512_set1_epi64(1);
+
+  for (size_t i = begin; i < k; i += LANES_512) {
+    binary_word* base_a = slab + i*width + word_ind_a;
+    binary_word* base_b = slab + i*width + word_ind_b;
+    __m512i v_a = _mm512_i64gather_epi64(index, base_a, sizeof(binary_word));
+    __m512i v_b = (word_ind_a == word_ind_b) ? v_a : _mm512_i64gather_epi64(index, base_b, sizeof(binary_word));
+
+    __m512i xa = _mm512_and_si512(_mm512_srli_epi64(v_a, offset_a), one);
+    __m512i za = _mm512_and_si512(_mm512_srli_epi64(v_a, offset_a + 1), one);
+    __m512i xb = _mm512_and_si512(_mm512_srli_epi64(v_b, offset_b), one);
+    __m512i zb = _mm512_and_si512(_mm512_srli_epi64(v_b, offset_b + 1), one);
+
+    __m512i flip = _mm512_andnot_si512(_mm512_xor_si512(xb, za), _mm512_and_si512(xa, zb));
+    __mmask8 flip_mask = _mm512_test_epi64_mask(flip, one);
+
+    // xb ^= xa, za ^= zb
+    if (word_ind_a == word_ind_b) {
+      v_a = _mm512_xor_si512(v_a, _mm512_xor_si512(_mm512_slli_epi64(xa, offset_b), _mm512_slli_epi64(zb, offset_a + 1)));
+      _mm512_i64scatter_epi64(base_a, index, v_a, sizeof(binary_word));
+    } else {
+      v_a = _mm512_xor_si512(v_a, _mm512_slli_epi64(zb, offset_a + 1));
+      v_b = _mm512_xor_si512(v_b, _mm512_slli_epi64(xa, offset_b));
+      _mm512_i64scatter_epi64(base_a, index, v_a, sizeof(binary_word));
+      _mm512_i64scatter_epi64(base_b, index, v_b, sizeof(binary_word));
+    }
+
+    phase[i / binary_word_size()] ^= static_cast<binary_word>(flip_mask) << (i % binary_word_size());
+  }
+
+  cx_scalar(slab, width, phase, k, end, a, b);
+}
+
+TARGET_AVX512 static void column_avx512(const binary_word* slab, size_t width, size_t begin, size_t end, size_t j, binary_word* column) {
+  size_t k = end - (end - begin) % LANES_512;
+  size_t word_ind = j / binary_word_size();
+  size_t offset = j % binary_word_size();
+
+  const __m512i index = row_offsets(width);
+  const __m512i mask = _mm512_set1_epi64(1ull << offset);
+
+  for (size_t i = begin; i < k; i += LANES_512) {
+    __m512i v = _mm512_i64gather_epi64(index, slab + i*width + word_ind, sizeof(binary_word));
+    __mmask8 bits = _mm512_test_epi64_mask(v, mask);
+    column[i / binary_word_size()] |= static_cast<binary_word>(bits) << (i % binary_word_size());
+  }
+
+  column_scalar(slab, width, k, end, j, column);
+}
+#endif
+
+static TableauKernels select_kernels() {
+#ifdef TABLEAU_SIMD_X86
+  __builtin_cpu_init();
+  if constexpr (WORD_64_BITS) {
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq")) {
+      return {"avx512", rowsum_avx512, h_avx512, s_avx512, cx_avx512, column_avx512};
+    }
+  }
+
+  if (__builtin_cpu_supports("avx2")) {
+    return {"avx2", rowsum_avx2, h_avx2, s_avx2, cx_avx2, column_avx2};
+  }
+#endif
+
+  return {"scalar", rowsum_scalar, h_scalar, s_scalar, cx_scalar, column_scalar};
+}
+
+static const TableauKernels& tableau_kernels() {
+  static const TableauKernels kernels = select_kernels();
+  return kernels;
+}
+
+std::string TableauSIMD::instruction_set() {
+  return tableau_kernels().name;
+}
+
+void TableauSIMD::rowsum(int i, int j) {
+  to_rows();
+  int s = 2*_get(phase.data(), i) + 2*_get(phase.data(), j) + tableau_kernels().rowsum(row(i), row(j), width);
+  _set(phase.data(), i, (s % 4 + 4) % 4 == 2);
+}
+
+std::unique_ptr<TableauBase> TableauSIMD::clone() const {
+  return std::make_unique<TableauSIMD>(*this);
+}
+
+// Only the current layout is written; the other one is stale until the next conversion
+void TableauSIMD::write_snapshot(SnapshotWriter& writer) const {
+  writer.write(width);
+  writer.write(pwidth);
+  writer.write(column_major);
+  writer.write(transposed);
+  if (transposed) {
+    writer.write_array(columns);
+  } else {
+    writer.write_array(slab);
+  }
+  writer.write_array(phase);
+}
+
+void TableauSIMD::read_snapshot(SnapshotReader& reader) {
+  uint32_t w = reader.read<uint32_t>();
+  uint32_t pw = reader.read<uint32_t>();
+  if (w != width || pw != pwidth) {
+    throw std::runtime_error(std::format("Snapshot tableau has {}x{} words per row and column; expected {}x{} for {} qubits.", w, pw, width, pwidth, num_qubits));
+  }
+
+  column_major = reader.read<bool>();
+  transposed = reader.read<bool>();
+  if (transposed) {
+    columns.resize(width*binary_word_size()*pwidth);
+    reader.read_into(std::span<binary_word>(columns));
+  } else {
+    reader.read_into(std::span<binary_word>(slab));
+  }
+  reader.read_into(std::span<binary_word>(phase));
+}
+
+bool TableauSIMD::operator==(TableauSIMD& other) {
+  if (num_qubits != other.num_qubits) {
+    return false;
+  }
+
+  rref();
+  other.rref();
+
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    if (_get(phase.data(), i) != _get(other.phase.data(), i)) {
+      return false;
+    }
+
+    for (uint32_t j = 0; j < 2*num_qubits; j++) {
+      if (get(i + num_qubits, j) != other.get(i + num_qubits, j)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void TableauSIMD::rref(const Qubits& sites) {
+  to_rows();
+  uint32_t pivot_row = num_qubits;
+  uint32_t row = num_qubits;
+
+  for (uint32_t k = 0; k < 2*sites.size(); k++) {
+    uint32_t c = sites[k % sites.size()];
+    bool z = k < sites.size();
+    bool found_pivot = false;
+    for (uint32_t i = row; i < 2*num_qubits; i++) {
+      if ((z && get(i, 2*c+1)) || (!z && get(i, 2*c))) {
+        pivot_row = i;
+        found_pivot = true;
+        break;
+      }
+    }
+
+    if (found_pivot) {
+      swap(row, pivot_row);
+      swap(row - num_qubits, pivot_row - num_qubits);
+
+      for (uint32_t i = num_qubits; i < 2*num_qubits; i++) {
+        if (i == row) {
+          continue;
+        }
+
+        if ((z && get(i, 2*c+1)) || (!z && get(i, 2*c))) {
+          rowsum(i, row);
+          rowsum(row - num_qubits, i - num_qubits);
+        }
+      }
 
       row += 1;
     } else {
@@ -304,36 +874,111 @@ void TableauSIMD::xrref(const Qubits& sites) {
   }
 }
 
-uint32_t TableauSIMD::xrank(const Qubits& sites) {
-  xrref(sites);
+void TableauSIMD::xrref(const Qubits& sites) {
+  to_rows();
+  uint32_t pivot_row = num_qubits;
+  uint32_t row = num_qubits;
 
-  uint32_t r = 0;
-  for (uint32_t i = num_qubits; i < 2*num_qubits; i++) {
-    for (uint32_t j = 0; j < sites.size(); j++) {
-      if (get(i, 2*sites[j])) {
-        r++;
+  for (uint32_t k = 0; k < 2*sites.size(); k++) {
+    uint32_t c = sites[k % sites.size()];
+    bool z = k < sites.size();
+    bool found_pivot = false;
+    for (uint32_t i = row; i < 2*num_qubits; i++) {
+      if (!z && get(i, 2*c)) {
+        pivot_row = i;
+        found_pivot = true;
         break;
       }
     }
+
+    if (found_pivot) {
+      swap(row, pivot_row);
+      swap(row - num_qubits, pivot_row - num_qubits);
+
+      for (uint32_t i = num_qubits; i < 2*num_qubits; i++) {
+        if (i == row) {
+          continue;
+        }
+
+        if (!z && get(i, 2*c)) {
+          rowsum(i, row);
+          rowsum(row - num_qubits, i - num_qubits);
+        }
+      }
+
+      row += 1;
+    } else {
+      continue;
+    }
   }
+}
 
-  return r;
+// Copies the restriction of the stabilizers onto sites into a packed scratch matrix and eliminates 
+// there, leaving the tableau (including the destabilizers) untouched. In the qubit-major layout
+// the transposed matrix, with one row per site column, is packed instead; its rank is the same.
+static uint32_t restricted_rank(const TableauSIMD& tableau, const Qubits& sites, bool x_only) {
+  thread_local BinaryMatrix scratch;
+  uint32_t num_qubits = tableau.num_qubits;
+  size_t num_cols = x_only ? sites.size() : 2*sites.size();
+
+  if (tableau.transposed) {
+    scratch.resize(num_cols, num_qubits);
+    for (size_t j = 0; j < num_cols; j++) {
+      size_t c = x_only ? 2*sites[j] : 2*sites[j/2] + (j % 2);
+      copy_bits(tableau.column(c), tableau.pwidth, num_qubits, num_qubits, scratch.row(j));
+    }
+  } else {
+    scratch.resize(num_qubits, num_cols);
+    bool contiguous = qubits_ascending_contiguous(sites);
+    for (uint32_t i = 0; i < num_qubits; i++) {
+      pack_paulis(tableau.row(i + num_qubits), tableau.width, sites, contiguous, x_only, scratch.row(i));
+    }
+  }
+
+  return scratch.rank();
 }
 
-uint32_t TableauSIMD::rank(const Qubits& sites) {
-  rref(sites);
+uint32_t TableauSIMD::xrank(const Qubits& sites) const {
+  return restricted_rank(*this, sites, true);
+}
 
-  uint32_t r = 0;
-  for (uint32_t i = num_qubits; i < 2*num_qubits; i++) {
-    for (uint32_t j = 0; j < sites.size(); j++) {
-      if (get(i, 2*sites[j]) || get(i, 2*sites[j]+1)) {
-        r++;
-        break;
+uint32_t TableauSIMD::rank(const Qubits& sites) const {
+  return restricted_rank(*this, sites, false);
+}
+
+std::vector<uint32_t> TableauSIMD::endpoint_counts() const {
+  thread_local BinaryMatrix scratch;
+  scratch.resize(num_qubits, 2*num_qubits);
+
+  if (transposed) {
+    // Transpose 64x64 blocks of the stabilizer part of the columns back into rows
+    constexpr size_t word_size = binary_word_size();
+    alignas(64) binary_word block[word_size];
+    for (size_t r = 0; r < num_qubits; r += word_size) {
+      size_t num_rows = std::min(word_size, num_qubits - r);
+      for (size_t c = 0; c < 2*num_qubits; c += word_size) {
+        size_t num_cols = std::min(word_size, 2*num_qubits - c);
+        std::fill(block, block + word_size, 0u);
+        for (size_t k = 0; k < num_cols; k++) {
+          copy_bits(column(c + k), pwidth, num_qubits + r, num_rows, block + k);
+        }
+        transpose_block(block);
+        for (size_t k = 0; k < num_rows; k++) {
+          scratch.row(r + k)[c / word_size] = block[k];
+        }
       }
     }
+  } else {
+    for (size_t i = 0; i < num_qubits; i++) {
+      std::copy(row(i + num_qubits), row(i + num_qubits) + scratch.width, scratch.row(i));
+    }
   }
 
-  return r;
+  std::vector<uint32_t> counts(num_qubits);
+  for (uint32_t c : scratch.pivots()) {
+    counts[c / 2]++;
+  }
+  return counts;
 }
 
 void TableauSIMD::rref() {
@@ -348,13 +993,13 @@ void TableauSIMD::xrref() {
   xrref(qubits);
 }
 
-uint32_t TableauSIMD::rank() {
+uint32_t TableauSIMD::rank() const {
   std::vector<uint32_t> qubits(num_qubits);
   std::iota(qubits.begin(), qubits.end(), 0);
   return rank(qubits);
 }
 
-uint32_t TableauSIMD::xrank() {
+uint32_t TableauSIMD::xrank() const {
   std::vector<uint32_t> qubits(num_qubits);
   std::iota(qubits.begin(), qubits.end(), 0);
   return xrank(qubits);
@@ -391,6 +1036,7 @@ double TableauSIMD::bitstring_amplitude(const BitString& bits) {
   }
 
   // TODO replace with rank defficiency?
+  xrref();
   double p = 1/std::pow(2.0, xrank() + num_qubits - num_qubits);
 
   bool in_support = true;
@@ -415,19 +1061,152 @@ double TableauSIMD::bitstring_amplitude(const BitString& bits) {
       }
     }
 
-    if (positive != (_get(phase, r) == 0)) {
-      in_support = false;
-      break;
-    }
+    if (positive != (_get(phase.data(), r) == 0)) {
+      in_support = false;
+      break;
+    }
+  }
+
+  return in_support ? p : 0.0;
+}
+
+// Whether the Paulis of two rows anticommute: the parity of their symplectic inner product
+static bool rows_anticommute(const binary_word* a, const binary_word* b, size_t width) {
+  binary_word parity = 0;
+  for (size_t k = 0; k < width; k++) {
+    binary_word xa = a[k] & EVEN_BITS;
+    binary_word za = (a[k] >> 1) & EVEN_BITS;
+    binary_word xb = b[k] & EVEN_BITS;
+    binary_word zb = (b[k] >> 1) & EVEN_BITS;
+    parity ^= (xa & zb) ^ (za & xb);
+  }
+
+  return std::popcount(parity) & 1;
+}
+
+// Row i of the tableau, read in place from the row-major layout or gathered into buffer from the columns
+static const binary_word* row_words(const TableauSIMD& tableau, size_t i, AlignedWords& buffer) {
+  if (!tableau.transposed) {
+    return tableau.row(i);
+  }
+
+  buffer.assign(tableau.width, 0u);
+  for (size_t j = 0; j < 2*tableau.num_qubits; j++) {
+    _set(buffer.data(), j, _get(tableau.column(j), i));
+  }
+
+  return buffer.data();
+}
+
+// Marks in anticommuting (of pwidth words) the rows [0, 2n) which anticommute with the packed Pauli row 
+// pauli. In the qubit-major layout, this is the sum of the z columns at the x sites of the Pauli and the x 
+// columns at its z sites.
+static void anticommuting_rows(const TableauSIMD& tableau, const binary_word* pauli, binary_word* anticommuting) {
+  std::fill(anticommuting, anticommuting + tableau.pwidth, 0u);
+  if (tableau.transposed) {
+    for (size_t j = 0; j < tableau.num_qubits; j++) {
+      if (_get(pauli, 2*j)) {
+        const binary_word* z = tableau.column(2*j + 1);
+        for (size_t k = 0; k < tableau.pwidth; k++) {
+          anticommuting[k] ^= z[k];
+        }
+      }
+
+      if (_get(pauli, 2*j + 1)) {
+        const binary_word* x = tableau.column(2*j);
+        for (size_t k = 0; k < tableau.pwidth; k++) {
+          anticommuting[k] ^= x[k];
+        }
+      }
+    }
+  } else {
+    for (size_t r = 0; r < 2*tableau.num_qubits; r++) {
+      if (rows_anticommute(tableau.row(r), pauli, tableau.width)) {
+        _set(anticommuting, r, 1);
+      }
+    }
+  }
+}
+
+static size_t find_set_bit(const binary_word* bits, size_t begin, size_t end);
+
+// The expectation of a packed Pauli with phase (in units of i) given the rows it anticommutes with
+static std::complex<double> pauli_expectation(const TableauSIMD& tableau, uint8_t phase, const binary_word* anticommuting) {
+  size_t n = tableau.num_qubits;
+  if (find_set_bit(anticommuting, n, 2*n) < 2*n) {
+    return 0.0;
+  }
+
+  thread_local AlignedWords product;
+  thread_local AlignedWords buffer;
+  product.assign(tableau.width, 0u);
+
+  int s = 0;
+  for (size_t r = find_set_bit(anticommuting, 0, n); r < n; r = find_set_bit(anticommuting, r + 1, n)) {
+    s += 2*_get(tableau.phase.data(), r + n) + tableau_kernels().rowsum(product.data(), row_words(tableau, r + n, buffer), tableau.width);
+  }
+
+  // The product of the stabilizers is i^s times the Pauli operators of pauli, and is +1 on the state
+  return sign_from_bits(((phase - s) % 4 + 4) % 4);
+}
+
+std::complex<double> TableauSIMD::expectation(const PauliString& pauli) const {
+  if (pauli.num_qubits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a TableauSIMD of {} qubits.", pauli.num_qubits, num_qubits));
+  }
+
+  thread_local AlignedWords packed;
+  thread_local std::vector<binary_word> anticommuting;
+  packed.assign(width, 0u);
+  std::copy(pauli.bit_string.bits.begin(), pauli.bit_string.bits.end(), packed.begin());
+  anticommuting.resize(pwidth);
+
+  anticommuting_rows(*this, packed.data(), anticommuting.data());
+  return pauli_expectation(*this, pauli.get_r(), anticommuting.data());
+}
+
+std::complex<double> TableauSIMD::expectation(const SparsePauliObs& obs) const {
+  size_t num_terms = obs.size();
+  thread_local AlignedWords packed;
+  thread_local std::vector<binary_word> anticommuting;
+  packed.assign(num_terms*width, 0u);
+  anticommuting.assign(num_terms*pwidth, 0u);
+
+  for (size_t t = 0; t < num_terms; t++) {
+    const PauliString& pauli = obs[t].second;
+    if (pauli.num_qubits != num_qubits) {
+      throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a TableauSIMD of {} qubits.", pauli.num_qubits, num_qubits));
+    }
+
+    std::copy(pauli.bit_string.bits.begin(), pauli.bit_string.bits.end(), packed.begin() + t*width);
+  }
+
+  if (transposed) {
+    for (size_t t = 0; t < num_terms; t++) {
+      anticommuting_rows(*this, packed.data() + t*width, anticommuting.data() + t*pwidth);
+    }
+  } else {
+    for (size_t r = 0; r < 2*num_qubits; r++) {
+      for (size_t t = 0; t < num_terms; t++) {
+        if (rows_anticommute(row(r), packed.data() + t*width, width)) {
+          _set(anticommuting.data() + t*pwidth, r, 1);
+        }
+      }
+    }
+  }
+
+  std::complex<double> c = 0.0;
+  for (size_t t = 0; t < num_terms; t++) {
+    c += obs[t].first*pauli_expectation(*this, obs[t].second.get_r(), anticommuting.data() + t*pwidth);
   }
 
-  return in_support ? p : 0.0;
+  return c;
 }
 
-std::string binary_word_to_string(const binary_word* word, size_t length) {
+std::string binary_word_to_string(const TableauSIMD& tableau, size_t r, size_t length) {
   std::string s = "";
   for (size_t i = 0; i < length; i++) {
-    s += std::format("{}", _get(word, i));
+    s += std::format("{}", tableau.get(r, i));
   }
   return s;
 }
@@ -437,7 +1216,7 @@ std::string TableauSIMD::to_string(bool print_destabilizers) const {
   if (print_destabilizers) {
     for (size_t i = 0; i < num_qubits; i++) {
       s += (i == 0) ? "[" : " ";
-      s += (_get(phase, i) ? "-" : "+") + binary_word_to_string(rows[i], 2*num_qubits);
+      s += (_get(phase.data(), i) ? "-" : "+") + binary_word_to_string(*this, i, 2*num_qubits);
       s += (i == num_qubits - 1) ? "]" : "\n";
     }
     s += "\n";
@@ -445,18 +1224,18 @@ std::string TableauSIMD::to_string(bool print_destabilizers) const {
 
   for (size_t i = num_qubits; i < 2*num_qubits; i++) {
     s += (i == 0) ? "[" : " ";
-    s += (_get(phase, i) ? "-" : "+") + binary_word_to_string(rows[i], 2*num_qubits);
+    s += (_get(phase.data(), i) ? "-" : "+") + binary_word_to_string(*this, i, 2*num_qubits);
     s += (i == num_qubits - 1) ? "]" : "\n";
   }
 
   return s;
 }
 
-std::string binary_word_to_string_ops(const binary_word* word, size_t length) {
+std::string binary_word_to_string_ops(const TableauSIMD& tableau, size_t r, size_t length) {
   std::string s = "";
   for (size_t i = 0; i < length/2; i++) {
-    bool x = _get(word, 2*i);
-    bool z = _get(word, 2*i+1);
+    bool x = tableau.get(r, 2*i);
+    bool z = tableau.get(r, 2*i+1);
 
     if (x && z) {
       s += "Y";
@@ -476,7 +1255,7 @@ std::string TableauSIMD::to_string_ops(bool print_destabilizers) const {
   if (print_destabilizers) {
     for (size_t i = 0; i < num_qubits; i++) {
       s += (i == 0) ? "[" : " ";
-      s += (_get(phase, i) ? "-" : "+") + binary_word_to_string_ops(rows[i], 2*num_qubits);
+      s += (_get(phase.data(), i) ? "-" : "+") + binary_word_to_string_ops(*this, i, 2*num_qubits);
       s += (i == num_qubits - 1) ? "]" : "\n";
     }
     s += "\n";
@@ -484,254 +1263,227 @@ std::string TableauSIMD::to_string_ops(bool print_destabilizers) const {
 
   for (size_t i = num_qubits; i < 2*num_qubits; i++) {
     s += (i == num_qubits) ? "[" : " ";
-    s += (_get(phase, i) ? "-" : "+") + binary_word_to_string_ops(rows[i], 2*num_qubits);
+    s += (_get(phase.data(), i) ? "-" : "+") + binary_word_to_string_ops(*this, i, 2*num_qubits);
     s += (i == 2*num_qubits - 1) ? "]" : "\n";
   }
   return s;
 }
 
-inline __m256i load_words(size_t i, size_t word_ind, const std::vector<binary_word*>& rows) {
-  static_assert(std::is_unsigned_v<binary_word>, "binary_word must be an unsigned integral type.");
-
-  if constexpr (WORD_64_BITS) {
-    return _mm256_setr_epi64x(rows[i+0][word_ind], rows[i+1][word_ind], rows[i+2][word_ind], rows[i+3][word_ind]);
-  } else if constexpr (WORD_32_BITS) {
-    return _mm256_setr_epi32(rows[i+0][word_ind], rows[i+1][word_ind], rows[i+2][word_ind], rows[i+3][word_ind],
-                             rows[i+4][word_ind], rows[i+5][word_ind], rows[i+6][word_ind], rows[i+7][word_ind]);
-  } else if constexpr (WORD_16_BITS) {
-    return _mm256_setr_epi16(rows[i+0 ][word_ind], rows[i+1 ][word_ind], rows[i+2 ][word_ind], rows[i+3 ][word_ind],
-                             rows[i+4 ][word_ind], rows[i+5 ][word_ind], rows[i+6 ][word_ind], rows[i+7 ][word_ind],
-                             rows[i+8 ][word_ind], rows[i+9 ][word_ind], rows[i+10][word_ind], rows[i+11][word_ind],
-                             rows[i+12][word_ind], rows[i+13][word_ind], rows[i+14][word_ind], rows[i+15][word_ind]);
-  }
-}
-
-inline void save_words(size_t i, size_t word_ind, std::vector<binary_word*>& rows, __m256i words) {
-  if constexpr (WORD_64_BITS) {
-    rows[i+0][word_ind] = _mm256_extract_epi64(words, 0);
-    rows[i+1][word_ind] = _mm256_extract_epi64(words, 1);
-    rows[i+2][word_ind] = _mm256_extract_epi64(words, 2);
-    rows[i+3][word_ind] = _mm256_extract_epi64(words, 3);
-  } else if constexpr (WORD_32_BITS) {
-    rows[i+0][word_ind] = _mm256_extract_epi32(words, 0);
-    rows[i+1][word_ind] = _mm256_extract_epi32(words, 1);
-    rows[i+2][word_ind] = _mm256_extract_epi32(words, 2);
-    rows[i+3][word_ind] = _mm256_extract_epi32(words, 3);
-    rows[i+4][word_ind] = _mm256_extract_epi32(words, 4);
-    rows[i+5][word_ind] = _mm256_extract_epi32(words, 5);
-    rows[i+6][word_ind] = _mm256_extract_epi32(words, 6);
-    rows[i+7][word_ind] = _mm256_extract_epi32(words, 7);
-  } else if constexpr (WORD_16_BITS) {
-    rows[i+0 ][word_ind] = _mm256_extract_epi16(words, 0 );
-    rows[i+1 ][word_ind] = _mm256_extract_epi16(words, 1 );
-    rows[i+2 ][word_ind] = _mm256_extract_epi16(words, 2 );
-    rows[i+3 ][word_ind] = _mm256_extract_epi16(words, 3 );
-    rows[i+4 ][word_ind] = _mm256_extract_epi16(words, 4 );
-    rows[i+5 ][word_ind] = _mm256_extract_epi16(words, 5 );
-    rows[i+6 ][word_ind] = _mm256_extract_epi16(words, 6 );
-    rows[i+7 ][word_ind] = _mm256_extract_epi16(words, 7 );
-    rows[i+8 ][word_ind] = _mm256_extract_epi16(words, 8 );
-    rows[i+9 ][word_ind] = _mm256_extract_epi16(words, 9 );
-    rows[i+10][word_ind] = _mm256_extract_epi16(words, 10);
-    rows[i+11][word_ind] = _mm256_extract_epi16(words, 11);
-    rows[i+12][word_ind] = _mm256_extract_epi16(words, 12);
-    rows[i+13][word_ind] = _mm256_extract_epi16(words, 13);
-    rows[i+14][word_ind] = _mm256_extract_epi16(words, 14);
-    rows[i+15][word_ind] = _mm256_extract_epi16(words, 15);
-  }
-}
-
-inline void xor_phase_bits(size_t word_ind, size_t offset, binary_word* phase, __m256i bits) {
-  if constexpr (WORD_64_BITS) {
-    phase[word_ind] ^= _mm256_extract_epi64(bits, 0) << (offset + 0);
-    phase[word_ind] ^= _mm256_extract_epi64(bits, 1) << (offset + 1);
-    phase[word_ind] ^= _mm256_extract_epi64(bits, 2) << (offset + 2);
-    phase[word_ind] ^= _mm256_extract_epi64(bits, 3) << (offset + 3);
-  } else if constexpr (WORD_32_BITS) {
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 0) << (offset + 0);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 1) << (offset + 1);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 2) << (offset + 2);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 3) << (offset + 3);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 4) << (offset + 4);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 5) << (offset + 5);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 6) << (offset + 6);
-    phase[word_ind] ^= _mm256_extract_epi32(bits, 7) << (offset + 7);
-  } else if constexpr (WORD_16_BITS) {
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 0 ) << (offset + 0);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 1 ) << (offset + 1);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 2 ) << (offset + 2);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 3 ) << (offset + 3);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 4 ) << (offset + 4);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 5 ) << (offset + 5);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 6 ) << (offset + 6);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 7 ) << (offset + 7);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 8 ) << (offset + 8);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 9 ) << (offset + 9);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 10) << (offset + 10);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 11) << (offset + 11);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 12) << (offset + 12);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 13) << (offset + 13);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 14) << (offset + 14);
-    phase[word_ind] ^= _mm256_extract_epi16(bits, 15) << (offset + 15);
-  }
-}
-
 void TableauSIMD::h(uint32_t a) {
   validate_qubit(a);
 
-  size_t k = 2*num_qubits - (2*num_qubits) % LANES;
-  size_t word_ind = (2*a) / binary_word_size();
-  size_t offset = (2*a) % binary_word_size();
-
-  __m256i mask_x = set1(1ULL << offset);
-  __m256i mask_z = set1(1ULL << (offset+1));
-
-  for (size_t i = 0; i < k; i += LANES) {
-    __m256i v = load_words(i, word_ind, rows);
-
-    __m256i bit_x = _mm256_and_si256(v, mask_x);
-    __m256i bit_z = _mm256_and_si256(v, mask_z);
-
-    __m256i bit_x_to_z = slli(bit_x, 1);
-    __m256i bit_z_to_x = srli(bit_z, 1);
-
-    __m256i cleared = _mm256_andnot_si256(_mm256_or_si256(mask_x, mask_z), v);
-    save_words(i, word_ind, rows, _mm256_or_si256(cleared, _mm256_or_si256(bit_x_to_z, bit_z_to_x)));
-
-    __m256i x0 = srli(bit_x, offset);
-    __m256i z0 = srli(bit_z, offset+1);
-    __m256i x_and_z = _mm256_and_si256(x0, z0);
-    xor_phase_bits(i / binary_word_size(), i % binary_word_size(), phase, x_and_z);
+  if (column_major) {
+    to_columns();
+    binary_word* x = column(2*a);
+    binary_word* z = column(2*a + 1);
+    for (size_t w = 0; w < pwidth; w++) {
+      phase[w] ^= x[w] & z[w];
+      std::swap(x[w], z[w]);
+    }
+    return;
   }
 
-  // Scalar version for remainder
-  for (size_t i = k; i < 2*num_qubits; i++) {
-    constexpr bool h_phase_lookup[] = {0, 0, 0, 1};
-    uint8_t xza = get_xz(i, a);
-    bool xa = (xza >> 0u) & 1u;
-    bool za = (xza >> 1u) & 1u;
-
-    _set(phase, i, _get(phase, i) != h_phase_lookup[xza]);
-    set(i, 2*a,   za);
-    set(i, 2*a+1, xa);
-  }
+  to_rows();
+  tableau_kernels().h(slab.data(), width, phase.data(), 0, 2*num_qubits, a);
 }
 
 void TableauSIMD::s(uint32_t a) {
   validate_qubit(a);
 
-  size_t k = 2*num_qubits - (2*num_qubits) % LANES;
-  size_t word_ind = (2*a) / binary_word_size();
-  size_t offset = (2*a) % binary_word_size();
-
-  __m256i mask_x = set1(1ULL << offset);
-  __m256i mask_z = set1(1ULL << (offset+1));
-
-  for (size_t i = 0; i < k; i += LANES) {
-    __m256i v = load_words(i, word_ind, rows);
-
-    __m256i bit_x = _mm256_and_si256(v, mask_x);
-    __m256i bit_z = _mm256_and_si256(v, mask_z);
+  if (column_major) {
+    to_columns();
+    const binary_word* x = column(2*a);
+    binary_word* z = column(2*a + 1);
+    for (size_t w = 0; w < pwidth; w++) {
+      phase[w] ^= x[w] & z[w];
+      z[w] ^= x[w];
+    }
+    return;
+  }
 
-    __m256i bit_x_to_z = slli(bit_x, 1);
+  to_rows();
+  tableau_kernels().s(slab.data(), width, phase.data(), 0, 2*num_qubits, a);
+}
 
-    __m256i cleared = _mm256_andnot_si256(mask_z, v);
-    save_words(i, word_ind, rows, _mm256_xor_si256(cleared, _mm256_xor_si256(bit_z, bit_x_to_z)));
+void TableauSIMD::cx(uint32_t a, uint32_t b) {
+  validate_qubit(a);
+  validate_qubit(b);
 
-    __m256i x0 = srli(bit_x, offset);
-    __m256i z0 = srli(bit_z, offset+1);
-    __m256i x_and_z = _mm256_and_si256(x0, z0);
-    xor_phase_bits(i / binary_word_size(), i % binary_word_size(), phase, x_and_z);
+  if (column_major) {
+    to_columns();
+    binary_word* xa = column(2*a);
+    binary_word* za = column(2*a + 1);
+    binary_word* xb = column(2*b);
+    binary_word* zb = column(2*b + 1);
+    for (size_t w = 0; w < pwidth; w++) {
+      phase[w] ^= xa[w] & zb[w] & ~(xb[w] ^ za[w]);
+      xb[w] ^= xa[w];
+      za[w] ^= zb[w];
+    }
+    return;
   }
 
-  for (size_t i = k; i < 2*num_qubits; i++) {
-    uint8_t xza = get_xz(i, a);
-    bool xa = (xza >> 0u) & 1u;
-    bool za = (xza >> 1u) & 1u;
+  to_rows();
+  tableau_kernels().cx(slab.data(), width, phase.data(), 0, 2*num_qubits, a, b);
+}
 
-    constexpr bool s_phase_lookup[] = {0, 0, 0, 1};
-    _set(phase, i, (_get(phase, i) != s_phase_lookup[xza]));
-    set(i, 2*a+1, xa != za);
+void TableauSIMD::apply_layer(std::span<const CliffordOp> ops) {
+  for (const CliffordOp& op : ops) {
+    validate_qubit(op.qubits[0]);
+    validate_qubit(op.qubits[1]);
   }
-}
 
-void TableauSIMD::cx(uint32_t a, uint32_t b) {
-  validate_qubit(a);
-  validate_qubit(b);
+  if (column_major) {
+    // Each op is evaluated bitsliced on its (xa, za, xb, zb) columns, a word of rows at a time
+    to_columns();
+    for (const CliffordOp& op : ops) {
+      std::array<uint8_t, 16> anf = op.anf();
+      size_t num_inputs = 2*op.num_qubits;
+      size_t num_monomials = 1u << num_inputs;
+
+      binary_word* in[4] = {column(2*op.qubits[0]), column(2*op.qubits[0] + 1), column(2*op.qubits[1]), column(2*op.qubits[1] + 1)};
+      for (size_t w = 0; w < pwidth; w++) {
+        binary_word monomials[16];
+        monomials[0] = ~static_cast<binary_word>(0);
+        for (size_t m = 1; m < num_monomials; m++) {
+          size_t j = std::bit_width(m) - 1;
+          monomials[m] = monomials[m ^ (1u << j)] & in[j][w];
+        }
 
-  size_t k = 2*num_qubits - (2*num_qubits) % LANES;
-  size_t word_ind_a = (2*a) / binary_word_size();
-  size_t offset_a = (2*a) % binary_word_size();
-  __m256i mask_x_a = set1(1ULL << offset_a);
-  __m256i mask_z_a = set1(1ULL << (offset_a + 1));
+        binary_word out[5] = {0, 0, 0, 0, 0};
+        for (size_t m = 0; m < num_monomials; m++) {
+          for (size_t k = 0; k < 5; k++) {
+            out[k] ^= monomials[m] & -static_cast<binary_word>((anf[m] >> k) & 1u);
+          }
+        }
 
-  size_t word_ind_b = (2*b) / binary_word_size();
-  size_t offset_b = (2*b) % binary_word_size();
-  __m256i mask_x_b = set1(1ULL << offset_b);
-  __m256i mask_z_b = set1(1ULL << (offset_b + 1));
+        for (size_t k = 0; k < num_inputs; k++) {
+          in[k][w] = out[k];
+        }
+        phase[w] ^= out[4];
+      }
+    }
+    return;
+  }
 
-  for (size_t i = 0; i < k; i += LANES) {
-    __m256i v_a = load_words(i, word_ind_a, rows);
-    __m256i bit_x_a = _mm256_and_si256(v_a, mask_x_a);
-    __m256i bit_z_a = _mm256_and_si256(v_a, mask_z_a);
+  // Otherwise, every row is read once and all ops are applied to it while it sits in cache
+  to_rows();
+  constexpr size_t num_paulis = binary_word_size()/2;
+  for (size_t i = 0; i < 2*num_qubits; i++) {
+    binary_word* r = row(i);
+    uint8_t flip = 0;
+    for (const CliffordOp& op : ops) {
+      uint32_t a = op.qubits[0];
+      uint32_t b = op.qubits[1];
+      size_t wa = a / num_paulis;
+      size_t wb = b / num_paulis;
+      size_t oa = 2*(a % num_paulis);
+      size_t ob = 2*(b % num_paulis);
+
+      uint8_t bits = (r[wa] >> oa) & 3u;
+      if (op.num_qubits == 2) {
+        bits |= ((r[wb] >> ob) & 3u) << 2;
+      }
 
-    __m256i v_b = load_words(i, word_ind_b, rows);
-    __m256i bit_x_b = _mm256_and_si256(v_b, mask_x_b);
-    __m256i bit_z_b = _mm256_and_si256(v_b, mask_z_b);
+      uint8_t v = op.apply(bits);
+      r[wa] = (r[wa] & ~(static_cast<binary_word>(3) << oa)) | (static_cast<binary_word>(v & 3u) << oa);
+      if (op.num_qubits == 2) {
+        r[wb] = (r[wb] & ~(static_cast<binary_word>(3) << ob)) | (static_cast<binary_word>((v >> 2) & 3u) << ob);
+      }
+      flip ^= v >> 4;
+    }
 
-    int bit_shift = std::abs(static_cast<int>(offset_a) - static_cast<int>(offset_b));
-    bool left = offset_b < offset_a;
+    if (flip) {
+      _set(phase.data(), i, !_get(phase.data(), i));
+    }
+  }
+}
 
-    // update za -> za != zb
-    __m256i bit_shifted_zb = left ? slli(bit_z_b, bit_shift) : srli(bit_z_b, bit_shift);
-    __m256i cleared_a = _mm256_andnot_si256(mask_z_a, v_a);
-    __m256i v_new_a = _mm256_or_si256(cleared_a, _mm256_xor_si256(bit_shifted_zb, bit_z_a));
+// Applies op to the rows [0, 2n), collecting the sign flips of each word of rows before touching the phases
+template <bool two_qubit>
+static void apply_clifford_rows(binary_word* slab, size_t width, binary_word* phase, size_t num_rows, const CliffordOp& op) {
+  constexpr size_t word_size = binary_word_size();
+  constexpr size_t num_paulis = word_size/2;
+  size_t wa = op.qubits[0] / num_paulis;
+  size_t wb = op.qubits[1] / num_paulis;
+  size_t oa = 2*(op.qubits[0] % num_paulis);
+  size_t ob = 2*(op.qubits[1] % num_paulis);
+  binary_word ma = ~(static_cast<binary_word>(3) << oa);
+  binary_word mb = ~(static_cast<binary_word>(3) << ob);
+
+  for (size_t w = 0; w*word_size < num_rows; w++) {
+    size_t num_bits = std::min(word_size, num_rows - w*word_size);
+    binary_word flips = 0;
+    for (size_t k = 0; k < num_bits; k++) {
+      binary_word* r = slab + (w*word_size + k)*width;
+      uint8_t bits = (r[wa] >> oa) & 3u;
+      if constexpr (two_qubit) {
+        bits |= ((r[wb] >> ob) & 3u) << 2;
+      }
 
-    if (word_ind_a == word_ind_b) {
-      v_b = v_new_a;
-    } else {
-      save_words(i, word_ind_a, rows, v_new_a);
+      uint8_t v = op.apply(bits);
+      r[wa] = (r[wa] & ma) | (static_cast<binary_word>(v & 3u) << oa);
+      if constexpr (two_qubit) {
+        r[wb] = (r[wb] & mb) | (static_cast<binary_word>((v >> 2) & 3u) << ob);
+      }
+      flips |= static_cast<binary_word>(v >> 4) << k;
     }
+    phase[w] ^= flips;
+  }
+}
 
-    // update xb -> xa != xb
-    __m256i bit_shifted_xa = left ? srli(bit_x_a, bit_shift) : slli(bit_x_a, bit_shift);
-    __m256i cleared_b = _mm256_andnot_si256(mask_x_b, v_b);
-    save_words(i, word_ind_b, rows, _mm256_or_si256(cleared_b, _mm256_xor_si256(bit_shifted_xa, bit_x_b)));
+void TableauSIMD::apply_clifford(const CliffordOp& op) {
+  if (column_major) {
+    apply_layer(std::span(&op, 1));
+    return;
+  }
 
+  validate_qubit(op.qubits[0]);
+  validate_qubit(op.qubits[1]);
 
-    __m256i x0_a = srli(bit_x_a, offset_a);
-    __m256i z0_a = srli(bit_z_a, offset_a+1);
-    __m256i x0_b = srli(bit_x_b, offset_b);
-    __m256i z0_b = srli(bit_z_b, offset_b+1);
-    __m256i one_vec = set1(1);
-    __m256i result = _mm256_and_si256(_mm256_and_si256(x0_a, z0_b), _mm256_xor_si256(_mm256_xor_si256(x0_b, z0_a), one_vec));
-    xor_phase_bits(i / binary_word_size(), i % binary_word_size(), phase, result);
+  to_rows();
+  if (op.num_qubits == 2) {
+    apply_clifford_rows<true>(slab.data(), width, phase.data(), 2*num_qubits, op);
+  } else {
+    apply_clifford_rows<false>(slab.data(), width, phase.data(), 2*num_qubits, op);
   }
+}
 
-  for (size_t i = k; i < 2*num_qubits; i++) {
-    uint8_t xza = get_xz(i, a);
-    bool xa = (xza >> 0u) & 1u;
-    bool za = (xza >> 1u) & 1u;
+const binary_word* TableauSIMD::x_column(uint32_t a, std::vector<binary_word>& buffer) const {
+  if (transposed) {
+    return column(2*a);
+  }
 
-    uint8_t xzb = get_xz(i, b);
-    bool xb = (xzb >> 0u) & 1u;
-    bool zb = (xzb >> 1u) & 1u;
+  buffer.assign(pwidth, 0u);
+  tableau_kernels().column(slab.data(), width, 0, 2*num_qubits, 2*a, buffer.data());
+  return buffer.data();
+}
 
-    uint8_t bitcode = xzb + (xza << 2);
+// Index of the first set bit of a bit vector in [begin, end), or end if there is none
+static size_t find_set_bit(const binary_word* bits, size_t begin, size_t end) {
+  constexpr size_t word_size = binary_word_size();
+  for (size_t w = begin / word_size; w*word_size < end; w++) {
+    binary_word word = bits[w];
+    if (w == begin / word_size) {
+      word &= ~static_cast<binary_word>(0) << (begin % word_size);
+    }
 
-    constexpr bool cx_phase_lookup[] = {0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
-    _set(phase, i, _get(phase, i) != cx_phase_lookup[bitcode]);
-    set(i, 2*b, xa != xb);
-    set(i, 2*a+1, za != zb);
+    if (word) {
+      return std::min(w*word_size + std::countr_zero(word), end);
+    }
   }
+
+  return end;
 }
 
 std::pair<bool, uint32_t> TableauSIMD::mzr_deterministic(uint32_t a) const {
-  for (uint32_t p = num_qubits; p < 2*num_qubits; p++) {
-    // Suitable p identified; outcome is random
-    if (get(p, 2*a)) { 
-      return std::pair(false, p);
-    }
+  thread_local std::vector<binary_word> buffer;
+  const binary_word* x = x_column(a, buffer);
+
+  // Suitable p identified; outcome is random
+  size_t p = find_set_bit(x, num_qubits, 2*num_qubits);
+  if (p < 2*num_qubits) {
+    return std::pair(false, p);
   }
 
   // No p found; outcome is deterministic
@@ -739,23 +1491,29 @@ std::pair<bool, uint32_t> TableauSIMD::mzr_deterministic(uint32_t a) const {
 }
 
 void TableauSIMD::swap(size_t i, size_t j) {
-  std::swap(rows[i], rows[j]);
-  bool r1 = _get(phase, i);
-  bool r2 = _get(phase, j);
-  _set(phase, i, r2);
-  _set(phase, j, r1);
+  to_rows();
+  std::swap_ranges(row(i), row(i) + width, row(j));
+  bool r1 = _get(phase.data(), i);
+  bool r2 = _get(phase.data(), j);
+  _set(phase.data(), i, r2);
+  _set(phase.data(), j, r1);
 }
 
 MeasurementData TableauSIMD::mzr(uint32_t a, std::optional<bool> outcome) {
   validate_qubit(a);
+  to_rows();
 
-  auto [deterministic, p] = mzr_deterministic(a);
+  // Rows with an x on qubit a; rowsums against them below do not change the x bits of the other rows
+  thread_local std::vector<binary_word> buffer;
+  const binary_word* x = x_column(a, buffer);
+  size_t p = find_set_bit(x, num_qubits, 2*num_qubits);
+  bool deterministic = p == 2*num_qubits;
 
   if (!deterministic) {
     bool b = outcome ? outcome.value() : randi() % 2;
 
-    for (uint32_t i = 0; i < 2*num_qubits; i++) {
-      if (i != p && get(i, 2*a)) {
+    for (size_t i = find_set_bit(x, 0, 2*num_qubits); i < 2*num_qubits; i = find_set_bit(x, i + 1, 2*num_qubits)) {
+      if (i != p) {
         rowsum(i, p);
       }
     }
@@ -764,19 +1522,17 @@ MeasurementData TableauSIMD::mzr(uint32_t a, std::optional<bool> outcome) {
 
 
     reset(p);
-    _set(phase, p, b);
+    _set(phase.data(), p, b);
     set(p, 2*a+1, true);
 
     return {b, 0.5};
   } else { // deterministic
     reset(2*num_qubits);
-    for (uint32_t i = 0; i < num_qubits; i++) {
-      if (get(i, 2*a)) {
-        rowsum(2*num_qubits, i + num_qubits);
-      }
+    for (size_t i = find_set_bit(x, 0, num_qubits); i < num_qubits; i = find_set_bit(x, i + 1, num_qubits)) {
+      rowsum(2*num_qubits, i + num_qubits);
     }
 
-    bool b = _get(phase, 2*num_qubits);
+    bool b = _get(phase.data(), 2*num_qubits);
 
     if (outcome) {
       if (b != outcome.value()) {
@@ -787,34 +1543,246 @@ MeasurementData TableauSIMD::mzr(uint32_t a, std::optional<bool> outcome) {
     return {b, 1.0};
   }
 }
-#else
-// Dummy implementation for when AVX2 is not available
-TableauSIMD::TableauSIMD(uint32_t num_qubits) {
-  throw std::runtime_error("Cannot create a SIMD Tableau without AVX2 instructions.");
-}
-Pauli TableauSIMD::get_pauli(size_t i, size_t j) const {}
-PauliString TableauSIMD::get_stabilizer(size_t i) const {}
-PauliString TableauSIMD::get_destabilizer(size_t i) const {}
-uint8_t TableauSIMD::get_phase(size_t i) const {}
-void TableauSIMD::reset(int i) {}
-void TableauSIMD::rowsum(int i, int j) {}
-TableauSIMD::~TableauSIMD() {}
-bool TableauSIMD::operator==(TableauSIMD& other) {}
-void TableauSIMD::rref(const Qubits& sites) {}
-void TableauSIMD::xrref(const Qubits& sites) {}
-uint32_t TableauSIMD::xrank(const Qubits& sites) {}
-uint32_t TableauSIMD::rank(const Qubits& sites) {}
-void TableauSIMD::rref() {}
-void TableauSIMD::xrref() {}
-uint32_t TableauSIMD::rank() {}
-uint32_t TableauSIMD::xrank() {}
-double TableauSIMD::bitstring_amplitude(const BitString& bits) {}
-std::string TableauSIMD::to_string(bool print_destabilizers) const {}
-std::string TableauSIMD::to_string_ops(bool print_destabilizers) const {}
-void TableauSIMD::h(uint32_t a) {}
-void TableauSIMD::s(uint32_t a) {}
-void TableauSIMD::cx(uint32_t a, uint32_t b) {}
-std::pair<bool, uint32_t> TableauSIMD::mzr_deterministic(uint32_t a) const {}
-void TableauSIMD::swap(size_t i, size_t j) {}
-MeasurementData TableauSIMD::mzr(uint32_t a, std::optional<bool> outcome) {}
-#endif
+
+void TableauSIMD::stabilizer_rowsum(uint32_t i, uint32_t j) {
+  rowsum(i + num_qubits, j + num_qubits);
+  rowsum(j, i);
+}
+
+void TableauSIMD::stabilizer_swap(uint32_t i, uint32_t j) {
+  swap(i + num_qubits, j + num_qubits);
+  swap(i, j);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+MixedTableau::MixedTableau(uint32_t num_qubits, size_t num_rows) : num_qubits(num_qubits) {
+  width = (get_width(2*num_qubits) + ROW_WORDS - 1) / ROW_WORDS * ROW_WORDS;
+  slab = AlignedWords(num_rows*width, 0u);
+  phase = std::vector<binary_word>(get_width(num_rows), 0u);
+}
+
+MixedTableau::MixedTableau(uint32_t num_qubits, const std::vector<PauliString>& stabilizers) : MixedTableau(num_qubits, stabilizers.size()) {
+  for (size_t i = 0; i < stabilizers.size(); i++) {
+    const PauliString& stabilizer = stabilizers[i];
+    if (stabilizer.num_qubits != num_qubits) {
+      throw std::invalid_argument(std::format("Cannot add a {}-qubit stabilizer to a MixedTableau of {} qubits.", stabilizer.num_qubits, num_qubits));
+    }
+
+    if (stabilizer.get_r() % 2) {
+      throw std::invalid_argument(std::format("Stabilizer {} is not Hermitian.", stabilizer.to_string()));
+    }
+
+    std::copy(stabilizer.bit_string.bits.begin(), stabilizer.bit_string.bits.end(), row(i));
+    _set(phase.data(), i, stabilizer.get_r() == 2);
+  }
+
+  std::vector<uint32_t> columns(2*num_qubits);
+  std::iota(columns.begin(), columns.end(), 0);
+  pivots = eliminate(stabilizers.size(), columns);
+  slab.resize(pivots.size()*width);
+}
+
+void MixedTableau::rowsum(size_t i, size_t j) {
+  int s = 2*_get(phase.data(), i) + 2*_get(phase.data(), j) + tableau_kernels().rowsum(row(i), row(j), width);
+  _set(phase.data(), i, (s % 4 + 4) % 4 == 2);
+}
+
+void MixedTableau::swap(size_t i, size_t j) {
+  if (i == j) {
+    return;
+  }
+
+  std::swap_ranges(row(i), row(i) + width, row(j));
+  binary_word pi = _get(phase.data(), i);
+  _set(phase.data(), i, _get(phase.data(), j));
+  _set(phase.data(), j, pi);
+}
+
+std::vector<uint32_t> MixedTableau::eliminate(size_t num_rows, const std::vector<uint32_t>& columns) {
+  std::vector<uint32_t> pivot_columns;
+  size_t r = 0;
+  for (uint32_t c : columns) {
+    if (r == num_rows) {
+      break;
+    }
+
+    size_t p = r;
+    while (p < num_rows && !_get(row(p), c)) {
+      p++;
+    }
+
+    if (p == num_rows) {
+      continue;
+    }
+
+    swap(r, p);
+    for (size_t i = r + 1; i < num_rows; i++) {
+      if (_get(row(i), c)) {
+        rowsum(i, r);
+      }
+    }
+
+    pivot_columns.push_back(c);
+    r++;
+  }
+
+  return pivot_columns;
+}
+
+PauliString MixedTableau::get_stabilizer(size_t i) const {
+  PauliString stabilizer(num_qubits);
+  std::copy(row(i), row(i) + stabilizer.bit_string.bits.size(), stabilizer.bit_string.bits.begin());
+  stabilizer.set_r(2*_get(phase.data(), i));
+  return stabilizer;
+}
+
+MixedTableau MixedTableau::partial_trace(const Qubits& qubits) const {
+  for (uint32_t q : qubits) {
+    if (q >= num_qubits) {
+      throw std::invalid_argument(std::format("Cannot trace out qubit {} of a MixedTableau of {} qubits.", q, num_qubits));
+    }
+  }
+
+  MixedTableau tableau = *this;
+  std::vector<uint32_t> columns;
+  for (uint32_t q : qubits) {
+    columns.push_back(2*q);
+    columns.push_back(2*q + 1);
+  }
+  size_t num_traced = tableau.eliminate(num_stabilizers(), columns).size();
+
+  Qubits qubits_complement = to_qubits(support_complement(qubits, num_qubits));
+  bool contiguous = qubits_ascending_contiguous(qubits_complement);
+
+  MixedTableau reduced(qubits_complement.size(), num_stabilizers() - num_traced);
+  for (size_t i = num_traced; i < num_stabilizers(); i++) {
+    pack_paulis(tableau.row(i), tableau.width, qubits_complement, contiguous, false, reduced.row(i - num_traced));
+    _set(reduced.phase.data(), i - num_traced, _get(tableau.phase.data(), i));
+  }
+
+  std::vector<uint32_t> reduced_columns(2*reduced.num_qubits);
+  std::iota(reduced_columns.begin(), reduced_columns.end(), 0);
+  reduced.pivots = reduced.eliminate(num_stabilizers() - num_traced, reduced_columns);
+
+  return reduced;
+}
+
+uint32_t MixedTableau::rank(const Qubits& sites) const {
+  thread_local BinaryMatrix scratch;
+  scratch.resize(num_stabilizers(), 2*sites.size());
+  bool contiguous = qubits_ascending_contiguous(sites);
+  for (size_t i = 0; i < num_stabilizers(); i++) {
+    pack_paulis(row(i), width, sites, contiguous, false, scratch.row(i));
+  }
+
+  return scratch.rank();
+}
+
+double MixedTableau::entropy() const {
+  return static_cast<double>(num_qubits - num_stabilizers());
+}
+
+double MixedTableau::entropy(const Qubits& sites) const {
+  Qubits qubits_complement = to_qubits(support_complement(sites, num_qubits));
+  int s = static_cast<int>(sites.size()) - static_cast<int>(num_stabilizers()) + static_cast<int>(rank(qubits_complement));
+  return static_cast<double>(s);
+}
+
+double MixedTableau::purity() const {
+  return std::pow(2.0, -entropy());
+}
+
+std::complex<double> MixedTableau::expectation(const PauliString& pauli) const {
+  if (pauli.num_qubits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a {}-qubit Pauli on a MixedTableau of {} qubits.", pauli.num_qubits, num_qubits));
+  }
+
+  // Reduce the Pauli against the echelon rows, multiplying the rows used into product
+  thread_local AlignedWords residual;
+  thread_local AlignedWords product;
+  residual.assign(width, 0u);
+  product.assign(width, 0u);
+  std::copy(pauli.bit_string.bits.begin(), pauli.bit_string.bits.end(), residual.begin());
+
+  int s = 0;
+  for (size_t r = 0; r < num_stabilizers(); r++) {
+    if (_get(residual.data(), pivots[r])) {
+      const binary_word* stabilizer = row(r);
+      for (size_t k = pivots[r] / binary_word_size(); k < width; k++) {
+        residual[k] ^= stabilizer[k];
+      }
+      s += 2*_get(phase.data(), r) + tableau_kernels().rowsum(product.data(), stabilizer, width);
+    }
+  }
+
+  if (std::ranges::any_of(residual, [](binary_word w) { return w != 0; })) {
+    return 0.0;
+  }
+
+  return sign_from_bits(((pauli.get_r() - s) % 4 + 4) % 4);
+}
+
+std::pair<MixedTableau, size_t> MixedTableau::diagonal_stabilizers() const {
+  MixedTableau tableau = *this;
+  std::vector<uint32_t> columns(num_qubits);
+  for (uint32_t q = 0; q < num_qubits; q++) {
+    columns[q] = 2*q;
+  }
+
+  size_t num_x = tableau.eliminate(num_stabilizers(), columns).size();
+  return {tableau, num_x};
+}
+
+// bits is in the support if every diagonal stabilizer (-1)^p Z^z acts on it as +1, i.e. p = z.bits mod 2. 
+// The support then has 2^(n - k + k_z) elements for k_z diagonal stabilizers, over which rho is uniform.
+static double diagonal_probability(const MixedTableau& diagonal, size_t begin, const BitString& bits) {
+  for (size_t r = begin; r < diagonal.num_stabilizers(); r++) {
+    bool parity = _get(diagonal.phase.data(), r);
+    for (uint32_t q = 0; q < diagonal.num_qubits; q++) {
+      parity ^= _get(diagonal.row(r), 2*q + 1) && bits.get(q);
+    }
+
+    if (parity) {
+      return 0.0;
+    }
+  }
+
+  size_t num_diagonal = diagonal.num_stabilizers() - begin;
+  return std::pow(2.0, static_cast<double>(num_diagonal) - static_cast<double>(diagonal.num_qubits));
+}
+
+double MixedTableau::probability(const BitString& bits) const {
+  if (bits.num_bits != num_qubits) {
+    throw std::invalid_argument(std::format("Cannot evaluate a bitstring of {} bits on a MixedTableau of {} qubits.", bits.num_bits, num_qubits));
+  }
+
+  auto [diagonal, begin] = diagonal_stabilizers();
+  return diagonal_probability(diagonal, begin, bits);
+}
+
+std::vector<double> MixedTableau::probabilities() const {
+  if (num_qubits > 15) {
+    throw std::runtime_error(std::format("Cannot evaluate the probabilities() of a {} > 15 qubit state.", num_qubits));
+  }
+
+  auto [diagonal, begin] = diagonal_stabilizers();
+  size_t b = 1u << num_qubits;
+  std::vector<double> probs(b);
+  for (size_t z = 0; z < b; z++) {
+    probs[z] = diagonal_probability(diagonal, begin, BitString::from_bits(num_qubits, z));
+  }
+
+  return probs;
+}
+
+std::string MixedTableau::to_string() const {
+  std::string s = "[";
+  for (size_t i = 0; i < num_stabilizers(); i++) {
+    s += (i == 0) ? "" : "\n ";
+    s += get_stabilizer(i).to_string();
+  }
+  s += "]";
+
+  return s;
+}
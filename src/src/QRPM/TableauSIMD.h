@@ -10,18 +10,47 @@
 #include "QuantumCircuit.h"
 
 #include "Tableau.h"
+#include "BinaryMatrix.hpp"
 
+using AlignedWords = std::vector<binary_word, AlignedAllocator<binary_word, 64>>;
+
+// The tableau is stored in a single 64-byte aligned slab of (2n+1) rows of width words each; row i
+// holds the interleaved x/z bits of destabilizer i (i < n), stabilizer i - n (n <= i < 2n), or the
+// scratch row 2n. Optionally, gates are applied on a qubit-major (transposed) copy instead, in which
+// the x and z bits of a qubit across all rows are contiguous words. The two layouts are converted
+// lazily: gates move the tableau to the columns, while rowsum-based operations (measurement, rref)
+// move it back to the rows. Single-bit accessors and the const rank methods read either layout.
 class TableauSIMD : public TableauBase {
   public:
+    // Words per row, padded to a whole number of 512-bit vectors
     uint32_t width;
-    std::vector<binary_word*> rows;
+    AlignedWords slab;
 
-    // pwidth may be one longer
+    // Words per column (and of the phase vector)
     uint32_t pwidth;
-    binary_word* phase;
+    AlignedWords columns;
+    std::vector<binary_word> phase;
+
+    bool column_major;
+    bool transposed;
 
     TableauSIMD()=default;
-    ~TableauSIMD();
+
+    inline binary_word* row(size_t i) {
+      return slab.data() + i*width;
+    }
+
+    inline const binary_word* row(size_t i) const {
+      return slab.data() + i*width;
+    }
+
+    inline binary_word* column(size_t j) {
+      return columns.data() + j*pwidth;
+    }
+
+    inline const binary_word* column(size_t j) const {
+      return columns.data() + j*pwidth;
+    }
 
     void set(size_t i, size_t j, binary_word v);
     bool get(size_t i, size_t j) const;
@@ -29,14 +58,34 @@ class TableauSIMD : public TableauBase {
     void rowsum(int i, int j);
     void swap(size_t i, size_t j);
     inline uint8_t get_xz(int i, int j) const {
+      if (transposed) {
+        constexpr size_t word_size = binary_word_size();
+        const binary_word* x = column(2*j);
+        const binary_word* z = column(2*j + 1);
+        uint8_t xi = (x[i / word_size] >> (i % word_size)) & 1u;
+        uint8_t zi = (z[i / word_size] >> (i % word_size)) & 1u;
+        return xi | (zi << 1u);
+      }
+
       constexpr uint32_t num_paulis = binary_word_size()/2;
       uint32_t bit_ind = 2u*(j % num_paulis);
-      return 0u | (((rows[i][j / num_paulis] >> bit_ind) & 3u) << 0u);
+      return 0u | (((row(i)[j / num_paulis] >> bit_ind) & 3u) << 0u);
     }
 
+    // Switch the storage between the row-major and qubit-major layouts
+    void to_rows();
+    void to_columns();
+
+    // Apply gates on the qubit-major layout. Worthwhile when long runs of gates are interleaved with few measurements.
+    void set_column_major(bool column_major);
+
     virtual uint8_t get_phase(size_t i) const override;
 
-    TableauSIMD(uint32_t num_qubits);
+    TableauSIMD(uint32_t num_qubits, bool column_major=false);
+
+    // The row kernels (rowsum, h, s, cx) exist in scalar, AVX2 and AVX-512 (with VPOPCNTDQ) versions; 
+    // the widest one supported by the CPU is chosen at runtime. Returns "scalar", "avx2" or "avx512".
+    static std::string instruction_set();
 
     virtual Pauli get_pauli(size_t i, size_t j) const override;
     virtual PauliString get_stabilizer(size_t i) const override;
@@ -44,30 +93,119 @@ class TableauSIMD : public TableauBase {
 
     bool operator==(TableauSIMD& other);
 
+    virtual std::unique_ptr<TableauBase> clone() const override;
+    virtual void write_snapshot(SnapshotWriter& writer) const override;
+    virtual void read_snapshot(SnapshotReader& reader) override;
+
     // Put tableau into reduced row echelon form
     virtual void rref(const Qubits& sites) override;
     virtual void rref() override;
-    virtual uint32_t rank(const Qubits& sites) override;
-    virtual uint32_t rank() override;
+    virtual uint32_t rank(const Qubits& sites) const override;
+    virtual uint32_t rank() const override;
     virtual void xrref(const Qubits& sites) override;
     virtual void xrref() override;
-    virtual uint32_t xrank(const Qubits& sites) override;
-    virtual uint32_t xrank() override;
+    virtual uint32_t xrank(const Qubits& sites) const override;
+    virtual uint32_t xrank() const override;
+    virtual std::vector<uint32_t> endpoint_counts() const override;
 
     //TableauSIMD partial_trace(const Qubits& qubits);
 
     virtual double bitstring_amplitude(const BitString& bits) override;
 
+    // Anticommutation with every row is found by word-level popcounts (or from the columns of the qubit-major
+    // layout), and the sign from a rowsum of the selected stabilizers into scratch space. The batched form 
+    // tests each row against all terms of the observable while it is in cache.
+    virtual std::complex<double> expectation(const PauliString& pauli) const override;
+    virtual std::complex<double> expectation(const SparsePauliObs& obs) const override;
+
     virtual std::string to_string(bool print_destabilizers=true) const override;
     virtual std::string to_string_ops(bool print_destabilizers=true) const override;
 
     virtual void h(uint32_t a) override;
     virtual void s(uint32_t a) override;
     virtual void cx(uint32_t a, uint32_t b) override;
+    virtual void apply_layer(std::span<const CliffordOp> ops) override;
+    virtual void apply_clifford(const CliffordOp& op) override;
+
+    // The x bits of qubit a over rows [0, 2n), packed into a bit vector. In the row-major layout they
+    // are gathered into buffer, otherwise the column is returned directly.
+    const binary_word* x_column(uint32_t a, std::vector<binary_word>& buffer) const;
 
     // Returns a pair containing (1) wether the outcome of a measurement on qubit a is deterministic
     // and (2) the index on which the CHP algorithm performs rowsum if the mzr is random
     virtual std::pair<bool, uint32_t> mzr_deterministic(uint32_t a) const override;
 
     virtual MeasurementData mzr(uint32_t a, std::optional<bool> outcome=std::nullopt) override;
+
+    virtual void stabilizer_rowsum(uint32_t i, uint32_t j) override;
+    virtual void stabilizer_swap(uint32_t i, uint32_t j) override;
+};
+
+// A mixed stabilizer state rho = 2^-n prod_i (1 + g_i) of k <= n independent, commuting stabilizers g_i, 
+// as the reduced state of a pure tableau on a region. The stabilizers are packed rows in the layout of 
+// TableauSIMD, with no destabilizers, and are kept in row echelon form over the columns (x_0, z_0, x_1, ...): 
+// pivots[i] is the leading column of row i. Whether a Pauli belongs to the stabilizer group is then decided 
+// by a single pass over the rows, and no density matrix is ever formed.
+class MixedTableau {
+  public:
+    uint32_t num_qubits;
+    uint32_t width;
+    AlignedWords slab;
+    std::vector<binary_word> phase;
+    std::vector<uint32_t> pivots;
+
+    MixedTableau()=default;
+
+    // The state stabilized by stabilizers, which need not be independent; redundant rows are dropped
+    MixedTableau(uint32_t num_qubits, const std::vector<PauliString>& stabilizers);
+
+    inline binary_word* row(size_t i) {
+      return slab.data() + i*width;
+    }
+
+    inline const binary_word* row(size_t i) const {
+      return slab.data() + i*width;
+    }
+
+    inline uint32_t num_stabilizers() const {
+      return pivots.size();
+    }
+
+    PauliString get_stabilizer(size_t i) const;
+
+    // The state on the complement of qubits. The stabilizers are eliminated on the columns of qubits, after
+    // which the rows which vanish there generate the stabilizer group of the reduced state; O(n^3/64).
+    MixedTableau partial_trace(const Qubits& qubits) const;
+
+    // Rank of the stabilizer group restricted to sites
+    uint32_t rank(const Qubits& sites) const;
+
+    // Entropy in bits; every Renyi entropy of a stabilizer state is equal. S(A) = |A| - k + rank on the 
+    // complement of A, which is the number of independent stabilizers supported entirely within A.
+    double entropy() const;
+    double entropy(const Qubits& sites) const;
+    double purity() const;
+
+    // tr(rho P), which vanishes unless P is, up to sign, in the stabilizer group
+    std::complex<double> expectation(const PauliString& pauli) const;
+
+    // Computational basis probabilities from the stabilizers without x-part, which fix the parities of the 
+    // bitstrings in the support of rho. probabilities() eliminates once for all 2^n bitstrings.
+    double probability(const BitString& bits) const;
+    std::vector<double> probabilities() const;
+
+    std::string to_string() const;
+
+  private:
+    MixedTableau(uint32_t num_qubits, size_t num_rows);
+
+    void rowsum(size_t i, size_t j);
+    void swap(size_t i, size_t j);
+
+    // Forward elimination of rows [0, num_rows) over the given columns in order. The pivot rows are moved 
+    // to the front, and the pivot columns are returned.
+    std::vector<uint32_t> eliminate(size_t num_rows, const std::vector<uint32_t>& columns);
+
+    // The rows without x-part, as the tail of a copy eliminated on the x columns
+    std::pair<MixedTableau, size_t> diagonal_stabilizers() const;
 };
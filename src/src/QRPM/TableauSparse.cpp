@@ -0,0 +1,733 @@
+#include "TableauSparse.h"
+#include "BinaryMatrix.hpp"
+
+#include <bit>
+
+constexpr uint32_t NUM_PAULIS = binary_word_size()/2;
+
+TableauSparse::TableauSparse(uint32_t num_qubits) : TableauBase(num_qubits), num_words(0) {
+  width = (2*num_qubits + binary_word_size() - 1) / binary_word_size();
+  rows = std::vector<SparseRow>(2*num_qubits + 1);
+  phase = std::vector<uint8_t>(2*num_qubits + 1, 0u);
+  qubit_rows = std::vector<std::vector<uint32_t>>(num_qubits);
+
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    set(i, 2*i, true);
+    set(i + num_qubits, 2*i+1, true);
+  }
+}
+
+TableauSparse::TableauSparse(const TableauSIMD& tableau) : TableauSparse(tableau.num_qubits) {
+  for (size_t i = 0; i < 2*num_qubits; i++) {
+    reset(i);
+    if (tableau.transposed) {
+      for (uint32_t q = 0; q < num_qubits; q++) {
+        binary_word xz = tableau.get_xz(i, q);
+        if (xz) {
+          set_word(i, q / NUM_PAULIS, word(i, q / NUM_PAULIS) | (xz << (2*(q % NUM_PAULIS))));
+        }
+      }
+    } else {
+      const binary_word* r = tableau.row(i);
+      for (uint32_t k = 0; k < width; k++) {
+        if (r[k]) {
+          set_word(i, k, r[k]);
+        }
+      }
+    }
+
+    phase[i] = (tableau.phase[i / binary_word_size()] >> (i % binary_word_size())) & 1u;
+  }
+}
+
+std::unique_ptr<TableauBase> TableauSparse::clone() const {
+  return std::make_unique<TableauSparse>(*this);
+}
+
+// The per-qubit index is not written; it is rebuilt from the supports of the rows
+void TableauSparse::write_snapshot(SnapshotWriter& writer) const {
+  for (const SparseRow& r : rows) {
+    writer.write_array(r.blocks);
+    writer.write_array(r.words);
+  }
+  writer.write_array(phase);
+}
+
+void TableauSparse::read_snapshot(SnapshotReader& reader) {
+  rows = std::vector<SparseRow>(2*num_qubits + 1);
+  qubit_rows = std::vector<std::vector<uint32_t>>(num_qubits);
+  num_words = 0;
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    SparseRow& r = rows[i];
+    reader.read_array(r.blocks);
+    reader.read_array(r.words);
+    if (r.blocks.size() != r.words.size()) {
+      throw std::runtime_error(std::format("Snapshot row {} has {} blocks but {} words.", i, r.blocks.size(), r.words.size()));
+    }
+
+    if (i < 2*num_qubits) {
+      for (size_t k = 0; k < r.blocks.size(); k++) {
+        if (r.blocks[k] >= width) {
+          throw std::runtime_error(std::format("Snapshot row {} has a word at block {} of {}.", i, r.blocks[k], width));
+        }
+        update_index(i, r.blocks[k], 0u, r.words[k]);
+      }
+      num_words += r.blocks.size();
+    }
+  }
+
+  reader.read_into(std::span<uint8_t>(phase));
+}
+
+TableauSIMD TableauSparse::to_dense() const {
+  TableauSIMD tableau(num_qubits);
+  std::fill(tableau.slab.begin(), tableau.slab.end(), 0u);
+
+  for (size_t i = 0; i < 2*num_qubits; i++) {
+    const SparseRow& r = rows[i];
+    binary_word* dst = tableau.row(i);
+    for (size_t k = 0; k < r.blocks.size(); k++) {
+      dst[r.blocks[k]] = r.words[k];
+    }
+
+    tableau.phase[i / binary_word_size()] |= static_cast<binary_word>(phase[i]) << (i % binary_word_size());
+  }
+
+  return tableau;
+}
+
+double TableauSparse::fill() const {
+  return static_cast<double>(num_words) / (2.0*num_qubits*width);
+}
+
+double TableauSparse::fill(const TableauSIMD& tableau) {
+  uint32_t num_qubits = tableau.num_qubits;
+  size_t width = (2*num_qubits + binary_word_size() - 1) / binary_word_size();
+  size_t nonzero = 0;
+
+  for (size_t i = 0; i < 2*num_qubits; i++) {
+    if (tableau.transposed) {
+      for (size_t k = 0; k < width; k++) {
+        size_t end = std::min<size_t>(num_qubits, (k + 1)*NUM_PAULIS);
+        for (size_t q = k*NUM_PAULIS; q < end; q++) {
+          if (tableau.get_xz(i, q)) {
+            nonzero++;
+            break;
+          }
+        }
+      }
+    } else {
+      const binary_word* r = tableau.row(i);
+      nonzero += std::count_if(r, r + width, [](binary_word w) { return w != 0; });
+    }
+  }
+
+  return static_cast<double>(nonzero) / (2.0*num_qubits*width);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Row storage. Every change to a word of rows [0, 2n) goes through set_word, which keeps the
+// per-qubit index and the word count up to date; the scratch row 2n is not indexed.
+// ------------------------------------------------------------------------------------------------
+
+binary_word TableauSparse::word(size_t i, uint32_t block) const {
+  const SparseRow& r = rows[i];
+  auto it = std::lower_bound(r.blocks.begin(), r.blocks.end(), block);
+  if (it == r.blocks.end() || *it != block) {
+    return 0u;
+  }
+  return r.words[it - r.blocks.begin()];
+}
+
+void TableauSparse::update_index(size_t i, uint32_t block, binary_word old_word, binary_word new_word) {
+  binary_word old_support = (old_word | (old_word >> 1)) & EVEN_BITS;
+  binary_word new_support = (new_word | (new_word >> 1)) & EVEN_BITS;
+  binary_word added = new_support & ~old_support;
+  binary_word removed = old_support & ~new_support;
+
+  while (added) {
+    uint32_t q = block*NUM_PAULIS + std::countr_zero(added)/2;
+    qubit_rows[q].push_back(i);
+    added &= added - 1;
+  }
+
+  while (removed) {
+    uint32_t q = block*NUM_PAULIS + std::countr_zero(removed)/2;
+    std::vector<uint32_t>& indexed = qubit_rows[q];
+    *std::find(indexed.begin(), indexed.end(), i) = indexed.back();
+    indexed.pop_back();
+    removed &= removed - 1;
+  }
+}
+
+void TableauSparse::set_word(size_t i, uint32_t block, binary_word w) {
+  SparseRow& r = rows[i];
+  auto it = std::lower_bound(r.blocks.begin(), r.blocks.end(), block);
+  size_t k = it - r.blocks.begin();
+  bool present = it != r.blocks.end() && *it == block;
+  binary_word old_word = present ? r.words[k] : 0u;
+  if (old_word == w) {
+    return;
+  }
+
+  bool indexed = i < 2*num_qubits;
+  if (indexed) {
+    update_index(i, block, old_word, w);
+  }
+
+  if (!present) {
+    r.blocks.insert(it, block);
+    r.words.insert(r.words.begin() + k, w);
+    num_words += indexed;
+  } else if (w) {
+    r.words[k] = w;
+  } else {
+    r.blocks.erase(it);
+    r.words.erase(r.words.begin() + k);
+    num_words -= indexed;
+  }
+}
+
+bool TableauSparse::get(size_t i, size_t j) const {
+  return (word(i, j / binary_word_size()) >> (j % binary_word_size())) & 1u;
+}
+
+void TableauSparse::set(size_t i, size_t j, binary_word v) {
+  uint32_t block = j / binary_word_size();
+  size_t bit_ind = j % binary_word_size();
+  set_word(i, block, (word(i, block) & ~(static_cast<binary_word>(1) << bit_ind)) | (v << bit_ind));
+}
+
+void TableauSparse::reset(size_t i) {
+  SparseRow& r = rows[i];
+  if (i < 2*num_qubits) {
+    for (size_t k = 0; k < r.blocks.size(); k++) {
+      update_index(i, r.blocks[k], r.words[k], 0u);
+    }
+    num_words -= r.blocks.size();
+  }
+
+  r.blocks.clear();
+  r.words.clear();
+  phase[i] = 0;
+}
+
+// Merges row j into row i; only the words present in both rows contribute to the phase
+void TableauSparse::rowsum(size_t i, size_t j) {
+  thread_local SparseRow merged;
+  merged.blocks.clear();
+  merged.words.clear();
+
+  SparseRow& dst = rows[i];
+  const SparseRow& src = rows[j];
+  bool indexed = i < 2*num_qubits;
+
+  int s = 0;
+  size_t p = 0;
+  size_t q = 0;
+  while (p < dst.blocks.size() || q < src.blocks.size()) {
+    if (q == src.blocks.size() || (p < dst.blocks.size() && dst.blocks[p] < src.blocks[q])) {
+      merged.blocks.push_back(dst.blocks[p]);
+      merged.words.push_back(dst.words[p]);
+      p++;
+    } else if (p == dst.blocks.size() || src.blocks[q] < dst.blocks[p]) {
+      if (indexed) {
+        update_index(i, src.blocks[q], 0u, src.words[q]);
+      }
+      merged.blocks.push_back(src.blocks[q]);
+      merged.words.push_back(src.words[q]);
+      q++;
+    } else {
+      binary_word x1 = src.words[q] & EVEN_BITS;
+      binary_word z1 = (src.words[q] >> 1) & EVEN_BITS;
+      binary_word x2 = dst.words[p] & EVEN_BITS;
+      binary_word z2 = (dst.words[p] >> 1) & EVEN_BITS;
+
+      binary_word plus, minus;
+      phase_counts(x1, z1, x2, z2, plus, minus);
+      s += std::popcount(plus) - std::popcount(minus);
+
+      binary_word w = dst.words[p] ^ src.words[q];
+      if (indexed) {
+        update_index(i, dst.blocks[p], dst.words[p], w);
+      }
+      if (w) {
+        merged.blocks.push_back(dst.blocks[p]);
+        merged.words.push_back(w);
+      }
+      p++;
+      q++;
+    }
+  }
+
+  if (indexed) {
+    num_words += merged.blocks.size();
+    num_words -= dst.blocks.size();
+  }
+  std::swap(dst.blocks, merged.blocks);
+  std::swap(dst.words, merged.words);
+
+  s += 2*phase[i] + 2*phase[j];
+  phase[i] = (s % 4 + 4) % 4 == 2;
+}
+
+void TableauSparse::swap(size_t i, size_t j) {
+  if (i == j) {
+    return;
+  }
+
+  auto reindex = [this](size_t r, bool remove) {
+    if (r < 2*num_qubits) {
+      const SparseRow& row = rows[r];
+      for (size_t k = 0; k < row.blocks.size(); k++) {
+        update_index(r, row.blocks[k], remove ? row.words[k] : 0u, remove ? 0u : row.words[k]);
+      }
+      if (remove) {
+        num_words -= row.blocks.size();
+      } else {
+        num_words += row.blocks.size();
+      }
+    }
+  };
+
+  reindex(i, true);
+  reindex(j, true);
+  std::swap(rows[i], rows[j]);
+  std::swap(phase[i], phase[j]);
+  reindex(i, false);
+  reindex(j, false);
+}
+
+Pauli TableauSparse::get_pauli(size_t i, size_t j) const {
+  return static_cast<Pauli>((word(i + num_qubits, j / NUM_PAULIS) >> (2*(j % NUM_PAULIS))) & 3u);
+}
+
+static PauliString row_to_pauli(const TableauSparse::SparseRow& r, uint32_t num_qubits, uint8_t phase) {
+  std::vector<Pauli> paulis(num_qubits, Pauli::I);
+  for (size_t k = 0; k < r.blocks.size(); k++) {
+    binary_word support = (r.words[k] | (r.words[k] >> 1)) & EVEN_BITS;
+    while (support) {
+      uint32_t b = std::countr_zero(support);
+      paulis[r.blocks[k]*NUM_PAULIS + b/2] = static_cast<Pauli>((r.words[k] >> b) & 3u);
+      support &= support - 1;
+    }
+  }
+
+  return PauliString(paulis, 2*phase);
+}
+
+PauliString TableauSparse::get_stabilizer(size_t i) const {
+  return row_to_pauli(rows[i + num_qubits], num_qubits, phase[i + num_qubits]);
+}
+
+PauliString TableauSparse::get_destabilizer(size_t i) const {
+  return row_to_pauli(rows[i], num_qubits, phase[i]);
+}
+
+uint8_t TableauSparse::get_phase(size_t i) const {
+  return 2*phase[i + num_qubits];
+}
+
+// Same elimination as TableauSIMD::rref, but the rows carrying each pivot column are found through
+// the qubit index instead of by scanning every stabilizer
+void TableauSparse::rref_impl(const Qubits& sites, bool x_only) {
+  thread_local std::vector<uint32_t> carriers;
+  uint32_t row = num_qubits;
+
+  auto find_carriers = [&](uint32_t c, size_t j) {
+    carriers.clear();
+    for (uint32_t i : qubit_rows[c]) {
+      if (i >= num_qubits && get(i, j)) {
+        carriers.push_back(i);
+      }
+    }
+    std::sort(carriers.begin(), carriers.end());
+  };
+
+  for (uint32_t k = 0; k < 2*sites.size(); k++) {
+    uint32_t c = sites[k % sites.size()];
+    bool z = k < sites.size();
+    if (z && x_only) {
+      continue;
+    }
+
+    size_t j = z ? 2*c+1 : 2*c;
+    find_carriers(c, j);
+    auto pivot = std::lower_bound(carriers.begin(), carriers.end(), row);
+    if (pivot == carriers.end()) {
+      continue;
+    }
+
+    uint32_t pivot_row = *pivot;
+    swap(row, pivot_row);
+    swap(row - num_qubits, pivot_row - num_qubits);
+
+    find_carriers(c, j);
+    for (uint32_t i : carriers) {
+      if (i == row) {
+        continue;
+      }
+
+      rowsum(i, row);
+      rowsum(row - num_qubits, i - num_qubits);
+    }
+
+    row += 1;
+  }
+}
+
+void TableauSparse::rref(const Qubits& sites) {
+  rref_impl(sites, false);
+}
+
+void TableauSparse::xrref(const Qubits& sites) {
+  rref_impl(sites, true);
+}
+
+void TableauSparse::rref() {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  rref(qubits);
+}
+
+void TableauSparse::xrref() {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  xrref(qubits);
+}
+
+// Scatters each stabilizer into a dense row and packs its restriction onto sites into a scratch matrix
+static uint32_t restricted_rank(const TableauSparse& tableau, const Qubits& sites, bool x_only) {
+  thread_local BinaryMatrix scratch;
+  thread_local std::vector<binary_word> buffer;
+  uint32_t num_qubits = tableau.num_qubits;
+
+  scratch.resize(num_qubits, x_only ? sites.size() : 2*sites.size());
+  buffer.assign(tableau.width, 0u);
+  bool contiguous = qubits_ascending_contiguous(sites);
+  for (uint32_t i = 0; i < num_qubits; i++) {
+    const TableauSparse::SparseRow& r = tableau.rows[i + num_qubits];
+    for (size_t k = 0; k < r.blocks.size(); k++) {
+      buffer[r.blocks[k]] = r.words[k];
+    }
+
+    pack_paulis(buffer.data(), tableau.width, sites, contiguous, x_only, scratch.row(i));
+
+    for (uint32_t block : r.blocks) {
+      buffer[block] = 0u;
+    }
+  }
+
+  return scratch.rank();
+}
+
+uint32_t TableauSparse::rank(const Qubits& sites) const {
+  return restricted_rank(*this, sites, false);
+}
+
+uint32_t TableauSparse::xrank(const Qubits& sites) const {
+  return restricted_rank(*this, sites, true);
+}
+
+uint32_t TableauSparse::rank() const {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return rank(qubits);
+}
+
+uint32_t TableauSparse::xrank() const {
+  std::vector<uint32_t> qubits(num_qubits);
+  std::iota(qubits.begin(), qubits.end(), 0);
+  return xrank(qubits);
+}
+
+std::vector<uint32_t> TableauSparse::endpoint_counts() const {
+  thread_local BinaryMatrix scratch;
+  scratch.resize(num_qubits, 2*num_qubits);
+
+  for (size_t i = 0; i < num_qubits; i++) {
+    const SparseRow& r = rows[i + num_qubits];
+    for (size_t k = 0; k < r.blocks.size(); k++) {
+      scratch.row(i)[r.blocks[k]] = r.words[k];
+    }
+  }
+
+  std::vector<uint32_t> counts(num_qubits);
+  for (uint32_t c : scratch.pivots()) {
+    counts[c / 2]++;
+  }
+  return counts;
+}
+
+double TableauSparse::bitstring_amplitude(const BitString& bits) {
+  if (bits.num_bits != num_qubits) {
+    throw std::runtime_error(std::format("Cannot evaluate a bitstring of {} bits on a TableauSparse of {} qubits.", bits.num_bits, num_qubits));
+  }
+
+  xrref();
+  double p = 1/std::pow(2.0, xrank());
+
+  for (size_t r = num_qubits; r < 2*num_qubits; r++) {
+    // Need to check that every z-only stabilizer g acts on |z> as g|z> = |z>.
+    const SparseRow& row = rows[r];
+    bool has_x = std::any_of(row.words.begin(), row.words.end(), [](binary_word w) { return w & EVEN_BITS; });
+    if (has_x) {
+      continue;
+    }
+
+    bool positive = true;
+    for (size_t k = 0; k < row.blocks.size(); k++) {
+      binary_word z = (row.words[k] >> 1) & EVEN_BITS;
+      while (z) {
+        if (bits.get(row.blocks[k]*NUM_PAULIS + std::countr_zero(z)/2)) {
+          positive = !positive;
+        }
+        z &= z - 1;
+      }
+    }
+
+    if (positive != (phase[r] == 0)) {
+      return 0.0;
+    }
+  }
+
+  return p;
+}
+
+std::string TableauSparse::to_string(bool print_destabilizers) const {
+  auto row_string = [this](size_t r) {
+    std::string s = phase[r] ? "-" : "+";
+    for (size_t j = 0; j < 2*num_qubits; j++) {
+      s += std::format("{}", get(r, j));
+    }
+    return s;
+  };
+
+  std::string s = "";
+  if (print_destabilizers) {
+    for (size_t i = 0; i < num_qubits; i++) {
+      s += (i == 0) ? "[" : " ";
+      s += row_string(i);
+      s += (i == num_qubits - 1) ? "]" : "\n";
+    }
+    s += "\n";
+  }
+
+  for (size_t i = num_qubits; i < 2*num_qubits; i++) {
+    s += (i == num_qubits) ? "[" : " ";
+    s += row_string(i);
+    s += (i == 2*num_qubits - 1) ? "]" : "\n";
+  }
+
+  return s;
+}
+
+std::string TableauSparse::to_string_ops(bool print_destabilizers) const {
+  auto row_string = [this](size_t r) {
+    constexpr char ops[4] = {'I', 'X', 'Z', 'Y'};
+    std::string s = phase[r] ? "-" : "+";
+    for (size_t j = 0; j < num_qubits; j++) {
+      s += ops[(word(r, j / NUM_PAULIS) >> (2*(j % NUM_PAULIS))) & 3u];
+    }
+    return s;
+  };
+
+  std::string s = "";
+  if (print_destabilizers) {
+    for (size_t i = 0; i < num_qubits; i++) {
+      s += (i == 0) ? "[" : " ";
+      s += row_string(i);
+      s += (i == num_qubits - 1) ? "]" : "\n";
+    }
+    s += "\n";
+  }
+
+  for (size_t i = num_qubits; i < 2*num_qubits; i++) {
+    s += (i == num_qubits) ? "[" : " ";
+    s += row_string(i);
+    s += (i == 2*num_qubits - 1) ? "]" : "\n";
+  }
+
+  return s;
+}
+
+template <typename F>
+void TableauSparse::update_rows(uint32_t a, uint32_t b, F&& f) {
+  uint32_t ka = a / NUM_PAULIS;
+  uint32_t kb = b / NUM_PAULIS;
+  uint32_t oa = 2*(a % NUM_PAULIS);
+  uint32_t ob = 2*(b % NUM_PAULIS);
+  bool two_qubit = a != b;
+
+  // Gates map I to I, so only rows supported on a or b change. Rows supported on both are
+  // listed under a; the index is copied since it changes as the rows are updated.
+  thread_local std::vector<uint32_t> targets;
+  targets.assign(qubit_rows[a].begin(), qubit_rows[a].end());
+  if (two_qubit) {
+    for (uint32_t i : qubit_rows[b]) {
+      if (!((word(i, ka) >> oa) & 3u)) {
+        targets.push_back(i);
+      }
+    }
+  }
+
+  binary_word mask_a = static_cast<binary_word>(3) << oa;
+  binary_word mask_b = static_cast<binary_word>(3) << ob;
+  for (uint32_t i : targets) {
+    binary_word wa = word(i, ka);
+    binary_word wb = (kb == ka) ? wa : word(i, kb);
+    uint8_t bits = (wa >> oa) & 3u;
+    if (two_qubit) {
+      bits |= ((wb >> ob) & 3u) << 2;
+    }
+
+    uint8_t v = f(bits);
+    phase[i] ^= v >> 4;
+
+    wa = (wa & ~mask_a) | (static_cast<binary_word>(v & 3u) << oa);
+    if (!two_qubit) {
+      set_word(i, ka, wa);
+    } else if (ka == kb) {
+      set_word(i, ka, (wa & ~mask_b) | (static_cast<binary_word>((v >> 2) & 3u) << ob));
+    } else {
+      set_word(i, ka, wa);
+      set_word(i, kb, (wb & ~mask_b) | (static_cast<binary_word>((v >> 2) & 3u) << ob));
+    }
+  }
+}
+
+void TableauSparse::h(uint32_t a) {
+  validate_qubit(a);
+  update_rows(a, a, [](uint8_t bits) {
+    uint8_t x = bits & 1u;
+    uint8_t z = (bits >> 1) & 1u;
+    return static_cast<uint8_t>(z | (x << 1) | ((x & z) << 4));
+  });
+}
+
+void TableauSparse::s(uint32_t a) {
+  validate_qubit(a);
+  update_rows(a, a, [](uint8_t bits) {
+    uint8_t x = bits & 1u;
+    uint8_t z = (bits >> 1) & 1u;
+    return static_cast<uint8_t>(x | ((x ^ z) << 1) | ((x & z) << 4));
+  });
+}
+
+void TableauSparse::cx(uint32_t a, uint32_t b) {
+  validate_qubit(a);
+  validate_qubit(b);
+  update_rows(a, b, [](uint8_t bits) {
+    uint8_t xa = bits & 1u;
+    uint8_t za = (bits >> 1) & 1u;
+    uint8_t xb = (bits >> 2) & 1u;
+    uint8_t zb = (bits >> 3) & 1u;
+    uint8_t flip = xa & zb & ~(xb ^ za) & 1u;
+    return static_cast<uint8_t>(xa | ((za ^ zb) << 1) | ((xb ^ xa) << 2) | (zb << 3) | (flip << 4));
+  });
+}
+
+void TableauSparse::apply_clifford(const CliffordOp& op) {
+  validate_qubit(op.qubits[0]);
+  validate_qubit(op.qubits[1]);
+  update_rows(op.qubits[0], op.qubits[1], [&op](uint8_t bits) { return op.apply(bits); });
+}
+
+// Each op only touches the rows supported on its qubits, so there is nothing to gain from a single pass
+void TableauSparse::apply_layer(std::span<const CliffordOp> ops) {
+  for (const CliffordOp& op : ops) {
+    apply_clifford(op);
+  }
+}
+
+std::pair<bool, uint32_t> TableauSparse::mzr_deterministic(uint32_t a) const {
+  uint32_t k = a / NUM_PAULIS;
+  uint32_t o = 2*(a % NUM_PAULIS);
+
+  size_t p = 2*num_qubits;
+  for (uint32_t i : qubit_rows[a]) {
+    if (i >= num_qubits && i < p && ((word(i, k) >> o) & 1u)) {
+      p = i;
+    }
+  }
+
+  if (p < 2*num_qubits) {
+    return std::pair(false, p);
+  }
+
+  return std::pair(true, 0);
+}
+
+MeasurementData TableauSparse::mzr(uint32_t a, std::optional<bool> outcome) {
+  validate_qubit(a);
+  uint32_t k = a / NUM_PAULIS;
+  uint32_t o = 2*(a % NUM_PAULIS);
+
+  // Rows with an x on qubit a, and the first such stabilizer as pivot, as in TableauSIMD::mzr
+  thread_local std::vector<uint32_t> x_rows;
+  x_rows.clear();
+  size_t p = 2*num_qubits;
+  for (uint32_t i : qubit_rows[a]) {
+    if ((word(i, k) >> o) & 1u) {
+      x_rows.push_back(i);
+      if (i >= num_qubits && i < p) {
+        p = i;
+      }
+    }
+  }
+
+  if (p < 2*num_qubits) {
+    bool b = outcome ? outcome.value() : randi() % 2;
+
+    for (uint32_t i : x_rows) {
+      if (i != p) {
+        rowsum(i, p);
+      }
+    }
+
+    swap(p, p - num_qubits);
+
+    reset(p);
+    phase[p] = b;
+    set(p, 2*a+1, true);
+
+    return {b, 0.5};
+  } else { // deterministic
+    reset(2*num_qubits);
+    for (uint32_t i : x_rows) {
+      rowsum(2*num_qubits, i + num_qubits);
+    }
+
+    bool b = phase[2*num_qubits];
+
+    if (outcome) {
+      if (b != outcome.value()) {
+        throw std::runtime_error("Invalid forced measurement of QuantumCHPState.");
+      }
+    }
+
+    return {b, 1.0};
+  }
+}
+
+void TableauSparse::stabilizer_rowsum(uint32_t i, uint32_t j) {
+  rowsum(i + num_qubits, j + num_qubits);
+  rowsum(j, i);
+}
+
+void TableauSparse::stabilizer_swap(uint32_t i, uint32_t j) {
+  swap(i + num_qubits, j + num_qubits);
+  swap(i, j);
+}
+
+double TableauSparse::sparsity() const {
+  size_t nonzero = 0;
+  for (size_t i = num_qubits; i < 2*num_qubits; i++) {
+    for (binary_word w : rows[i].words) {
+      nonzero += std::popcount(w);
+    }
+  }
+
+  return static_cast<double>(nonzero)/(2.0*num_qubits*num_qubits);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Tableau.h"
+#include "TableauSIMD.h"
+
+// Stores each row of the tableau as a sorted run of its nonzero words, using the same interleaved (x, z)
+// bit layout as TableauSIMD; rows [0, n) are destabilizers, [n, 2n) stabilizers and row 2n is scratch.
+// A per-qubit index lists the rows with support on each qubit, so that gates and measurements only visit
+// the rows they act on. For area-law states, where every row is supported on a few words, a gate costs
+// O(rows touching the qubit) rather than O(n), and a rowsum only merges the overlapping words. Once the
+// rows fill in, the dense TableauSIMD is faster; fill() tells when to convert with to_dense().
+class TableauSparse : public TableauBase {
+  public:
+    struct SparseRow {
+      std::vector<uint32_t> blocks;
+      std::vector<binary_word> words;
+    };
+
+    // Words of a dense row
+    uint32_t width;
+    std::vector<SparseRow> rows;
+    std::vector<uint8_t> phase;
+
+    // qubit_rows[q] holds the rows in [0, 2n) which are supported on qubit q, in no particular order
+    std::vector<std::vector<uint32_t>> qubit_rows;
+
+    // Total number of nonzero words over rows [0, 2n)
+    size_t num_words;
+
+    TableauSparse()=default;
+    TableauSparse(uint32_t num_qubits);
+    TableauSparse(const TableauSIMD& tableau);
+
+    TableauSIMD to_dense() const;
+
+    // Fraction of the words of rows [0, 2n) which are nonzero
+    double fill() const;
+
+    // The same quantity for a dense tableau, for deciding when to convert back
+    static double fill(const TableauSIMD& tableau);
+
+    virtual std::unique_ptr<TableauBase> clone() const override;
+    virtual void write_snapshot(SnapshotWriter& writer) const override;
+    virtual void read_snapshot(SnapshotReader& reader) override;
+
+    binary_word word(size_t i, uint32_t block) const;
+    void set_word(size_t i, uint32_t block, binary_word w);
+
+    bool get(size_t i, size_t j) const;
+    void set(size_t i, size_t j, binary_word v);
+    void reset(size_t i);
+    void rowsum(size_t i, size_t j);
+    void swap(size_t i, size_t j);
+
+    virtual Pauli get_pauli(size_t i, size_t j) const override;
+    virtual PauliString get_stabilizer(size_t i) const override;
+    virtual PauliString get_destabilizer(size_t i) const override;
+    virtual uint8_t get_phase(size_t i) const override;
+
+    // Put tableau into reduced row echelon form
+    virtual void rref(const Qubits& sites) override;
+    virtual void rref() override;
+    virtual uint32_t rank(const Qubits& sites) const override;
+    virtual uint32_t rank() const override;
+    virtual void xrref(const Qubits& sites) override;
+    virtual void xrref() override;
+    virtual uint32_t xrank(const Qubits& sites) const override;
+    virtual uint32_t xrank() const override;
+    virtual std::vector<uint32_t> endpoint_counts() const override;
+
+    virtual double bitstring_amplitude(const BitString& bits) override;
+
+    virtual std::string to_string(bool print_destabilizers=true) const override;
+    virtual std::string to_string_ops(bool print_destabilizers=true) const override;
+
+    virtual void h(uint32_t a) override;
+    virtual void s(uint32_t a) override;
+    virtual void cx(uint32_t a, uint32_t b) override;
+    virtual void apply_layer(std::span<const CliffordOp> ops) override;
+    virtual void apply_clifford(const CliffordOp& op) override;
+
+    // Returns a pair containing (1) wether the outcome of a measurement on qubit a is deterministic
+    // and (2) the index on which the CHP algorithm performs rowsum if the mzr is random
+    virtual std::pair<bool, uint32_t> mzr_deterministic(uint32_t a) const override;
+
+    virtual MeasurementData mzr(uint32_t a, std::optional<bool> outcome=std::nullopt) override;
+
+    virtual void stabilizer_rowsum(uint32_t i, uint32_t j) override;
+    virtual void stabilizer_swap(uint32_t i, uint32_t j) override;
+
+    virtual double sparsity() const override;
+
+  private:
+    void update_index(size_t i, uint32_t block, binary_word old_word, binary_word new_word);
+
+    // Applies the map f on the (x, z) bits of qubits a and b (bit 4 of the result flips the phase) to every
+    // row supported on either qubit. Single-qubit maps pass a == b and only see the bits of a.
+    template <typename F>
+    void update_rows(uint32_t a, uint32_t b, F&& f);
+
+    void rref_impl(const Qubits& sites, bool x_only);
+};
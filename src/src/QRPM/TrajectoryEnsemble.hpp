@@ -0,0 +1,195 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#include "Simulator.hpp"
+#include "Random.hpp"
+
+// Runs many independent trajectories of a simulator on a pool of threads and collects the statistics of
+// their entanglement profiles. The simulator is constructed from Params and must expose a state with
+// get_entanglement, as SandpileCliffordSimulator and RandomCliffordSimulator do.
+struct EnsembleOpts {
+  uint32_t num_trajectories = 1;
+
+  // Timesteps before the first recorded profile, then between consecutive ones
+  uint32_t equilibration_steps = 0;
+  uint32_t steps_per_sample = 1;
+  uint32_t num_samples = 1;
+
+  // 0 uses every hardware thread
+  uint32_t num_threads = 0;
+
+  // Trajectory t draws from stream t of the generator with this seed, so results do not depend on
+  // the number of threads or on which thread ran which trajectory
+  uint32_t seed = 0;
+};
+
+struct EnsembleStatistics {
+  uint32_t num_trajectories;
+  uint32_t num_samples;
+  uint32_t num_cuts;
+
+  // Mean and variance over trajectories of the entanglement across cut i at sample k, stored at k*num_cuts + i
+  std::vector<double> mean;
+  std::vector<double> variance;
+
+  // histograms[i][s] counts the samples, over all trajectories and times, with entanglement s across cut i
+  std::vector<std::vector<uint64_t>> histograms;
+};
+
+// Clifford entanglement entropies are integers, so the accumulator keeps exact integer sums. Each thread fills
+// its own and they are added up at the end; the result is independent of the order of the merge.
+class EntanglementAccumulator {
+  public:
+    EntanglementAccumulator(uint32_t num_samples, uint32_t num_cuts)
+      : num_samples(num_samples), num_cuts(num_cuts), num_trajectories(0),
+        sums(num_samples*num_cuts, 0), squares(num_samples*num_cuts, 0), counts(num_cuts*(num_cuts + 1), 0) {}
+
+    void add(uint32_t k, const std::vector<int>& profile) {
+      if (profile.size() != num_cuts) {
+        throw std::invalid_argument(std::format("Expected an entanglement profile over {} cuts, got {}.", num_cuts, profile.size()));
+      }
+
+      int64_t* sum = sums.data() + k*num_cuts;
+      int64_t* square = squares.data() + k*num_cuts;
+      for (uint32_t i = 0; i < num_cuts; i++) {
+        int s = profile[i];
+        if (s < 0 || s > static_cast<int>(num_cuts)) {
+          throw std::invalid_argument(std::format("Entanglement {} across cut {} is outside of [0, {}].", s, i, num_cuts));
+        }
+
+        sum[i] += s;
+        square[i] += static_cast<int64_t>(s)*s;
+        counts[i*(num_cuts + 1) + s]++;
+      }
+    }
+
+    void finish_trajectory() {
+      num_trajectories++;
+    }
+
+    void merge(const EntanglementAccumulator& other) {
+      if (other.num_samples != num_samples || other.num_cuts != num_cuts) {
+        throw std::invalid_argument("Cannot merge entanglement accumulators of different shapes.");
+      }
+
+      num_trajectories += other.num_trajectories;
+      for (size_t j = 0; j < sums.size(); j++) {
+        sums[j] += other.sums[j];
+        squares[j] += other.squares[j];
+      }
+      for (size_t j = 0; j < counts.size(); j++) {
+        counts[j] += other.counts[j];
+      }
+    }
+
+    EnsembleStatistics statistics() const {
+      EnsembleStatistics stats;
+      stats.num_trajectories = num_trajectories;
+      stats.num_samples = num_samples;
+      stats.num_cuts = num_cuts;
+
+      stats.mean = std::vector<double>(sums.size(), 0.0);
+      stats.variance = std::vector<double>(sums.size(), 0.0);
+      if (num_trajectories > 0) {
+        double m = static_cast<double>(num_trajectories);
+        for (size_t j = 0; j < sums.size(); j++) {
+          double mean = sums[j] / m;
+          stats.mean[j] = mean;
+          stats.variance[j] = std::max(0.0, squares[j] / m - mean*mean);
+        }
+      }
+
+      stats.histograms = std::vector<std::vector<uint64_t>>(num_cuts);
+      for (uint32_t i = 0; i < num_cuts; i++) {
+        auto start = counts.begin() + i*(num_cuts + 1);
+        stats.histograms[i] = std::vector<uint64_t>(start, start + num_cuts + 1);
+      }
+
+      return stats;
+    }
+
+  private:
+    uint32_t num_samples;
+    uint32_t num_cuts;
+    uint32_t num_trajectories;
+
+    std::vector<int64_t> sums;
+    std::vector<int64_t> squares;
+    std::vector<uint64_t> counts;
+};
+
+// Trajectories are handed out one at a time from a shared counter. Their run times vary with the measurement
+// record, so a thread which finishes early simply claims the next one instead of idling on a fixed partition.
+template <class SimulatorType>
+EnsembleStatistics run_ensemble(const Params& params, const EnsembleOpts& opts) {
+  if (opts.num_samples == 0 || opts.num_trajectories == 0) {
+    throw std::invalid_argument("An ensemble needs at least one trajectory and one sample.");
+  }
+
+  uint32_t num_cuts;
+  {
+    Params p = params;
+    num_cuts = get<int>(p, "system_size");
+  }
+
+  uint32_t num_threads = opts.num_threads ? opts.num_threads : std::max(1u, std::thread::hardware_concurrency());
+  num_threads = std::min(num_threads, opts.num_trajectories);
+
+  std::vector<EntanglementAccumulator> accumulators(num_threads, EntanglementAccumulator(opts.num_samples, num_cuts));
+  std::vector<std::exception_ptr> errors(num_threads);
+  std::atomic<uint32_t> next_trajectory = 0;
+
+  auto worker = [&](uint32_t thread_id) {
+    EntanglementAccumulator& accumulator = accumulators[thread_id];
+    try {
+      uint32_t t;
+      while ((t = next_trajectory.fetch_add(1, std::memory_order_relaxed)) < opts.num_trajectories) {
+        Random::seed_rng(opts.seed, t);
+
+        Params p = params;
+        SimulatorType simulator(p);
+        simulator.timesteps(opts.equilibration_steps);
+        for (uint32_t k = 0; k < opts.num_samples; k++) {
+          if (k > 0) {
+            simulator.timesteps(opts.steps_per_sample);
+          }
+          accumulator.add(k, simulator.state->template get_entanglement<int>());
+        }
+
+        accumulator.finish_trajectory();
+      }
+    } catch (...) {
+      errors[thread_id] = std::current_exception();
+      next_trajectory = opts.num_trajectories;
+    }
+  };
+
+  // The workers reseed their thread's generator, so none of them runs on the calling thread
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker, i);
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  for (uint32_t i = 1; i < num_threads; i++) {
+    accumulators[0].merge(accumulators[i]);
+  }
+
+  return accumulators[0].statistics();
+}
@@ -3,6 +3,159 @@
 #include <random>
 #include <stdexcept>
 #include <format>
+#include <sstream>
+#include <string>
+#include <span>
+#include <cmath>
+#include <numbers>
+#include <cstdint>
+#include <algorithm>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"). Each block of four outputs
+// is a keyed bijection of a 128-bit counter, so a (seed, stream) pair selects a sequence which never overlaps
+// with that of any other stream, and any stretch of it can be generated independently of the rest. The
+// counter holds the block index in its low and the stream in its high 64 bits; the key is the seed.
+class Philox4x32 {
+  public:
+    using result_type = uint32_t;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    Philox4x32(uint64_t seed=0, uint64_t stream=0) {
+      this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream=0) {
+      key = seed;
+      this->stream = stream;
+      block = 0;
+      index = 4;
+    }
+
+    result_type operator()() {
+      if (index == 4) {
+        philox(block++, buffer);
+        index = 0;
+      }
+      return buffer[index++];
+    }
+
+    // Writes the next n outputs, exactly as n calls to operator() would
+    void generate(uint32_t* out, size_t n) {
+      while (index < 4 && n > 0) {
+        *out++ = buffer[index++];
+        n--;
+      }
+
+      size_t num_blocks = n / 4;
+      generate_blocks(out, num_blocks);
+      out += 4*num_blocks;
+      n -= 4*num_blocks;
+
+      for (size_t i = 0; i < n; i++) {
+        out[i] = (*this)();
+      }
+    }
+
+    // Position in the sequence: the next block to generate and the number of outputs already taken from the
+    // current one (4 if there is none)
+    uint64_t get_key() const { return key; }
+    uint64_t get_stream() const { return stream; }
+    uint64_t get_block() const { return block; }
+    uint32_t get_index() const { return index; }
+
+    void set_position(uint64_t block, uint32_t index) {
+      if (index > 4 || (index < 4 && block == 0)) {
+        throw std::invalid_argument(std::format("Invalid Philox position: block {}, index {}.", block, index));
+      }
+
+      this->block = block;
+      this->index = index;
+      if (index < 4) {
+        philox(block - 1, buffer);
+      }
+    }
+
+    void philox(uint64_t ctr, uint32_t out[4]) const {
+      uint32_t c[4] = {static_cast<uint32_t>(ctr), static_cast<uint32_t>(ctr >> 32), static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+      uint32_t k0 = static_cast<uint32_t>(key);
+      uint32_t k1 = static_cast<uint32_t>(key >> 32);
+      for (int r = 0; r < ROUNDS; r++) {
+        round(c[0], c[1], c[2], c[3], k0, k1);
+        k0 += W0;
+        k1 += W1;
+      }
+      for (int j = 0; j < 4; j++) {
+        out[j] = c[j];
+      }
+    }
+
+  private:
+    static constexpr int ROUNDS = 10;
+    static constexpr uint32_t M0 = 0xD2511F53u;
+    static constexpr uint32_t M1 = 0xCD9E8D57u;
+    static constexpr uint32_t W0 = 0x9E3779B9u;
+    static constexpr uint32_t W1 = 0xBB67AE85u;
+
+    // Blocks generated together in generate_blocks; the rounds over the lanes compile to vector multiplies
+    static constexpr size_t LANES = 8;
+
+    uint64_t key;
+    uint64_t stream;
+    uint64_t block;
+    uint32_t index;
+    uint32_t buffer[4];
+
+    static inline void round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+      uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+      uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+      uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+      uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+      c1 = static_cast<uint32_t>(p1);
+      c3 = static_cast<uint32_t>(p0);
+      c0 = n0;
+      c2 = n2;
+    }
+
+    void generate_blocks(uint32_t* out, size_t num_blocks) {
+      size_t b = 0;
+      for (; b + LANES <= num_blocks; b += LANES) {
+        uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+        for (size_t l = 0; l < LANES; l++) {
+          uint64_t ctr = block + b + l;
+          c0[l] = static_cast<uint32_t>(ctr);
+          c1[l] = static_cast<uint32_t>(ctr >> 32);
+          c2[l] = static_cast<uint32_t>(stream);
+          c3[l] = static_cast<uint32_t>(stream >> 32);
+        }
+
+        uint32_t k0 = static_cast<uint32_t>(key);
+        uint32_t k1 = static_cast<uint32_t>(key >> 32);
+        for (int r = 0; r < ROUNDS; r++) {
+          for (size_t l = 0; l < LANES; l++) {
+            round(c0[l], c1[l], c2[l], c3[l], k0, k1);
+          }
+          k0 += W0;
+          k1 += W1;
+        }
+
+        for (size_t l = 0; l < LANES; l++) {
+          uint32_t* o = out + 4*(b + l);
+          o[0] = c0[l];
+          o[1] = c1[l];
+          o[2] = c2[l];
+          o[3] = c3[l];
+        }
+      }
+
+      for (; b < num_blocks; b++) {
+        philox(block + b, out + 4*b);
+      }
+
+      block += num_blocks;
+    }
+};
 
 class Random {
   public:
@@ -12,30 +165,127 @@ class Random {
     }
   private:
     uint32_t seed;
-    std::minstd_rand rng;
+    Philox4x32 rng;
     Random() {
       thread_local std::random_device gen;
       seed = gen();
       rng.seed(seed);
-    } 
+    }
+
+    static constexpr size_t FILL_CHUNK = 256;
 
   public:
     Random(const Random&) = delete;
     Random& operator=(const Random&) = delete;
 
-    static void seed_rng(uint32_t s) {
+    // Threads or tasks which should draw independent, reproducible sequences use the same seed and
+    // distinct streams, e.g. the index of the task
+    static void seed_rng(uint32_t s, uint64_t stream=0) {
       Random& instance = get_instance();
       instance.seed = s;
-      instance.rng.seed(s);
+      instance.rng.seed(s, stream);
     }
 
     static uint32_t get_seed() {
       return Random::get_instance().seed;
     }
 
+    static uint64_t get_stream() {
+      return Random::get_instance().rng.get_stream();
+    }
+
+    // Full state of the generator as text, such that restoring it resumes the exact same sequence of draws
+    static std::string get_state() {
+      Random& instance = get_instance();
+      std::ostringstream ss;
+      ss << instance.seed << ' ' << instance.rng.get_stream() << ' ' << instance.rng.get_block() << ' ' << instance.rng.get_index();
+      return ss.str();
+    }
+
+    static void set_state(const std::string& state) {
+      std::istringstream ss(state);
+      uint32_t seed;
+      uint64_t stream;
+      uint64_t block;
+      uint32_t index;
+      if (!(ss >> seed >> stream >> block >> index)) {
+        throw std::runtime_error(std::format("Invalid random number generator state: \"{}\".", state));
+      }
+
+      Philox4x32 rng(seed, stream);
+      rng.set_position(block, index);
+
+      Random& instance = get_instance();
+      instance.seed = seed;
+      instance.rng = rng;
+    }
+
     uint32_t rand() {
       return rng();
     }
+
+    // Bulk versions of randi() and randf(), which continue the same sequence: fill_bits consumes two outputs
+    // per word (low half first), fill_uniform one per value. fill_normal draws normal variates by Box-Muller
+    // from pairs of uniforms.
+    static void fill_bits(std::span<uint64_t> words) {
+      Random& instance = get_instance();
+      uint32_t buffer[2*FILL_CHUNK];
+      for (size_t i = 0; i < words.size(); i += FILL_CHUNK) {
+        size_t n = std::min(FILL_CHUNK, words.size() - i);
+        instance.rng.generate(buffer, 2*n);
+        for (size_t k = 0; k < n; k++) {
+          words[i + k] = static_cast<uint64_t>(buffer[2*k]) | (static_cast<uint64_t>(buffer[2*k + 1]) << 32);
+        }
+      }
+    }
+
+    static void fill_uniform(std::span<double> values, double min=0.0, double max=1.0) {
+      Random& instance = get_instance();
+      uint32_t buffer[FILL_CHUNK];
+      for (size_t i = 0; i < values.size(); i += FILL_CHUNK) {
+        size_t n = std::min(FILL_CHUNK, values.size() - i);
+        instance.rng.generate(buffer, n);
+        for (size_t k = 0; k < n; k++) {
+          values[i + k] = min + (max - min)*to_unit(buffer[k]);
+        }
+      }
+    }
+
+    static void fill_normal(std::span<double> values, double mean=0.0, double stddev=1.0) {
+      Random& instance = get_instance();
+      uint32_t buffer[2*FILL_CHUNK];
+      for (size_t i = 0; i < values.size(); i += 2*FILL_CHUNK) {
+        size_t n = std::min(2*FILL_CHUNK, values.size() - i);
+        size_t num_pairs = (n + 1) / 2;
+        instance.rng.generate(buffer, 2*num_pairs);
+        for (size_t k = 0; k < num_pairs; k++) {
+          // 1 - u lies in (0, 1], so the logarithm is finite
+          double r = stddev*std::sqrt(-2.0*std::log(1.0 - to_unit(buffer[2*k])));
+          double theta = 2.0*std::numbers::pi*to_unit(buffer[2*k + 1]);
+          values[i + 2*k] = mean + r*std::cos(theta);
+          if (2*k + 1 < n) {
+            values[i + 2*k + 1] = mean + r*std::sin(theta);
+          }
+        }
+      }
+    }
+
+    // Maps a 32-bit output onto [0, 1)
+    static constexpr double to_unit(uint32_t r) {
+      return static_cast<double>(r) * 0x1p-32;
+    }
+};
+
+// Adapts the thread's generator to the UniformRandomBitGenerator interface, for use with <random> distributions
+struct RandomBits {
+  using result_type = uint32_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT32_MAX; }
+
+  result_type operator()() const {
+    return Random::get_instance().rand();
+  }
 };
 
 inline static uint32_t randi() {
@@ -50,7 +300,7 @@ inline static uint32_t randi(uint32_t min, uint32_t max) {
 }
 
 inline static double randf() {
-  return static_cast<double>(randi())/static_cast<double>(RAND_MAX);
+  return Random::to_unit(randi());
 }
 
 inline static double randf(double min, double max) {